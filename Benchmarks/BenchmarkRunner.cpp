@@ -0,0 +1,135 @@
+#include "BenchmarkRunner.h"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+
+static std::string escapeJson(const std::string& text)
+{
+    std::string result;
+    for(char c : text)
+    {
+        switch(c)
+        {
+        case '"':  result += "\\\""; break;
+        case '\\': result += "\\\\"; break;
+        case '\n': result += "\\n"; break;
+        default:   result += c; break;
+        }
+    }
+
+    return result;
+}
+
+BenchmarkRunner::BenchmarkRunner(const std::string& filter)
+    : m_filter(filter)
+{
+}
+
+void BenchmarkRunner::run(const std::string& name, int nIterations, size_t nBytes, const std::function<void()>& body)
+{
+    if(!isSelected(name) || nIterations <= 0)
+    {
+        return;
+    }
+
+    //one untimed warm-up run, so caches and lazy singletons do not skew the first sample
+    body();
+
+    std::vector<double> samplesNs;
+    for(int i = 0; i < nIterations; i++)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        body();
+        samplesNs.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    record(name, samplesNs, nBytes);
+}
+
+void BenchmarkRunner::record(const std::string& name, const std::vector<double>& samplesNs, size_t nBytes)
+{
+    if(samplesNs.empty())
+    {
+        return;
+    }
+
+    Result result;
+    result.m_name = name;
+    result.m_nIterations = samplesNs.size();
+    result.m_nBytes = nBytes;
+
+    double dTotalNs = 0;
+    for(size_t i = 0; i < samplesNs.size(); i++)
+    {
+        dTotalNs += samplesNs[i];
+        if(i == 0 || samplesNs[i] < result.m_dMinNs)
+            result.m_dMinNs = samplesNs[i];
+        if(samplesNs[i] > result.m_dMaxNs)
+            result.m_dMaxNs = samplesNs[i];
+    }
+    result.m_dMeanNs = dTotalNs / samplesNs.size();
+
+    std::cout << std::left << std::setw(40) << name << std::right << std::fixed << std::setprecision(3)
+              << std::setw(14) << result.m_dMeanNs / 1e6 << " ms";
+    if(nBytes)
+    {
+        std::cout << std::setw(12) << (nBytes / (1024.0 * 1024.0)) / (result.m_dMeanNs / 1e9) << " MB/s";
+    }
+    std::cout << std::endl;
+
+    m_results.push_back(result);
+}
+
+void BenchmarkRunner::setParameter(const std::string& key, const std::string& value)
+{
+    m_parameters[key] = value;
+}
+
+bool BenchmarkRunner::writeJson(const std::string& path) const
+{
+    std::ofstream output(path.c_str(), std::ios_base::out | std::ios_base::trunc);
+    if(!output)
+    {
+        std::cerr << "Cannot write results to " << path << std::endl;
+        return false;
+    }
+
+    output << "{\n  \"parameters\": {";
+    bool bFirst = true;
+    for(auto parameter : m_parameters)
+    {
+        output << (bFirst ? "\n" : ",\n") << "    \"" << escapeJson(parameter.first) << "\": \"" << escapeJson(parameter.second) << "\"";
+        bFirst = false;
+    }
+    output << "\n  },\n  \"results\": [";
+
+    bFirst = true;
+    output << std::fixed << std::setprecision(1);
+    for(const Result& result : m_results)
+    {
+        output << (bFirst ? "\n" : ",\n")
+               << "    {\"name\": \"" << escapeJson(result.m_name) << "\""
+               << ", \"iterations\": " << result.m_nIterations
+               << ", \"bytes\": " << result.m_nBytes
+               << ", \"mean_ns\": " << result.m_dMeanNs
+               << ", \"min_ns\": " << result.m_dMinNs
+               << ", \"max_ns\": " << result.m_dMaxNs
+               << "}";
+        bFirst = false;
+    }
+    output << "\n  ]\n}\n";
+
+    return output.good();
+}
+
+void BenchmarkRunner::printSummary() const
+{
+    std::cout << m_results.size() << " benchmarks completed." << std::endl;
+}
+
+bool BenchmarkRunner::isSelected(const std::string& name) const
+{
+    return m_filter.empty() || name.find(m_filter) != std::string::npos;
+}
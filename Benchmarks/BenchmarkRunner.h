@@ -0,0 +1,53 @@
+#ifndef BENCHMARKRUNNER_H
+#define BENCHMARKRUNNER_H
+
+#include <string>
+#include <list>
+#include <vector>
+#include <map>
+#include <functional>
+
+class BenchmarkRunner
+{
+public:
+    struct Result
+    {
+        Result()
+            : m_nIterations(0)
+            , m_nBytes(0)
+            , m_dMeanNs(0)
+            , m_dMinNs(0)
+            , m_dMaxNs(0)
+        {
+        }
+
+        std::string m_name;
+        int m_nIterations;
+        size_t m_nBytes;
+        double m_dMeanNs;
+        double m_dMinNs;
+        double m_dMaxNs;
+    };
+
+    explicit BenchmarkRunner(const std::string& filter);
+
+    //times nIterations calls of body; nBytes is the input size processed per call (0 if not relevant)
+    void run(const std::string& name, int nIterations, size_t nBytes, const std::function<void()>& body);
+
+    //adds a result measured by the caller, one sample per iteration
+    void record(const std::string& name, const std::vector<double>& samplesNs, size_t nBytes);
+
+    void setParameter(const std::string& key, const std::string& value);
+    bool writeJson(const std::string& path) const;
+    void printSummary() const;
+
+    const std::list<Result>& getResults() const { return m_results; }
+    bool isSelected(const std::string& name) const;
+
+private:
+    std::string m_filter;
+    std::list<Result> m_results;
+    std::map<std::string, std::string> m_parameters;
+};
+
+#endif // BENCHMARKRUNNER_H
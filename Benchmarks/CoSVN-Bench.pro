@@ -0,0 +1,30 @@
+#-------------------------------------------------
+#
+# Benchmark suite for the CoSVN-GUI hot paths.
+# Builds a console application that generates synthetic
+# repositories with svnadmin and times the svn layer.
+#
+#-------------------------------------------------
+
+QT       += core
+QT       -= gui
+QMAKE_CXXFLAGS += -std=c++11
+
+TARGET = CoSVN-Bench
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+SOURCES += main.cpp \
+    SyntheticRepoGenerator.cpp \
+    BenchmarkRunner.cpp \
+    ParserBenchmarks.cpp \
+    DiffBenchmarks.cpp
+
+HEADERS += \
+    SyntheticRepoGenerator.h \
+    BenchmarkRunner.h \
+    ParserBenchmarks.h \
+    DiffBenchmarks.h
+
+include(../CoSVN-Core.pri)
@@ -0,0 +1,113 @@
+#include "DiffBenchmarks.h"
+#include "BenchmarkRunner.h"
+
+#include "Diff/TextDiff.h"
+
+#include <fstream>
+#include <sstream>
+#include <random>
+#include <cstdlib>
+
+static const int DIFF_LINES = 100000;
+
+static std::string makeSource(int nLines)
+{
+    std::stringstream ss;
+    for(int i = 0; i < nLines; i++)
+    {
+        ss << "    int value" << i << " = compute(x" << i % 97 << ", y" << i % 13 << "); // line " << i << "\n";
+    }
+
+    return ss.str();
+}
+
+//nEdits lines replaced, inserted or deleted at random places
+static std::string makeEdited(const std::string& source, int nEdits)
+{
+    std::vector<std::string> lines;
+    std::stringstream in(source);
+    std::string line;
+    while(std::getline(in, line))
+    {
+        lines.push_back(line);
+    }
+
+    std::mt19937 random(1);
+    for(int i = 0; i < nEdits; i++)
+    {
+        size_t nPos = random() % lines.size();
+        switch(random() % 3)
+        {
+        case 0: lines[nPos] = "    changed();"; break;
+        case 1: lines.insert(lines.begin() + nPos, "    inserted();"); break;
+        default: lines.erase(lines.begin() + nPos); break;
+        }
+    }
+
+    std::stringstream out;
+    for(const std::string& editedLine : lines)
+    {
+        out << editedLine << "\n";
+    }
+
+    return out.str();
+}
+
+static bool writeFile(const std::string& path, const std::string& content)
+{
+    std::ofstream file(path.c_str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+    file << content;
+    return file.good();
+}
+
+void runDiffBenchmarks(BenchmarkRunner& runner, int nIterations, const std::string& workPath)
+{
+    const std::string source = makeSource(DIFF_LINES);
+    const std::string fewEdits = makeEdited(source, 100);
+    const std::string manyEdits = makeEdited(source, 10000);
+
+    struct Case
+    {
+        const char* m_name;
+        const std::string* m_pEdited;
+    };
+    const Case cases[] = {{"few", &fewEdits}, {"many", &manyEdits}};
+
+    for(const Case& diffCase : cases)
+    {
+        const std::string name = std::string("textdiff.") + diffCase.m_name;
+        runner.run(name + ".engine", nIterations, source.size() + diffCase.m_pEdited->size(), [&]()
+        {
+            TextDiff diff;
+            diff.compute(source, *diffCase.m_pEdited);
+        });
+
+        TextDiff diff;
+        diff.compute(source, *diffCase.m_pEdited);
+        runner.run(name + ".rows", nIterations, 0, [&]()
+        {
+            diff.buildSideBySideRows(-1);
+        });
+
+        //GNU diff includes its process start and the file reads, so it is an upper bound
+        const std::string oldPath = workPath + "/textdiff.old";
+        const std::string newPath = workPath + "/textdiff.new";
+        if(!writeFile(oldPath, source) || !writeFile(newPath, *diffCase.m_pEdited))
+        {
+            continue;
+        }
+
+        const std::string command = "diff " + oldPath + " " + newPath + " > /dev/null";
+        //exit code 1 means the files differ, anything else that diff is missing or failed
+        if(WEXITSTATUS(system(command.c_str())) != 1)
+        {
+            continue;
+        }
+
+        runner.run(name + ".gnu", nIterations, source.size() + diffCase.m_pEdited->size(), [&]()
+        {
+            if(system(command.c_str()) == -1)
+                abort();
+        });
+    }
+}
@@ -0,0 +1,11 @@
+#ifndef DIFFBENCHMARKS_H
+#define DIFFBENCHMARKS_H
+
+#include <string>
+
+class BenchmarkRunner;
+
+//the built-in diff engine on large generated files, and GNU diff on the same files (written under workPath)
+void runDiffBenchmarks(BenchmarkRunner& runner, int nIterations, const std::string& workPath);
+
+#endif // DIFFBENCHMARKS_H
@@ -0,0 +1,91 @@
+#include "ParserBenchmarks.h"
+#include "BenchmarkRunner.h"
+
+#include "Repos/SVN/SvnCommands.h"
+
+#include <sstream>
+
+static const int MICRO_REVISIONS = 20000;
+static const int MICRO_STATUS_ENTRIES = 100000;
+
+static std::string makeLogOutput()
+{
+    std::stringstream ss;
+    const char* separator = "------------------------------------------------------------------------\n";
+    ss << separator;
+    for(int nRevision = MICRO_REVISIONS; nRevision > 0; nRevision--)
+    {
+        int nLines = 1 + nRevision % 4;
+        ss << "r" << nRevision << " | author" << nRevision % 17 << " | 2016-01-01 10:00:00 +0200 (Fri, 01 Jan 2016) | "
+           << nLines << (nLines == 1 ? " line" : " lines") << "\n\n";
+        for(int i = 0; i < nLines; i++)
+        {
+            ss << "Commit message line " << i << " for revision " << nRevision << ", touching the parser and the viewer\n";
+        }
+        ss << separator;
+    }
+
+    return ss.str();
+}
+
+static std::string makeStatusOutput()
+{
+    std::stringstream ss;
+    static const char statuses[] = {'M', 'A', 'D', '?', 'C'};
+    for(int i = 0; i < MICRO_STATUS_ENTRIES; i++)
+    {
+        ss << statuses[i % sizeof(statuses)] << "       /home/user/work/project/src/module" << i % 100 << "/source" << i << ".cpp\n";
+    }
+
+    return ss.str();
+}
+
+static std::string makeDiffSummaryOutput()
+{
+    std::stringstream ss;
+    for(int i = 0; i < MICRO_STATUS_ENTRIES; i++)
+    {
+        ss << (i % 3 ? "M" : "A") << "       svn://server/repo/trunk/src/module" << i % 100 << "/source" << i << ".cpp\n";
+    }
+
+    return ss.str();
+}
+
+void runParserBenchmarks(BenchmarkRunner& runner, int nIterations)
+{
+    const std::string logOutput = makeLogOutput();
+    const std::string statusOutput = makeStatusOutput();
+    const std::string diffOutput = makeDiffSummaryOutput();
+
+    runner.run("micro.lines", nIterations, logOutput.size(), [&]()
+    {
+        LineReader reader(logOutput);
+        StringRef line;
+        size_t nLines = 0;
+        while(reader.next(line))
+        {
+            nLines++;
+        }
+
+        if(!nLines)
+            abort();
+    });
+
+    runner.run("micro.log.parse", nIterations, logOutput.size(), [&]()
+    {
+        LogSvnCommand command("", MICRO_REVISIONS);
+        command.parse(logOutput);
+    });
+
+    runner.run("micro.status.parse", nIterations, statusOutput.size(), [&]()
+    {
+        StatusSvnCommand command("");
+        command.parse(statusOutput);
+    });
+
+    runner.run("micro.diff.parse", nIterations, diffOutput.size(), [&]()
+    {
+        DiffSvnCommand command("", 1);
+        command.parse(diffOutput);
+    });
+}
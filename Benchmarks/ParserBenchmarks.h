@@ -0,0 +1,9 @@
+#ifndef PARSERBENCHMARKS_H
+#define PARSERBENCHMARKS_H
+
+class BenchmarkRunner;
+
+//throughput of the svn output parsers on large in-memory buffers, independent of svn itself
+void runParserBenchmarks(BenchmarkRunner& runner, int nIterations);
+
+#endif // PARSERBENCHMARKS_H
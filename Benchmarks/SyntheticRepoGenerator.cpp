@@ -0,0 +1,268 @@
+#include "SyntheticRepoGenerator.h"
+
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <set>
+#include <algorithm>
+
+static const int DIRECTORY_FAN_OUT = 4;
+
+static std::string makeProperty(const std::string& key, const std::string& value)
+{
+    std::stringstream ss;
+    ss << "K " << key.length() << "\n" << key << "\n"
+       << "V " << value.length() << "\n" << value << "\n";
+    return ss.str();
+}
+
+static std::string makeSvnDate(int nRevision)
+{
+    //one commit per hour, starting with 2016-01-01
+    time_t timestamp = 1451606400 + nRevision * 3600;
+    struct tm utc;
+    gmtime_r(&timestamp, &utc);
+
+    char buffer[64];
+    strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S.000000Z", &utc);
+    return buffer;
+}
+
+SyntheticRepoGenerator::SyntheticRepoGenerator(const std::string& rootPath, const Params& params)
+    : m_rootPath(rootPath)
+    , m_params(params)
+    , m_nRandomState(params.m_nSeed ? params.m_nSeed : 1)
+{
+    if(!m_rootPath.empty() && m_rootPath[m_rootPath.length() - 1] != '/')
+    {
+        m_rootPath += "/";
+    }
+}
+
+std::string SyntheticRepoGenerator::getRepoUrl() const
+{
+    return "file://" + m_rootPath + "repo";
+}
+
+std::string SyntheticRepoGenerator::getWorkingCopyPath() const
+{
+    return m_rootPath + "wc";
+}
+
+bool SyntheticRepoGenerator::generate()
+{
+    buildLayout();
+
+    if(!runCommand("rm -rf \"" + m_rootPath + "repo\" \"" + m_rootPath + "wc\" && mkdir -p \"" + m_rootPath + "\""))
+        return false;
+
+    std::string dumpPath = m_rootPath + "history.dump";
+    if(!writeDumpFile(dumpPath))
+        return false;
+
+    if(!runCommand("svnadmin create \"" + m_rootPath + "repo\""))
+        return false;
+
+    if(!runCommand("svnadmin load -q \"" + m_rootPath + "repo\" < \"" + dumpPath + "\""))
+        return false;
+
+    if(!runCommand("svn checkout -q \"" + getRepoUrl() + "\" \"" + getWorkingCopyPath() + "\""))
+        return false;
+
+    return applyLocalModifications();
+}
+
+void SyntheticRepoGenerator::buildLayout()
+{
+    m_directories.clear();
+    m_files.clear();
+
+    //complete tree of DIRECTORY_FAN_OUT children per level, m_nTreeDepth levels deep
+    std::vector<std::string> currentLevel;
+    currentLevel.push_back("");
+    for(int nDepth = 0; nDepth < m_params.m_nTreeDepth; nDepth++)
+    {
+        std::vector<std::string> nextLevel;
+        for(const std::string& parent : currentLevel)
+        {
+            for(int i = 0; i < DIRECTORY_FAN_OUT; i++)
+            {
+                std::stringstream ss;
+                ss << parent << (parent.empty() ? "" : "/") << "dir" << nDepth << "_" << i;
+                nextLevel.push_back(ss.str());
+                m_directories.push_back(ss.str());
+            }
+        }
+        currentLevel.swap(nextLevel);
+    }
+
+    //files are spread round robin over the root and every directory
+    for(int i = 0; i < m_params.m_nFiles; i++)
+    {
+        size_t nDirectory = i % (m_directories.size() + 1);
+        std::stringstream ss;
+        if(nDirectory)
+        {
+            ss << m_directories[nDirectory - 1] << "/";
+        }
+        ss << "file" << i << ".txt";
+        m_files.push_back(ss.str());
+    }
+}
+
+bool SyntheticRepoGenerator::writeDumpFile(const std::string& dumpPath)
+{
+    std::ofstream dump(dumpPath.c_str(), std::ios_base::out | std::ios_base::trunc | std::ios_base::binary);
+    if(!dump)
+    {
+        std::cerr << "Cannot create dump file " << dumpPath << std::endl;
+        return false;
+    }
+
+    dump << "SVN-fs-dump-format-version: 2\n\n";
+
+    for(int nRevision = 1; nRevision <= m_params.m_nRevisions; nRevision++)
+    {
+        std::string props = makeProperty("svn:author", nRevision % 3 ? "bench" : "reviewer")
+                + makeProperty("svn:date", makeSvnDate(nRevision))
+                + makeProperty("svn:log", makeMessage(nRevision))
+                + "PROPS-END\n";
+
+        dump << "Revision-number: " << nRevision << "\n"
+             << "Prop-content-length: " << props.length() << "\n"
+             << "Content-length: " << props.length() << "\n\n"
+             << props << "\n";
+
+        if(nRevision == 1)
+        {
+            //the first revision creates the whole layout
+            for(const std::string& directory : m_directories)
+            {
+                dump << "Node-path: " << directory << "\n"
+                     << "Node-kind: dir\n"
+                     << "Node-action: add\n"
+                     << "Prop-content-length: 10\n"
+                     << "Content-length: 10\n\n"
+                     << "PROPS-END\n\n\n";
+            }
+
+            for(const std::string& file : m_files)
+            {
+                std::string content = makeContent(file, nRevision);
+                dump << "Node-path: " << file << "\n"
+                     << "Node-kind: file\n"
+                     << "Node-action: add\n"
+                     << "Prop-content-length: 10\n"
+                     << "Text-content-length: " << content.length() << "\n"
+                     << "Content-length: " << content.length() + 10 << "\n\n"
+                     << "PROPS-END\n" << content << "\n\n";
+            }
+            continue;
+        }
+
+        std::set<size_t> changedFiles;
+        int nChanges = std::min<int>(m_params.m_nChangedPathsPerCommit, m_files.size());
+        while((int)changedFiles.size() < nChanges)
+        {
+            changedFiles.insert(nextRandom() % m_files.size());
+        }
+
+        for(size_t nFile : changedFiles)
+        {
+            std::string content = makeContent(m_files[nFile], nRevision);
+            dump << "Node-path: " << m_files[nFile] << "\n"
+                 << "Node-kind: file\n"
+                 << "Node-action: change\n"
+                 << "Text-content-length: " << content.length() << "\n"
+                 << "Content-length: " << content.length() << "\n\n"
+                 << content << "\n\n";
+        }
+    }
+
+    return dump.good();
+}
+
+bool SyntheticRepoGenerator::applyLocalModifications()
+{
+    int nModifications = std::min<int>(m_params.m_nLocalModifications, m_files.size());
+    for(int i = 0; i < nModifications; i++)
+    {
+        //alternate between edited versioned files and unversioned ones
+        std::string path = getWorkingCopyPath() + "/";
+        if(i % 2)
+        {
+            std::stringstream ss;
+            ss << path << "unversioned" << i << ".txt";
+            path = ss.str();
+        }
+        else
+        {
+            path += m_files[(i * 7919) % m_files.size()];
+        }
+
+        std::ofstream file(path.c_str(), std::ios_base::out | std::ios_base::app);
+        if(!file)
+        {
+            std::cerr << "Cannot modify " << path << std::endl;
+            return false;
+        }
+        file << "local modification " << i << "\n";
+    }
+
+    return true;
+}
+
+std::string SyntheticRepoGenerator::makeMessage(int nRevision)
+{
+    static const char* words[] = {"fix", "refactor", "parser", "review", "update", "cleanup", "dialog", "viewer",
+                                  "revision", "status", "tree", "commit", "merge", "branch", "logger", "settings"};
+
+    std::stringstream ss;
+    ss << "r" << nRevision << ":";
+    while((int)ss.tellp() < m_params.m_nMessageLength)
+    {
+        ss << " " << words[nextRandom() % (sizeof(words) / sizeof(words[0]))];
+        //break long messages into several lines to exercise multi-line log parsing
+        if(nextRandom() % 12 == 0)
+        {
+            ss << "\n";
+        }
+    }
+
+    return ss.str();
+}
+
+std::string SyntheticRepoGenerator::makeContent(const std::string& path, int nRevision)
+{
+    std::stringstream ss;
+    int nLines = 20 + nextRandom() % 40;
+    for(int i = 0; i < nLines; i++)
+    {
+        ss << path << " line " << i << " revision " << nRevision << "\n";
+    }
+
+    return ss.str();
+}
+
+unsigned int SyntheticRepoGenerator::nextRandom()
+{
+    //xorshift, deterministic for a given seed
+    m_nRandomState ^= m_nRandomState << 13;
+    m_nRandomState ^= m_nRandomState >> 17;
+    m_nRandomState ^= m_nRandomState << 5;
+    return m_nRandomState;
+}
+
+bool SyntheticRepoGenerator::runCommand(const std::string& cmd)
+{
+    int nResult = system(cmd.c_str());
+    if(nResult != 0)
+    {
+        std::cerr << "Command failed (" << nResult << "): " << cmd << std::endl;
+        return false;
+    }
+
+    return true;
+}
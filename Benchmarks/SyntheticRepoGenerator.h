@@ -0,0 +1,65 @@
+#ifndef SYNTHETICREPOGENERATOR_H
+#define SYNTHETICREPOGENERATOR_H
+
+#include <string>
+#include <vector>
+
+class SyntheticRepoGenerator
+{
+public:
+    struct Params
+    {
+        Params()
+            : m_nRevisions(500)
+            , m_nFiles(1000)
+            , m_nTreeDepth(3)
+            , m_nMessageLength(80)
+            , m_nChangedPathsPerCommit(5)
+            , m_nLocalModifications(50)
+            , m_nSeed(1)
+        {
+        }
+
+        int m_nRevisions;
+        int m_nFiles;
+        int m_nTreeDepth;
+        int m_nMessageLength;
+        int m_nChangedPathsPerCommit;
+        int m_nLocalModifications;
+        unsigned int m_nSeed;
+    };
+
+    SyntheticRepoGenerator(const std::string& rootPath, const Params& params);
+
+    //creates <root>/repo with svnadmin, loads the generated history and checks it out into <root>/wc
+    bool generate();
+
+    //computes the directory and file layout only, without touching the disk
+    void buildLayout();
+
+    std::string getRepoUrl() const;
+    std::string getWorkingCopyPath() const;
+    const std::vector<std::string>& getFiles() const { return m_files; }
+    const std::vector<std::string>& getDirectories() const { return m_directories; }
+    const Params& getParams() const { return m_params; }
+
+private:
+    bool writeDumpFile(const std::string& dumpPath);
+    bool applyLocalModifications();
+
+    std::string makeMessage(int nRevision);
+    std::string makeContent(const std::string& path, int nRevision);
+    unsigned int nextRandom();
+
+    static bool runCommand(const std::string& cmd);
+
+private:
+    std::string m_rootPath;
+    Params m_params;
+    unsigned int m_nRandomState;
+
+    std::vector<std::string> m_directories;
+    std::vector<std::string> m_files;
+};
+
+#endif // SYNTHETICREPOGENERATOR_H
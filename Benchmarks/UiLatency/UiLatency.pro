@@ -0,0 +1,31 @@
+#-------------------------------------------------
+#
+# UI latency harness: starts MainWindow against a synthetic
+# repository, drives it with QTest and fails when the time
+# from input event to finished repaint exceeds the budgets.
+#
+#-------------------------------------------------
+
+QT       += core gui testlib
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+QMAKE_CXXFLAGS += -std=c++11
+
+TARGET = CoSVN-UiLatency
+TEMPLATE = app
+CONFIG -= app_bundle
+
+INCLUDEPATH += ..
+
+SOURCES += main.cpp \
+    UiLatencyHarness.cpp \
+    ../SyntheticRepoGenerator.cpp \
+    ../BenchmarkRunner.cpp
+
+HEADERS += \
+    UiLatencyHarness.h \
+    ../SyntheticRepoGenerator.h \
+    ../BenchmarkRunner.h
+
+include(../../CoSVN-Core.pri)
+include(../../CoSVN-Gui.pri)
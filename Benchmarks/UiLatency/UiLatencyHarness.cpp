@@ -0,0 +1,276 @@
+#include "UiLatencyHarness.h"
+#include "BenchmarkRunner.h"
+
+#include "Gui/MainWindow.h"
+
+#include <QtTest/QTest>
+#include <QApplication>
+#include <QLineEdit>
+#include <QLabel>
+#include <QTableView>
+#include <QTreeWidget>
+#include <QAction>
+#include <QTimer>
+#include <QThread>
+
+#include <iostream>
+#include <iomanip>
+
+RepaintProbe::RepaintProbe()
+    : m_bArmed(false)
+    , m_bDone(false)
+    , m_dElapsedMs(-1)
+{
+    qApp->installEventFilter(this);
+}
+
+RepaintProbe::~RepaintProbe()
+{
+    qApp->removeEventFilter(this);
+}
+
+void RepaintProbe::arm(const WidgetMatcher& matcher, const ReadyCondition& ready, const std::function<void()>& onDone)
+{
+    m_matcher = matcher;
+    m_ready = ready;
+    m_onDone = onDone;
+    m_bDone = false;
+    m_dElapsedMs = -1;
+    m_bArmed = true;
+    m_timer.start();
+}
+
+bool RepaintProbe::eventFilter(QObject* obj, QEvent* event)
+{
+    if(m_bArmed && event->type() == QEvent::Paint && obj->isWidgetType())
+    {
+        QWidget* pWidget = static_cast<QWidget*>(obj);
+        if(m_matcher(pWidget) && m_ready())
+        {
+            //the paint itself runs after the filter returns; the zero timer fires once it finished
+            m_bArmed = false;
+            QTimer::singleShot(0, [this]()
+            {
+                m_dElapsedMs = m_timer.nsecsElapsed() / 1e6;
+                m_bDone = true;
+                if(m_onDone)
+                {
+                    m_onDone();
+                }
+            });
+        }
+    }
+
+    return false;
+}
+
+static std::function<bool(QWidget*)> viewportOf(QWidget* pView)
+{
+    return [pView](QWidget* pWidget)
+    {
+        return pWidget == pView || pWidget->parentWidget() == pView;
+    };
+}
+
+UiLatencyHarness::UiLatencyHarness(MainWindow& window, BenchmarkRunner& runner, int nTimeoutMs)
+    : m_window(window)
+    , m_runner(runner)
+    , m_nTimeoutMs(nTimeoutMs)
+{
+}
+
+void UiLatencyHarness::setBudget(const std::string& name, double dBudgetMs)
+{
+    m_budgetsMs[name] = dBudgetMs;
+}
+
+bool UiLatencyHarness::waitUntil(const std::function<bool()>& condition)
+{
+    QElapsedTimer timer;
+    timer.start();
+    while(!condition())
+    {
+        if(timer.elapsed() > m_nTimeoutMs)
+        {
+            return false;
+        }
+
+        QCoreApplication::processEvents(QEventLoop::AllEvents);
+        QThread::usleep(100);
+    }
+
+    return true;
+}
+
+double UiLatencyHarness::waitForRepaint()
+{
+    waitUntil([this]() { return m_probe.isDone(); });
+    return m_probe.getElapsedMs();
+}
+
+bool UiLatencyHarness::waitForRepository()
+{
+    QTableView* pRevisions = m_window.findChild<QTableView*>("revisionsTable");
+    QTreeWidget* pTree = m_window.findChild<QTreeWidget*>("treeWidgetRepo");
+    if(!pRevisions || !pTree)
+    {
+        return false;
+    }
+
+    return waitUntil([pRevisions, pTree]()
+    {
+        return pRevisions->model()->rowCount() > 0 && pTree->topLevelItem(0) && pTree->topLevelItem(0)->childCount() > 0;
+    });
+}
+
+void UiLatencyHarness::measureFilterTyping(const QString& text)
+{
+    QLineEdit* pFilter = m_window.findChild<QLineEdit*>("revisionsFilterEdit");
+    QTableView* pRevisions = m_window.findChild<QTableView*>("revisionsTable");
+
+    std::vector<double>& samples = m_samplesMs["filter.typing"];
+    pFilter->setFocus();
+    for(int i = 0; i < text.length(); i++)
+    {
+        m_probe.arm(viewportOf(pRevisions), []() { return true; });
+        QTest::keyClick(pFilter, text.at(i).toLatin1());
+        samples.push_back(waitForRepaint());
+    }
+
+    //clearing the filter is the most expensive keystroke: every revision comes back
+    m_probe.arm(viewportOf(pRevisions), []() { return true; });
+    QTest::keyClick(pFilter, Qt::Key_A, Qt::ControlModifier);
+    QTest::keyClick(pFilter, Qt::Key_Delete);
+    samples.push_back(waitForRepaint());
+}
+
+void UiLatencyHarness::measureRevisionSelection(int nSelections)
+{
+    QTableView* pRevisions = m_window.findChild<QTableView*>("revisionsTable");
+    QTableView* pDetails = m_window.findChild<QTableView*>("revisionDetails");
+    QLabel* pRevisionLabel = m_window.findChild<QLabel*>("lebelRevision");
+
+    std::vector<double>& samples = m_samplesMs["revision.select"];
+    int nRows = pRevisions->model()->rowCount();
+    for(int i = 1; i <= nSelections && i < nRows; i++)
+    {
+        QModelIndex index = pRevisions->model()->index(i, 0);
+        QString strRevision = index.data().toString();
+        pRevisions->scrollTo(index);
+        QCoreApplication::processEvents();
+
+        m_probe.arm(viewportOf(pDetails), [pDetails, pRevisionLabel, strRevision]()
+        {
+            //the details view is disabled while the affected items are loading
+            return pDetails->isEnabled() && pRevisionLabel->text() == strRevision;
+        });
+        QTest::mouseClick(pRevisions->viewport(), Qt::LeftButton, 0, pRevisions->visualRect(index).center());
+        samples.push_back(waitForRepaint());
+    }
+}
+
+void UiLatencyHarness::measureTreeExpansion(int nExpansions)
+{
+    QTreeWidget* pTree = m_window.findChild<QTreeWidget*>("treeWidgetRepo");
+    QTreeWidgetItem* pRoot = pTree->topLevelItem(0);
+    pTree->expandItem(pRoot);
+    QCoreApplication::processEvents();
+
+    std::vector<double>& samples = m_samplesMs["tree.expand"];
+    for(int i = 0, nExpanded = 0; i < pRoot->childCount() && nExpanded < nExpansions; i++)
+    {
+        QTreeWidgetItem* pItem = pRoot->child(i);
+        if(pItem->childIndicatorPolicy() != QTreeWidgetItem::ShowIndicator || pItem->childCount())
+        {
+            continue;
+        }
+
+        pTree->setFocus();
+        pTree->setCurrentItem(pItem);
+        QCoreApplication::processEvents();
+
+        m_probe.arm(viewportOf(pTree), [pItem]() { return pItem->childCount() > 0; });
+        QTest::keyClick(pTree, Qt::Key_Right);
+        samples.push_back(waitForRepaint());
+        nExpanded++;
+    }
+}
+
+void UiLatencyHarness::measureStatusDialog(int nOpenings)
+{
+    QAction* pAction = m_window.findChild<QAction*>("actionCheck_for_modifications");
+
+    std::vector<double>& samples = m_samplesMs["status.open"];
+    for(int i = 0; i < nOpenings; i++)
+    {
+        auto isStatusTable = [](QWidget* pWidget)
+        {
+            QWidget* pParent = pWidget->parentWidget();
+            return pParent && pParent->objectName() == "tableView" && pWidget->window()->objectName() == "StatusDialog";
+        };
+        auto closeDialog = []()
+        {
+            if(QWidget* pModal = QApplication::activeModalWidget())
+            {
+                pModal->close();
+            }
+        };
+
+        m_probe.arm(isStatusTable, []()
+        {
+            QWidget* pModal = QApplication::activeModalWidget();
+            QTableView* pTable = pModal ? pModal->findChild<QTableView*>("tableView") : nullptr;
+            return pTable && pTable->model()->rowCount() > 0;
+        }, closeDialog);
+
+        //the dialog runs its own event loop; make sure it goes away even when the probe never fires. The timer
+        //belongs to this opening only, a later dialog must not be closed by it
+        QTimer timeoutTimer;
+        timeoutTimer.setSingleShot(true);
+        QObject::connect(&timeoutTimer, &QTimer::timeout, closeDialog);
+        timeoutTimer.start(m_nTimeoutMs);
+        pAction->trigger();
+        timeoutTimer.stop();
+        samples.push_back(m_probe.isDone() ? m_probe.getElapsedMs() : -1);
+    }
+}
+
+bool UiLatencyHarness::checkBudgets() const
+{
+    bool bPassed = true;
+    for(auto measurement : m_samplesMs)
+    {
+        std::vector<double> samplesNs;
+        double dWorstMs = 0;
+        bool bTimedOut = false;
+        for(double dSampleMs : measurement.second)
+        {
+            if(dSampleMs < 0)
+            {
+                bTimedOut = true;
+                continue;
+            }
+
+            samplesNs.push_back(dSampleMs * 1e6);
+            dWorstMs = std::max(dWorstMs, dSampleMs);
+        }
+        m_runner.record(measurement.first, samplesNs, 0);
+
+        std::map<std::string, double>::const_iterator budget = m_budgetsMs.find(measurement.first);
+        bool bOverBudget = budget != m_budgetsMs.end() && dWorstMs > budget->second;
+        if(bOverBudget || bTimedOut)
+        {
+            bPassed = false;
+        }
+
+        std::cout << std::left << std::setw(20) << measurement.first << std::right << std::fixed << std::setprecision(2)
+                  << " worst " << std::setw(10) << dWorstMs << " ms";
+        if(budget != m_budgetsMs.end())
+        {
+            std::cout << "  budget " << std::setw(10) << budget->second << " ms";
+        }
+        std::cout << (bTimedOut ? "  TIMEOUT" : (bOverBudget ? "  OVER BUDGET" : "  ok")) << std::endl;
+    }
+
+    return bPassed;
+}
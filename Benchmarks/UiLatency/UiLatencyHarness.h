@@ -0,0 +1,76 @@
+#ifndef UILATENCYHARNESS_H
+#define UILATENCYHARNESS_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QString>
+
+#include <functional>
+#include <string>
+#include <map>
+#include <vector>
+
+class MainWindow;
+class BenchmarkRunner;
+class QWidget;
+
+//application wide event filter that reports the first repaint of a matching widget once the view is ready
+class RepaintProbe : public QObject
+{
+public:
+    typedef std::function<bool(QWidget*)> WidgetMatcher;
+    typedef std::function<bool()> ReadyCondition;
+
+    RepaintProbe();
+    ~RepaintProbe();
+
+    void arm(const WidgetMatcher& matcher, const ReadyCondition& ready, const std::function<void()>& onDone = std::function<void()>());
+    bool isDone() const { return m_bDone; }
+    double getElapsedMs() const { return m_dElapsedMs; }
+    qint64 getTimerElapsedMs() const { return m_timer.elapsed(); }
+
+protected:
+    bool eventFilter(QObject* obj, QEvent* event);
+
+private:
+    QElapsedTimer m_timer;
+    WidgetMatcher m_matcher;
+    ReadyCondition m_ready;
+    std::function<void()> m_onDone;
+    bool m_bArmed;
+    bool m_bDone;
+    double m_dElapsedMs;
+};
+
+class UiLatencyHarness
+{
+public:
+    UiLatencyHarness(MainWindow& window, BenchmarkRunner& runner, int nTimeoutMs);
+
+    void setBudget(const std::string& name, double dBudgetMs);
+
+    bool waitForRepository();
+
+    void measureFilterTyping(const QString& text);
+    void measureRevisionSelection(int nSelections);
+    void measureTreeExpansion(int nExpansions);
+    void measureStatusDialog(int nOpenings);
+
+    //prints every measurement against its budget; false if one of them is over budget or timed out
+    bool checkBudgets() const;
+
+private:
+    bool waitUntil(const std::function<bool()>& condition);
+    double waitForRepaint();
+
+private:
+    MainWindow& m_window;
+    BenchmarkRunner& m_runner;
+    int m_nTimeoutMs;
+    RepaintProbe m_probe;
+
+    std::map<std::string, double> m_budgetsMs;
+    std::map<std::string, std::vector<double> > m_samplesMs;
+};
+
+#endif // UILATENCYHARNESS_H
@@ -0,0 +1,162 @@
+#include "UiLatencyHarness.h"
+#include "SyntheticRepoGenerator.h"
+#include "BenchmarkRunner.h"
+
+#include "Gui/MainWindow.h"
+
+#include <QApplication>
+#include <QtTest/QTest>
+
+#include <iostream>
+#include <cstdlib>
+
+static void printUsage()
+{
+    std::cout << "Usage: CoSVN-UiLatency [options]\n"
+              << "  --root <dir>             where the synthetic repository is generated (default /tmp/CoSvnUiLatency)\n"
+              << "  --revisions <n>          number of revisions (default 2000)\n"
+              << "  --files <n>              number of files (default 2000)\n"
+              << "  --depth <n>              directory tree depth (default 3)\n"
+              << "  --local-changes <n>      local modifications shown by StatusDialog (default 2000)\n"
+              << "  --iterations <n>         repetitions of each interaction (default 10)\n"
+              << "  --budget <name>=<ms>     latency budget; names: filter.typing, revision.select, tree.expand, status.open\n"
+              << "  --timeout <ms>           give up waiting for a repaint after this long (default 30000)\n"
+              << "  --output <file>          JSON results (default ui_latency.json)\n"
+              << "  --reuse                  skip generation and reuse an existing root\n"
+              << "  --replay <file>          answer svn invocations from a recording (implies --reuse)\n";
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+
+    SyntheticRepoGenerator::Params params;
+    params.m_nRevisions = 2000;
+    params.m_nFiles = 2000;
+    params.m_nLocalModifications = 2000;
+
+    std::string rootPath = "/tmp/CoSvnUiLatency";
+    std::string outputPath = "ui_latency.json";
+    int nIterations = 10;
+    int nTimeoutMs = 30000;
+    bool bReuse = false;
+
+    //default budgets, in milliseconds
+    std::map<std::string, double> budgets;
+    budgets["filter.typing"] = 50;
+    budgets["revision.select"] = 100;
+    budgets["tree.expand"] = 1000;
+    budgets["status.open"] = 500;
+
+    QStringList arguments = app.arguments();
+    for(int i = 1; i < arguments.size(); i++)
+    {
+        std::string option = arguments[i].toStdString();
+        if(option == "--reuse")
+        {
+            bReuse = true;
+            continue;
+        }
+
+        if(option == "--help" || i + 1 >= arguments.size())
+        {
+            printUsage();
+            return option == "--help" ? 0 : 1;
+        }
+
+        std::string value = arguments[++i].toStdString();
+        if(option == "--root") rootPath = value;
+        else if(option == "--revisions") params.m_nRevisions = atoi(value.c_str());
+        else if(option == "--files") params.m_nFiles = atoi(value.c_str());
+        else if(option == "--depth") params.m_nTreeDepth = atoi(value.c_str());
+        else if(option == "--local-changes") params.m_nLocalModifications = atoi(value.c_str());
+        else if(option == "--iterations") nIterations = atoi(value.c_str());
+        else if(option == "--timeout") nTimeoutMs = atoi(value.c_str());
+        else if(option == "--output") outputPath = value;
+        else if(option == "--replay")
+        {
+            setenv("COSVN_REPLAY", value.c_str(), 1);
+            bReuse = true;
+        }
+        else if(option == "--budget")
+        {
+            size_t nPos = value.find('=');
+            if(nPos == std::string::npos)
+            {
+                printUsage();
+                return 1;
+            }
+            budgets[value.substr(0, nPos)] = atof(value.substr(nPos + 1).c_str());
+        }
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+
+    SyntheticRepoGenerator generator(rootPath, params);
+    if(bReuse)
+    {
+        generator.buildLayout();
+    }
+    else
+    {
+        std::cout << "Generating repository in " << rootPath << " ..." << std::endl;
+        if(!generator.generate())
+        {
+            std::cerr << "Repository generation failed." << std::endl;
+            return 1;
+        }
+    }
+
+    MainWindow window(app);
+    window.resize(1280, 800);
+    window.show();
+    if(!QTest::qWaitForWindowExposed(&window))
+    {
+        std::cerr << "The main window was never exposed." << std::endl;
+        return 1;
+    }
+
+    BenchmarkRunner runner("");
+    runner.setParameter("revisions", std::to_string(params.m_nRevisions));
+    runner.setParameter("files", std::to_string(params.m_nFiles));
+    runner.setParameter("local_changes", std::to_string(params.m_nLocalModifications));
+
+    UiLatencyHarness harness(window, runner, nTimeoutMs);
+    for(auto budget : budgets)
+    {
+        harness.setBudget(budget.first, budget.second);
+        runner.setParameter("budget." + budget.first, std::to_string(budget.second));
+    }
+
+    SvnViewer::instance()->init(generator.getWorkingCopyPath());
+    if(!harness.waitForRepository())
+    {
+        std::cerr << "The repository was not loaded in time." << std::endl;
+        return 1;
+    }
+
+    harness.measureFilterTyping("refactor");
+    harness.measureRevisionSelection(nIterations);
+    harness.measureTreeExpansion(nIterations);
+    harness.measureStatusDialog(nIterations);
+
+    //how long SvnViewer notifications waited for delivery to the GUI thread, and how many were merged
+    GuiUpdateQueue::Stats queueStats = window.getUpdateQueue()->getStats()[QEvent::None];
+    std::vector<double> latencySamplesNs;
+    for(double dLatencyMs : window.getUpdateQueue()->getLatencySamples())
+    {
+        latencySamplesNs.push_back(dLatencyMs * 1e6);
+    }
+    runner.record("gui.queue.latency", latencySamplesNs, 0);
+    runner.setParameter("gui.queue.posted", std::to_string(queueStats.m_nPosted));
+    runner.setParameter("gui.queue.merged", std::to_string(queueStats.m_nMerged));
+
+    bool bPassed = harness.checkBudgets();
+    runner.writeJson(outputPath);
+
+    std::cout << (bPassed ? "All interactions within budget." : "Latency budget exceeded.") << std::endl;
+    return bPassed ? 0 : 1;
+}
@@ -0,0 +1,341 @@
+#include "SyntheticRepoGenerator.h"
+#include "BenchmarkRunner.h"
+#include "ParserBenchmarks.h"
+#include "DiffBenchmarks.h"
+
+#include "Repos/SVN/SvnViewer.h"
+
+#include <condition_variable>
+#include <thread>
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <map>
+#include <cstdlib>
+#include <cstring>
+
+class BenchViewerObserver : public SvnViewerObserver
+{
+public:
+    BenchViewerObserver()
+    {
+        reset();
+    }
+
+    void reset()
+    {
+        std::unique_lock<std::mutex> locker(m_mutex);
+        m_bRevisions = m_bLocalChanges = m_bRepoContent = m_bUnchanged = m_bErrors = false;
+    }
+
+    //waits until the log and the root listing were delivered, or the HEAD probe found nothing new;
+    //status is only reported when the working copy changed
+    bool waitForRefresh(int nTimeoutSeconds)
+    {
+        std::unique_lock<std::mutex> locker(m_mutex);
+        return m_condition.wait_for(locker, std::chrono::seconds(nTimeoutSeconds), [this]()
+        {
+            return m_bErrors || m_bUnchanged || (m_bRevisions && m_bRepoContent);
+        }) && !m_bErrors;
+    }
+
+    virtual void onRevisionsListUpdated() { notify(m_bRevisions); }
+    virtual void onLocalModificationsUpdated() { notify(m_bLocalChanges); }
+    virtual void onAffectedItemsUpdated() {}
+    virtual void onRepoContentUpdated() { notify(m_bRepoContent); }
+    virtual void onErrosGenerated() { notify(m_bErrors); }
+    virtual void onRepositoryUnchanged() { notify(m_bUnchanged); }
+
+private:
+    void notify(bool& bFlag)
+    {
+        std::unique_lock<std::mutex> locker(m_mutex);
+        bFlag = true;
+        m_condition.notify_all();
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_bRevisions;
+    bool m_bLocalChanges;
+    bool m_bRepoContent;
+    bool m_bUnchanged;
+    bool m_bErrors;
+};
+
+static RepoItemInfo::SmartPtr buildRepoTree(const std::string& rootPath, const SyntheticRepoGenerator& generator)
+{
+    RepoItemInfo::SmartPtr root(new RepoItemInfo(nullptr, rootPath, RepoItemInfo::Directory));
+
+    //directories are generated parents first, so every parent exists when its children are inserted
+    std::map<std::string, RepoItemInfo*> directories;
+    directories[""] = root.get();
+    for(const std::string& directory : generator.getDirectories())
+    {
+        size_t nPos = directory.rfind('/');
+        std::string parent = nPos == std::string::npos ? "" : directory.substr(0, nPos);
+        std::string name = (nPos == std::string::npos ? directory : directory.substr(nPos + 1)) + "/";
+
+        RepoItemInfo* pParent = directories[parent];
+        pParent->m_subItems.push_back(RepoItemInfo::SmartPtr(new RepoItemInfo(pParent, name, RepoItemInfo::Directory)));
+        directories[directory] = pParent->m_subItems.back().get();
+    }
+
+    for(const std::string& file : generator.getFiles())
+    {
+        size_t nPos = file.rfind('/');
+        std::string parent = nPos == std::string::npos ? "" : file.substr(0, nPos);
+        std::string name = nPos == std::string::npos ? file : file.substr(nPos + 1);
+
+        RepoItemInfo* pParent = directories[parent];
+        pParent->m_subItems.push_back(RepoItemInfo::SmartPtr(new RepoItemInfo(pParent, name)));
+    }
+
+    return root;
+}
+
+static void collectNodes(const RepoItemInfo::SmartPtr& node, std::vector<RepoItemInfo::SmartPtr>& nodes)
+{
+    nodes.push_back(node);
+    for(const RepoItemInfo::SmartPtr& child : node->m_subItems)
+    {
+        collectNodes(child, nodes);
+    }
+}
+
+static void printUsage()
+{
+    std::cout << "Usage: CoSVN-Bench [options]\n"
+              << "  --root <dir>             where the synthetic repository is generated (default /tmp/CoSvnBench)\n"
+              << "  --revisions <n>          number of revisions (default 500)\n"
+              << "  --files <n>              number of files (default 1000)\n"
+              << "  --depth <n>              directory tree depth (default 3)\n"
+              << "  --message-length <n>     approximate commit message length (default 80)\n"
+              << "  --changed-paths <n>      changed paths per commit (default 5)\n"
+              << "  --local-changes <n>      local modifications in the working copy (default 50)\n"
+              << "  --seed <n>               random seed (default 1)\n"
+              << "  --iterations <n>         iterations per benchmark (default 20)\n"
+              << "  --filter <text>          run only benchmarks whose name contains text\n"
+              << "  --output <file>          JSON baseline output (default bench_results.json)\n"
+              << "  --reuse                  skip generation and reuse an existing root\n"
+              << "  --record <file>          record every svn invocation to file\n"
+              << "  --replay <file>          answer svn invocations from a recording (implies --reuse)\n"
+              << "  --replay-speed <factor>  1 keeps the recorded durations, 0 replays without delays (default)\n";
+}
+
+int main(int argc, char *argv[])
+{
+    SyntheticRepoGenerator::Params params;
+    std::string rootPath = "/tmp/CoSvnBench";
+    std::string outputPath = "bench_results.json";
+    std::string filter;
+    int nIterations = 20;
+    bool bReuse = false;
+
+    for(int i = 1; i < argc; i++)
+    {
+        std::string option = argv[i];
+        if(option == "--reuse")
+        {
+            bReuse = true;
+            continue;
+        }
+
+        if(option == "--help" || i + 1 >= argc)
+        {
+            printUsage();
+            return option == "--help" ? 0 : 1;
+        }
+
+        std::string value = argv[++i];
+        if(option == "--root") rootPath = value;
+        else if(option == "--revisions") params.m_nRevisions = atoi(value.c_str());
+        else if(option == "--files") params.m_nFiles = atoi(value.c_str());
+        else if(option == "--depth") params.m_nTreeDepth = atoi(value.c_str());
+        else if(option == "--message-length") params.m_nMessageLength = atoi(value.c_str());
+        else if(option == "--changed-paths") params.m_nChangedPathsPerCommit = atoi(value.c_str());
+        else if(option == "--local-changes") params.m_nLocalModifications = atoi(value.c_str());
+        else if(option == "--seed") params.m_nSeed = strtoul(value.c_str(), NULL, 10);
+        else if(option == "--iterations") nIterations = atoi(value.c_str());
+        else if(option == "--filter") filter = value;
+        else if(option == "--output") outputPath = value;
+        else if(option == "--record") setenv("COSVN_RECORD", value.c_str(), 1);
+        else if(option == "--replay")
+        {
+            setenv("COSVN_REPLAY", value.c_str(), 1);
+            bReuse = true;
+        }
+        else if(option == "--replay-speed") setenv("COSVN_REPLAY_SPEED", value.c_str(), 1);
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+
+    SyntheticRepoGenerator generator(rootPath, params);
+    if(bReuse)
+    {
+        //the layout is deterministic, so the in-memory file list matches the reused repository
+        generator.buildLayout();
+    }
+    else
+    {
+        std::cout << "Generating repository in " << rootPath << " ..." << std::endl;
+        if(!generator.generate())
+        {
+            std::cerr << "Repository generation failed." << std::endl;
+            return 1;
+        }
+    }
+
+    BenchmarkRunner runner(filter);
+    runner.setParameter("revisions", std::to_string(params.m_nRevisions));
+    runner.setParameter("files", std::to_string(params.m_nFiles));
+    runner.setParameter("depth", std::to_string(params.m_nTreeDepth));
+    runner.setParameter("message_length", std::to_string(params.m_nMessageLength));
+    runner.setParameter("changed_paths", std::to_string(params.m_nChangedPathsPerCommit));
+    runner.setParameter("local_changes", std::to_string(params.m_nLocalModifications));
+    runner.setParameter("seed", std::to_string(params.m_nSeed));
+
+    runParserBenchmarks(runner, nIterations);
+    runDiffBenchmarks(runner, nIterations, rootPath);
+
+    const std::string repoUrl = generator.getRepoUrl();
+    const std::string wcPath = generator.getWorkingCopyPath();
+    const int nRevisionsCount = 2500;
+
+    //svn log
+    std::stringstream logCommand; logCommand << "svn log " << repoUrl << " -l " << nRevisionsCount;
+    const std::string logOutput = SvnCommand::executeShellCommand(logCommand.str());
+    runner.run("log.parse", nIterations, logOutput.size(), [&]()
+    {
+        LogSvnCommand command(repoUrl, nRevisionsCount);
+        command.parse(logOutput);
+    });
+    runner.run("log.execute", nIterations, 0, [&]()
+    {
+        LogSvnCommand command(repoUrl, nRevisionsCount);
+        command.execute();
+    });
+
+    //svn status
+    const std::string statusOutput = SvnCommand::executeShellCommand("svn status " + wcPath);
+    runner.run("status.parse", nIterations, statusOutput.size(), [&]()
+    {
+        StatusSvnCommand command(wcPath);
+        command.parse(statusOutput);
+    });
+    runner.run("status.execute", nIterations, 0, [&]()
+    {
+        StatusSvnCommand command(wcPath);
+        command.execute();
+    });
+
+    //svn list
+    const std::string listOutput = SvnCommand::executeShellCommand("svn list " + wcPath);
+    runner.run("list.parse", nIterations, listOutput.size(), [&]()
+    {
+        RepoItemInfo::SmartPtr root(new RepoItemInfo(nullptr, wcPath, RepoItemInfo::Directory));
+        ListSvnCommand command(wcPath, root);
+        command.parse(listOutput);
+    });
+    runner.run("list.execute", nIterations, 0, [&]()
+    {
+        RepoItemInfo::SmartPtr root(new RepoItemInfo(nullptr, wcPath, RepoItemInfo::Directory));
+        ListSvnCommand command(wcPath, root);
+        command.execute();
+    });
+
+    //svn diff --summarize of the revision touching the most paths: the first one
+    const int nDiffRevision = 1;
+    std::stringstream diffCommand; diffCommand << "svn diff " << repoUrl << " -c " << nDiffRevision << " --summarize";
+    const std::string diffOutput = SvnCommand::executeShellCommand(diffCommand.str());
+    runner.run("diff.parse", nIterations, diffOutput.size(), [&]()
+    {
+        DiffSvnCommand command(repoUrl, nDiffRevision);
+        command.parse(diffOutput);
+    });
+    runner.run("diff.execute", nIterations, 0, [&]()
+    {
+        DiffSvnCommand command(repoUrl, nDiffRevision);
+        command.execute();
+    });
+
+    //RepoItemInfo tree operations on the full working copy layout
+    runner.run("tree.build", nIterations, 0, [&]()
+    {
+        buildRepoTree(wcPath, generator);
+    });
+
+    RepoItemInfo::SmartPtr tree = buildRepoTree(wcPath, generator);
+    std::vector<RepoItemInfo::SmartPtr> nodes;
+    collectNodes(tree, nodes);
+    runner.run("tree.getFullPath", nIterations, 0, [&]()
+    {
+        for(const RepoItemInfo::SmartPtr& node : nodes)
+        {
+            node->getFullPath();
+        }
+    });
+
+    std::vector<std::string> lookups;
+    for(size_t i = 0; i < nodes.size(); i += std::max<size_t>(1, nodes.size() / 100))
+    {
+        lookups.push_back(nodes[i]->getFullPath());
+    }
+    runner.run("tree.findChildNode", nIterations, 0, [&]()
+    {
+        for(const std::string& path : lookups)
+        {
+            tree->findChildNode(path);
+        }
+    });
+
+    //SvnViewer end to end: info, then list/log (or the HEAD probe once loaded), until the observer was notified
+    BenchViewerObserver observer;
+    SvnViewer::instance()->setObserver(&observer);
+    bool bRefreshFailed = false;
+    std::vector<double> pipelineSamples;
+    runner.run("viewer.refresh", nIterations, 0, [&]()
+    {
+        observer.reset();
+        const bool bInitialLoad = !SvnViewer::instance()->isInitialized();
+        if(bInitialLoad)
+            SvnViewer::instance()->init(wcPath, nRevisionsCount);
+        else
+            SvnViewer::instance()->refresh();
+
+        if(!observer.waitForRefresh(120))
+        {
+            bRefreshFailed = true;
+            return;
+        }
+
+        //status may still be running after the log and the listing were delivered
+        while(SvnViewer::instance()->isRefreshing())
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        if(!bInitialLoad)
+            pipelineSamples.push_back(SvnViewer::instance()->getLastRefreshDurationMs() * 1e6);
+    });
+
+    //wall time of the refresh graph as measured by SvnViewer itself, from start to its last finished step
+    runner.record("viewer.refresh.pipeline", pipelineSamples, 0);
+
+    if(bRefreshFailed)
+    {
+        std::cerr << "SvnViewer refresh reported errors or timed out." << std::endl;
+    }
+
+    runner.printSummary();
+    if(!runner.writeJson(outputPath))
+    {
+        return 1;
+    }
+
+    std::cout << "Results written to " << outputPath << std::endl;
+    return bRefreshFailed ? 1 : 0;
+}
@@ -0,0 +1,36 @@
+# Repository access layer shared by the application, the benchmarks and the UI latency harness.
+
+INCLUDEPATH += $$PWD
+
+#local diffs read the BASE texts from the working copy database
+LIBS += -lsqlite3
+
+SOURCES += \
+    $$PWD/Settings/AppSettings.cpp \
+    $$PWD/Logger/Logger.cpp \
+    $$PWD/Repos/SVN/SvnViewer.cpp \
+    $$PWD/Repos/SVN/SvnBackend.cpp \
+    $$PWD/Repos/SVN/WorkingCopyWatcher.cpp \
+    $$PWD/Repos/SVN/RefreshPipeline.cpp \
+    $$PWD/Repos/SVN/FileRevisionCache.cpp \
+    $$PWD/Repos/SVN/PristineStore.cpp \
+    $$PWD/Repos/SVN/ReviewSession.cpp \
+    $$PWD/Repos/SVN/HistorySearch.cpp \
+    $$PWD/Repos/SVN/RevisionStatsStore.cpp \
+    $$PWD/Diff/TextDiff.cpp
+
+HEADERS += \
+    $$PWD/Settings/AppSettings.h \
+    $$PWD/Logger/Logger.h \
+    $$PWD/Repos/SVN/SvnCommands.h \
+    $$PWD/Repos/SVN/SvnParsers.h \
+    $$PWD/Repos/SVN/SvnBackend.h \
+    $$PWD/Repos/SVN/WorkingCopyWatcher.h \
+    $$PWD/Repos/SVN/RefreshPipeline.h \
+    $$PWD/Repos/SVN/FileRevisionCache.h \
+    $$PWD/Repos/SVN/PristineStore.h \
+    $$PWD/Repos/SVN/ReviewSession.h \
+    $$PWD/Repos/SVN/HistorySearch.h \
+    $$PWD/Repos/SVN/RevisionStatsStore.h \
+    $$PWD/Repos/SVN/SvnViewer.h \
+    $$PWD/Diff/TextDiff.h
@@ -13,36 +13,7 @@ TARGET = CoSVN-GUI
 TEMPLATE = app
 
 
-SOURCES += main.cpp \
-    Settings/AppSettings.cpp \
-    Gui/AboutDialog.cpp \
-    Gui/ChooseRepoDialog.cpp \
-    Gui/CommitDialog.cpp \
-    Gui/MainWindow.cpp \
-    Gui/StatusDialog.cpp \
-    Logger/Logger.cpp \
-    Repos/SVN/SvnViewer.cpp \
-
-HEADERS += \
-    Settings/AppSettings.h \
-    Repos/SVN/SvnCommands.h \
-    Repos/SVN/SvnViewer.h \
-    Gui/AboutDialog.h \
-    Gui/ChooseRepoDialog.h \
-    Gui/CommitDialog.h \
-    Gui/CommonUI.h \
-    Gui/MainWindow.h \
-    Gui/StatusDialog.h \
-    Logger/Logger.h
-
-FORMS += \
-    Gui/StatusDialog.ui \
-    Gui/MainWindow.ui \
-    Gui/CommitDialog.ui \
-    Gui/ChooseRepoDialog.ui \
-    Gui/AboutDialog.ui
-
-RESOURCES += \
-    Resources/Resources.qrc
-
+SOURCES += main.cpp
 
+include(CoSVN-Core.pri)
+include(CoSVN-Gui.pri)
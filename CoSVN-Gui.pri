@@ -0,0 +1,46 @@
+# Widgets and dialogs of the application, without main.cpp.
+
+INCLUDEPATH += $$PWD
+
+SOURCES += \
+    $$PWD/Gui/AboutDialog.cpp \
+    $$PWD/Gui/BlameDialog.cpp \
+    $$PWD/Gui/ChooseRepoDialog.cpp \
+    $$PWD/Gui/CommitDialog.cpp \
+    $$PWD/Gui/DiffViewDialog.cpp \
+    $$PWD/Gui/GuiUpdateQueue.cpp \
+    $$PWD/Gui/HighlightDelegate.cpp \
+    $$PWD/Gui/HistorySearchDialog.cpp \
+    $$PWD/Gui/MainWindow.cpp \
+    $$PWD/Gui/RefreshScheduler.cpp \
+    $$PWD/Gui/ReviewDialog.cpp \
+    $$PWD/Gui/StatusDialog.cpp
+
+HEADERS += \
+    $$PWD/Gui/AboutDialog.h \
+    $$PWD/Gui/BlameDialog.h \
+    $$PWD/Gui/ChooseRepoDialog.h \
+    $$PWD/Gui/CommitDialog.h \
+    $$PWD/Gui/CommonUI.h \
+    $$PWD/Gui/DiffViewDialog.h \
+    $$PWD/Gui/GuiUpdateQueue.h \
+    $$PWD/Gui/HighlightDelegate.h \
+    $$PWD/Gui/HistorySearchDialog.h \
+    $$PWD/Gui/MainWindow.h \
+    $$PWD/Gui/RefreshScheduler.h \
+    $$PWD/Gui/ReviewDialog.h \
+    $$PWD/Gui/StatusDialog.h
+
+FORMS += \
+    $$PWD/Gui/StatusDialog.ui \
+    $$PWD/Gui/MainWindow.ui \
+    $$PWD/Gui/CommitDialog.ui \
+    $$PWD/Gui/DiffViewDialog.ui \
+    $$PWD/Gui/BlameDialog.ui \
+    $$PWD/Gui/ReviewDialog.ui \
+    $$PWD/Gui/HistorySearchDialog.ui \
+    $$PWD/Gui/ChooseRepoDialog.ui \
+    $$PWD/Gui/AboutDialog.ui
+
+RESOURCES += \
+    $$PWD/Resources/Resources.qrc
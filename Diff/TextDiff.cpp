@@ -0,0 +1,531 @@
+#include "TextDiff.h"
+
+#include <algorithm>
+#include <climits>
+
+//a NUL among the first bytes marks a binary file, like diff and svn do
+static const size_t BINARY_PROBE_BYTES = 8000;
+//lower bound of the search cost after which a split is taken without looking further
+static const int MIN_TOO_EXPENSIVE = 4096;
+
+TextDiff::TextDiff()
+    : m_bBinary(false)
+    , m_nDiagonalOffset(0)
+    , m_nTooExpensive(MIN_TOO_EXPENSIVE)
+{
+}
+
+void TextDiff::compute(std::string oldText, std::string newText)
+{
+    m_oldText.swap(oldText);
+    m_newText.swap(newText);
+    m_oldLines.clear();
+    m_newLines.clear();
+    m_hunks.clear();
+
+    m_bBinary = memchr(m_oldText.data(), '\0', std::min(m_oldText.size(), BINARY_PROBE_BYTES))
+             || memchr(m_newText.data(), '\0', std::min(m_newText.size(), BINARY_PROBE_BYTES));
+    if(m_bBinary)
+    {
+        return;
+    }
+
+    splitLines(m_oldText, m_oldLines);
+    splitLines(m_newText, m_newLines);
+    assignLineIds();
+
+    m_oldChanged.assign(m_oldLines.size(), 0);
+    m_newChanged.assign(m_newLines.size(), 0);
+
+    //a line without a match on the other side is changed for sure and only lengthens the search
+    m_oldSeq.clear();
+    m_newSeq.clear();
+    m_oldSeqLines.clear();
+    m_newSeqLines.clear();
+    {
+        std::vector<char> inOld, inNew;
+        int nIds = 0;
+        for(int nId : m_oldIds) nIds = std::max(nIds, nId + 1);
+        for(int nId : m_newIds) nIds = std::max(nIds, nId + 1);
+        inOld.assign(nIds, 0);
+        inNew.assign(nIds, 0);
+        for(int nId : m_oldIds) inOld[nId] = 1;
+        for(int nId : m_newIds) inNew[nId] = 1;
+
+        for(size_t i = 0; i < m_oldIds.size(); i++)
+        {
+            if(inNew[m_oldIds[i]])
+            {
+                m_oldSeq.push_back(m_oldIds[i]);
+                m_oldSeqLines.push_back(static_cast<int>(i));
+            }
+            else
+            {
+                m_oldChanged[i] = 1;
+            }
+        }
+
+        for(size_t i = 0; i < m_newIds.size(); i++)
+        {
+            if(inOld[m_newIds[i]])
+            {
+                m_newSeq.push_back(m_newIds[i]);
+                m_newSeqLines.push_back(static_cast<int>(i));
+            }
+            else
+            {
+                m_newChanged[i] = 1;
+            }
+        }
+    }
+
+    int nOld = static_cast<int>(m_oldSeq.size());
+    int nNew = static_cast<int>(m_newSeq.size());
+    m_nDiagonalOffset = nNew + 1;
+    m_forward.assign(nOld + nNew + 3, 0);
+    m_backward.assign(nOld + nNew + 3, 0);
+
+    //roughly the square root of the number of diagonals
+    m_nTooExpensive = 1;
+    for(int nDiagonals = nOld + nNew + 3; nDiagonals; nDiagonals >>= 2)
+    {
+        m_nTooExpensive <<= 1;
+    }
+    m_nTooExpensive = std::max(MIN_TOO_EXPENSIVE, m_nTooExpensive);
+
+    compareSequences(0, nOld, 0, nNew);
+
+    std::vector<int>().swap(m_forward);
+    std::vector<int>().swap(m_backward);
+    std::vector<int>().swap(m_oldSeq);
+    std::vector<int>().swap(m_newSeq);
+    std::vector<int>().swap(m_oldSeqLines);
+    std::vector<int>().swap(m_newSeqLines);
+    std::vector<int>().swap(m_oldIds);
+    std::vector<int>().swap(m_newIds);
+
+    buildHunks();
+}
+
+int TextDiff::getDeletedLinesCount() const
+{
+    int nCount = 0;
+    for(const Hunk& hunk : m_hunks)
+    {
+        nCount += hunk.m_nOldCount;
+    }
+
+    return nCount;
+}
+
+int TextDiff::getInsertedLinesCount() const
+{
+    int nCount = 0;
+    for(const Hunk& hunk : m_hunks)
+    {
+        nCount += hunk.m_nNewCount;
+    }
+
+    return nCount;
+}
+
+uint64_t TextDiff::hashLine(const char* pData, size_t nSize)
+{
+    //one multiply per 8 bytes instead of one per byte
+    uint64_t nHash = 0x9E3779B97F4A7C15ULL ^ nSize;
+    while(nSize >= 8)
+    {
+        uint64_t nWord;
+        memcpy(&nWord, pData, 8);
+        nHash = (nHash ^ nWord) * 0xFF51AFD7ED558CCDULL;
+        nHash ^= nHash >> 32;
+        pData += 8;
+        nSize -= 8;
+    }
+
+    uint64_t nWord = 0;
+    memcpy(&nWord, pData, nSize);
+    nHash = (nHash ^ nWord) * 0xC4CEB9FE1A85EC53ULL;
+    nHash ^= nHash >> 29;
+    return nHash;
+}
+
+void TextDiff::splitLines(const std::string& text, std::vector<StringRef>& lines)
+{
+    const char* pBegin = text.data();
+    const char* pEnd = pBegin + text.size();
+    lines.reserve(std::count(pBegin, pEnd, '\n') + 1);
+    while(pBegin < pEnd)
+    {
+        const char* pNewLine = static_cast<const char*>(memchr(pBegin, '\n', pEnd - pBegin));
+        const char* pLineEnd = pNewLine ? pNewLine : pEnd;
+        lines.push_back(StringRef(pBegin, pLineEnd - pBegin));
+        pBegin = pLineEnd + 1;
+    }
+}
+
+void TextDiff::assignLineIds()
+{
+    //open addressing; the low half of the hash is kept in the slot so that most probes touch only the table,
+    //a match is confirmed on the text of the first line of the class
+    struct Slot
+    {
+        uint32_t m_nTag;
+        int m_nClass;
+    };
+
+    size_t nLines = m_oldLines.size() + m_newLines.size();
+    size_t nSlots = 16;
+    int nSlotBits = 4;
+    while(nSlots < 2 * nLines)
+    {
+        nSlots <<= 1;
+        nSlotBits++;
+    }
+
+    Slot emptySlot = {0, -1};
+    std::vector<Slot> slots(nSlots, emptySlot);
+    std::vector<StringRef> classes;
+    classes.reserve(nLines);
+
+    //a last line without a newline is not the same line as one with it, so that adding or removing the final
+    //newline changes the last line instead of going unnoticed
+    std::vector<char> classesWithoutNewLine;
+    classesWithoutNewLine.reserve(nLines);
+
+    const std::string* texts[] = {&m_oldText, &m_newText};
+    const std::vector<StringRef>* sides[] = {&m_oldLines, &m_newLines};
+    std::vector<int>* ids[] = {&m_oldIds, &m_newIds};
+    for(int nSide = 0; nSide < 2; nSide++)
+    {
+        const std::string& text = *texts[nSide];
+        const bool bLastWithoutNewLine = !text.empty() && text[text.size() - 1] != '\n';
+        ids[nSide]->resize(sides[nSide]->size());
+        for(size_t i = 0; i < sides[nSide]->size(); i++)
+        {
+            const StringRef& line = (*sides[nSide])[i];
+            const bool bWithoutNewLine = bLastWithoutNewLine && i == sides[nSide]->size() - 1;
+            uint64_t nHash = hashLine(line.data(), line.size());
+            if(bWithoutNewLine)
+            {
+                nHash = ~nHash;
+            }
+            //the high bits are the best mixed ones
+            size_t nSlot = static_cast<size_t>(nHash >> (64 - nSlotBits));
+            while(true)
+            {
+                Slot& slot = slots[nSlot];
+                if(slot.m_nClass == -1)
+                {
+                    slot.m_nTag = static_cast<uint32_t>(nHash);
+                    slot.m_nClass = static_cast<int>(classes.size());
+                    classes.push_back(line);
+                    classesWithoutNewLine.push_back(bWithoutNewLine);
+                    (*ids[nSide])[i] = slot.m_nClass;
+                    break;
+                }
+
+                if(slot.m_nTag == static_cast<uint32_t>(nHash))
+                {
+                    const StringRef& first = classes[slot.m_nClass];
+                    if(classesWithoutNewLine[slot.m_nClass] == bWithoutNewLine
+                       && first.size() == line.size() && memcmp(first.data(), line.data(), line.size()) == 0)
+                    {
+                        (*ids[nSide])[i] = slot.m_nClass;
+                        break;
+                    }
+                }
+
+                nSlot = (nSlot + 1) & (nSlots - 1);
+            }
+        }
+    }
+}
+
+void TextDiff::compareSequences(int nOldBegin, int nOldEnd, int nNewBegin, int nNewEnd)
+{
+    //common prefix and suffix are unchanged
+    while(nOldBegin < nOldEnd && nNewBegin < nNewEnd && m_oldSeq[nOldBegin] == m_newSeq[nNewBegin])
+    {
+        nOldBegin++;
+        nNewBegin++;
+    }
+
+    while(nOldBegin < nOldEnd && nNewBegin < nNewEnd && m_oldSeq[nOldEnd - 1] == m_newSeq[nNewEnd - 1])
+    {
+        nOldEnd--;
+        nNewEnd--;
+    }
+
+    if(nOldBegin == nOldEnd)
+    {
+        for(int i = nNewBegin; i < nNewEnd; i++)
+        {
+            m_newChanged[m_newSeqLines[i]] = 1;
+        }
+        return;
+    }
+
+    if(nNewBegin == nNewEnd)
+    {
+        for(int i = nOldBegin; i < nOldEnd; i++)
+        {
+            m_oldChanged[m_oldSeqLines[i]] = 1;
+        }
+        return;
+    }
+
+    Partition partition;
+    findMiddleSnake(nOldBegin, nOldEnd, nNewBegin, nNewEnd, partition);
+    compareSequences(nOldBegin, partition.m_nOldMid, nNewBegin, partition.m_nNewMid);
+    compareSequences(partition.m_nOldMid, nOldEnd, partition.m_nNewMid, nNewEnd);
+}
+
+void TextDiff::findMiddleSnake(int nOldBegin, int nOldEnd, int nNewBegin, int nNewEnd, Partition& partition)
+{
+    //diagonal k holds the points with x - y == k, x indexing the old side and y the new one
+    int* pForward = &m_forward[m_nDiagonalOffset];
+    int* pBackward = &m_backward[m_nDiagonalOffset];
+
+    const int nMinDiagonal = nOldBegin - nNewEnd;
+    const int nMaxDiagonal = nOldEnd - nNewBegin;
+    const int nForwardMid = nOldBegin - nNewBegin;
+    const int nBackwardMid = nOldEnd - nNewEnd;
+    int nForwardMin = nForwardMid, nForwardMax = nForwardMid;
+    int nBackwardMin = nBackwardMid, nBackwardMax = nBackwardMid;
+    //with an odd delta the paths can only meet after a forward step
+    const bool bOdd = (nForwardMid - nBackwardMid) & 1;
+
+    pForward[nForwardMid] = nOldBegin;
+    pBackward[nBackwardMid] = nOldEnd;
+
+    for(int nCost = 1;; nCost++)
+    {
+        if(nForwardMin > nMinDiagonal)
+            pForward[--nForwardMin - 1] = -1;
+        else
+            nForwardMin++;
+
+        if(nForwardMax < nMaxDiagonal)
+            pForward[++nForwardMax + 1] = -1;
+        else
+            nForwardMax--;
+
+        for(int d = nForwardMax; d >= nForwardMin; d -= 2)
+        {
+            int nLow = pForward[d - 1], nHigh = pForward[d + 1];
+            int x = nLow >= nHigh ? nLow + 1 : nHigh;
+            int y = x - d;
+            while(x < nOldEnd && y < nNewEnd && m_oldSeq[x] == m_newSeq[y])
+            {
+                x++;
+                y++;
+            }
+
+            pForward[d] = x;
+            if(bOdd && nBackwardMin <= d && d <= nBackwardMax && pBackward[d] <= x)
+            {
+                partition.m_nOldMid = x;
+                partition.m_nNewMid = y;
+                return;
+            }
+        }
+
+        if(nBackwardMin > nMinDiagonal)
+            pBackward[--nBackwardMin - 1] = INT_MAX;
+        else
+            nBackwardMin++;
+
+        if(nBackwardMax < nMaxDiagonal)
+            pBackward[++nBackwardMax + 1] = INT_MAX;
+        else
+            nBackwardMax--;
+
+        for(int d = nBackwardMax; d >= nBackwardMin; d -= 2)
+        {
+            int nLow = pBackward[d - 1], nHigh = pBackward[d + 1];
+            int x = nLow < nHigh ? nLow : nHigh - 1;
+            int y = x - d;
+            while(x > nOldBegin && y > nNewBegin && m_oldSeq[x - 1] == m_newSeq[y - 1])
+            {
+                x--;
+                y--;
+            }
+
+            pBackward[d] = x;
+            if(!bOdd && nForwardMin <= d && d <= nForwardMax && x <= pForward[d])
+            {
+                partition.m_nOldMid = x;
+                partition.m_nNewMid = y;
+                return;
+            }
+        }
+
+        if(nCost < m_nTooExpensive)
+            continue;
+
+        //too costly to find the minimal split: take the point that got furthest in either direction
+        int nForwardBest = -1, nForwardBestX = nOldBegin;
+        for(int d = nForwardMax; d >= nForwardMin; d -= 2)
+        {
+            int x = std::min(pForward[d], nOldEnd);
+            int y = x - d;
+            if(y > nNewEnd)
+            {
+                x = nNewEnd + d;
+                y = nNewEnd;
+            }
+
+            if(x + y > nForwardBest)
+            {
+                nForwardBest = x + y;
+                nForwardBestX = x;
+            }
+        }
+
+        int nBackwardBest = INT_MAX, nBackwardBestX = nOldEnd;
+        for(int d = nBackwardMax; d >= nBackwardMin; d -= 2)
+        {
+            int x = std::max(nOldBegin, pBackward[d]);
+            int y = x - d;
+            if(y < nNewBegin)
+            {
+                x = nNewBegin + d;
+                y = nNewBegin;
+            }
+
+            if(x + y < nBackwardBest)
+            {
+                nBackwardBest = x + y;
+                nBackwardBestX = x;
+            }
+        }
+
+        if((nOldEnd + nNewEnd) - nBackwardBest < nForwardBest - (nOldBegin + nNewBegin))
+        {
+            partition.m_nOldMid = nForwardBestX;
+            partition.m_nNewMid = nForwardBest - nForwardBestX;
+        }
+        else
+        {
+            partition.m_nOldMid = nBackwardBestX;
+            partition.m_nNewMid = nBackwardBest - nBackwardBestX;
+        }
+        return;
+    }
+}
+
+void TextDiff::buildHunks()
+{
+    int nOld = getOldLinesCount();
+    int nNew = getNewLinesCount();
+    int i = 0, j = 0;
+    while(i < nOld || j < nNew)
+    {
+        if((i < nOld && m_oldChanged[i]) || (j < nNew && m_newChanged[j]))
+        {
+            Hunk hunk;
+            hunk.m_nOldStart = i;
+            hunk.m_nNewStart = j;
+            while(i < nOld && m_oldChanged[i])
+            {
+                i++;
+            }
+            while(j < nNew && m_newChanged[j])
+            {
+                j++;
+            }
+            hunk.m_nOldCount = i - hunk.m_nOldStart;
+            hunk.m_nNewCount = j - hunk.m_nNewStart;
+            m_hunks.push_back(hunk);
+        }
+        else
+        {
+            i++;
+            j++;
+        }
+    }
+
+    std::vector<char>().swap(m_oldChanged);
+    std::vector<char>().swap(m_newChanged);
+}
+
+std::vector<TextDiff::Row> TextDiff::buildUnifiedRows(int nContext) const
+{
+    return buildRows(nContext, false);
+}
+
+std::vector<TextDiff::Row> TextDiff::buildSideBySideRows(int nContext) const
+{
+    return buildRows(nContext, true);
+}
+
+std::vector<TextDiff::Row> TextDiff::buildRows(int nContext, bool bSideBySide) const
+{
+    const bool bWholeFile = nContext < 0;
+    std::vector<Row> rows;
+    int nOld = 0, nNew = 0;
+
+    auto addRow = [&rows](RowType type, int nOldLine, int nNewLine)
+    {
+        Row row;
+        row.m_type = type;
+        row.m_nOldLine = nOldLine;
+        row.m_nNewLine = nNewLine;
+        rows.push_back(row);
+    };
+
+    //the unchanged lines between the previous hunk (or the start) and nOldEnd: some after the previous hunk,
+    //some before the next one, a Skipped row for the rest
+    auto addGap = [&](int nOldEnd, bool bFirst, bool bLast)
+    {
+        int nGap = nOldEnd - nOld;
+        int nAfter = nGap, nBefore = 0;
+        if(!bWholeFile)
+        {
+            nAfter = bFirst ? 0 : std::min(nGap, nContext);
+            nBefore = bLast ? 0 : std::min(nGap - nAfter, nContext);
+        }
+
+        for(int i = 0; i < nAfter; i++)
+        {
+            addRow(Equal, nOld++, nNew++);
+        }
+
+        int nSkipped = nGap - nAfter - nBefore;
+        if(nSkipped > 0)
+        {
+            addRow(Skipped, nOld, nNew);
+            nOld += nSkipped;
+            nNew += nSkipped;
+        }
+
+        for(int i = 0; i < nBefore; i++)
+        {
+            addRow(Equal, nOld++, nNew++);
+        }
+    };
+
+    for(size_t nHunk = 0; nHunk < m_hunks.size(); nHunk++)
+    {
+        const Hunk& hunk = m_hunks[nHunk];
+        addGap(hunk.m_nOldStart, nHunk == 0, false);
+
+        int nPaired = bSideBySide ? std::min(hunk.m_nOldCount, hunk.m_nNewCount) : 0;
+        for(int i = 0; i < nPaired; i++)
+        {
+            addRow(Changed, nOld++, nNew++);
+        }
+        for(int i = nPaired; i < hunk.m_nOldCount; i++)
+        {
+            addRow(Deleted, nOld++, -1);
+        }
+        for(int i = nPaired; i < hunk.m_nNewCount; i++)
+        {
+            addRow(Inserted, -1, nNew++);
+        }
+    }
+
+    addGap(getOldLinesCount(), m_hunks.empty(), true);
+    return rows;
+}
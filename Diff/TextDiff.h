@@ -0,0 +1,110 @@
+#ifndef TEXTDIFF_H
+#define TEXTDIFF_H
+
+#include "Repos/SVN/SvnParsers.h"
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+//line based diff of two texts. Every distinct line gets an id (found through a hash computed 8 bytes at a time),
+//lines present on one side only are set aside, and the rest is compared with Myers' O(ND) algorithm in linear
+//space. Past a cost limit the search settles for a good split instead of the minimal one, like GNU diff does.
+class TextDiff
+{
+public:
+    struct Hunk
+    {
+        //0 based; a count of 0 means the hunk only inserts (old side) or only deletes (new side) before that line
+        int m_nOldStart;
+        int m_nOldCount;
+        int m_nNewStart;
+        int m_nNewCount;
+    };
+
+    enum RowType
+    {
+        Equal,
+        Deleted,
+        Inserted,
+        //side by side only: a deleted line next to the inserted line replacing it
+        Changed,
+        //unchanged lines left out between two hunks
+        Skipped
+    };
+
+    //one line of a view; the line numbers are 0 based and -1 for the side without a line.
+    //Skipped rows carry the first left out line of each side.
+    struct Row
+    {
+        RowType m_type;
+        int m_nOldLine;
+        int m_nNewLine;
+    };
+
+    TextDiff();
+    //the lines point into the texts held by this instance
+    TextDiff(const TextDiff&) = delete;
+    TextDiff& operator=(const TextDiff&) = delete;
+
+    //takes the texts by value, the lines of the result point into the copies kept here
+    void compute(std::string oldText, std::string newText);
+
+    bool isBinary() const { return m_bBinary; }
+    const std::vector<Hunk>& getHunks() const { return m_hunks; }
+    int getOldLinesCount() const { return static_cast<int>(m_oldLines.size()); }
+    int getNewLinesCount() const { return static_cast<int>(m_newLines.size()); }
+    StringRef getOldLine(int nLine) const { return m_oldLines[nLine]; }
+    StringRef getNewLine(int nLine) const { return m_newLines[nLine]; }
+    int getDeletedLinesCount() const;
+    int getInsertedLinesCount() const;
+
+    //rows of the views, only line numbers: the text is read from the lines when a row is painted.
+    //nContext unchanged lines are kept around every hunk, -1 keeps the whole file
+    std::vector<Row> buildUnifiedRows(int nContext) const;
+    std::vector<Row> buildSideBySideRows(int nContext) const;
+
+    static uint64_t hashLine(const char* pData, size_t nSize);
+
+private:
+    struct Partition
+    {
+        int m_nOldMid;
+        int m_nNewMid;
+    };
+
+    static void splitLines(const std::string& text, std::vector<StringRef>& lines);
+    void assignLineIds();
+    void compareSequences(int nOldBegin, int nOldEnd, int nNewBegin, int nNewEnd);
+    void findMiddleSnake(int nOldBegin, int nOldEnd, int nNewBegin, int nNewEnd, Partition& partition);
+    void buildHunks();
+    std::vector<Row> buildRows(int nContext, bool bSideBySide) const;
+
+private:
+    std::string m_oldText;
+    std::string m_newText;
+    std::vector<StringRef> m_oldLines;
+    std::vector<StringRef> m_newLines;
+    bool m_bBinary;
+
+    //line ids of both sides, then the compared subsequences: lines with a match on the other side, with their
+    //index in the full sequence
+    std::vector<int> m_oldIds;
+    std::vector<int> m_newIds;
+    std::vector<int> m_oldSeq;
+    std::vector<int> m_newSeq;
+    std::vector<int> m_oldSeqLines;
+    std::vector<int> m_newSeqLines;
+    std::vector<char> m_oldChanged;
+    std::vector<char> m_newChanged;
+
+    //furthest reaching x of every diagonal, forward and backward
+    std::vector<int> m_forward;
+    std::vector<int> m_backward;
+    int m_nDiagonalOffset;
+    int m_nTooExpensive;
+
+    std::vector<Hunk> m_hunks;
+};
+
+#endif // TEXTDIFF_H
@@ -0,0 +1,211 @@
+#include "BlameDialog.h"
+#include "ui_BlameDialog.h"
+
+#include <QAbstractTableModel>
+#include <QHeaderView>
+#include <QFontMetrics>
+#include <QColor>
+#include <QHash>
+#include <QSet>
+
+class BlameModel : public QAbstractTableModel
+{
+public:
+    BlameModel(const RevisionInfo::Collection& revisions, QObject* parent)
+        : QAbstractTableModel(parent)
+    {
+        //the log is newest first: the first revision gets age 1, the oldest one loaded age 0
+        int nIndex = 0;
+        for(const RevisionInfo& revision : revisions)
+        {
+            RevisionDetails& details = m_revisions[revision.m_No];
+            details.m_dAge = revisions.size() > 1 ? 1.0 - static_cast<double>(nIndex) / (revisions.size() - 1) : 1.0;
+            details.m_date = QString::fromStdString(revision.m_Date);
+            details.m_description = QString::fromStdString(revision.m_Description);
+            nIndex++;
+        }
+    }
+
+    void appendLines(const BlameLine::Collection& lines)
+    {
+        beginInsertRows(QModelIndex(), static_cast<int>(m_lines.size()), static_cast<int>(m_lines.size() + lines.size()) - 1);
+        m_lines.insert(m_lines.end(), lines.begin(), lines.end());
+        for(const BlameLine& line : lines)
+        {
+            m_revisionsSeen.insert(line.m_nRevision);
+            m_authorsSeen.insert(line.m_Author);
+        }
+        endInsertRows();
+    }
+
+    int getRevisionsCount() const { return m_revisionsSeen.size(); }
+    int getAuthorsCount() const { return static_cast<int>(m_authorsSeen.size()); }
+
+    virtual int rowCount(const QModelIndex& parent = QModelIndex()) const
+    {
+        return parent.isValid() ? 0 : static_cast<int>(m_lines.size());
+    }
+
+    virtual int columnCount(const QModelIndex& parent = QModelIndex()) const
+    {
+        return parent.isValid() ? 0 : 4;
+    }
+
+    virtual QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const
+    {
+        if(orientation != Qt::Horizontal || role != Qt::DisplayRole)
+        {
+            return QVariant();
+        }
+
+        static const char* headers[] = {"Revision", "Author", "", "Text"};
+        return QString(headers[section]);
+    }
+
+    virtual QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const
+    {
+        if(!index.isValid() || index.row() >= static_cast<int>(m_lines.size()))
+        {
+            return QVariant();
+        }
+
+        const BlameLine& line = m_lines[index.row()];
+        switch(role)
+        {
+        case Qt::DisplayRole:
+            switch(index.column())
+            {
+            case 0:
+                return line.m_nRevision == -1 ? QString("-") : QString::number(line.m_nRevision);
+            case 1:
+                return QString::fromStdString(line.m_Author);
+            case 2:
+                return QString::number(index.row() + 1);
+            default:
+                return QString::fromUtf8(line.m_Text.data(), static_cast<int>(line.m_Text.size()));
+            }
+
+        case Qt::BackgroundRole:
+            return getBackground(line);
+
+        case Qt::ToolTipRole:
+            return getToolTip(line);
+
+        case Qt::TextAlignmentRole:
+            return index.column() == 3 ? QVariant(Qt::AlignLeft | Qt::AlignVCenter) : QVariant(Qt::AlignRight | Qt::AlignVCenter);
+
+        default:
+            return QVariant();
+        }
+    }
+
+private:
+    struct RevisionDetails
+    {
+        double m_dAge;
+        QString m_date;
+        QString m_description;
+    };
+
+    QVariant getBackground(const BlameLine& line) const
+    {
+        //revisions older than the loaded log stay plain
+        QHash<int, RevisionDetails>::const_iterator it = m_revisions.find(line.m_nRevision);
+        if(it == m_revisions.end())
+        {
+            return QVariant();
+        }
+
+        int nHue = static_cast<int>(qHash(QString::fromStdString(line.m_Author)) % 360);
+        return QColor::fromHsv(nHue, 20 + static_cast<int>(it->m_dAge * 80), 255);
+    }
+
+    QVariant getToolTip(const BlameLine& line) const
+    {
+        if(line.m_nRevision == -1)
+        {
+            return QString("Not committed");
+        }
+
+        QString toolTip = QString("r%1 by %2").arg(line.m_nRevision).arg(QString::fromStdString(line.m_Author));
+        QHash<int, RevisionDetails>::const_iterator it = m_revisions.find(line.m_nRevision);
+        if(it != m_revisions.end())
+        {
+            toolTip += ", " + it->m_date + "\n" + it->m_description;
+        }
+        return toolTip;
+    }
+
+private:
+    BlameLine::Collection m_lines;
+    QHash<int, RevisionDetails> m_revisions;
+    QSet<int> m_revisionsSeen;
+    std::set<std::string> m_authorsSeen;
+};
+
+BlameDialog::BlameDialog(const QString& path, int nRevision, const RevisionInfo::Collection& revisions, QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::BlameDialog),
+    m_path(path),
+    m_nRevision(nRevision)
+{
+    ui->setupUi(this);
+
+    setWindowTitle(nRevision == -1 ? QString("Blame of %1").arg(path) : QString("Blame of %1 at revision %2").arg(path).arg(nRevision));
+    ui->labelTitle->setText(path);
+
+    m_pModel = new BlameModel(revisions, this);
+    ui->tableView->setModel(m_pModel);
+    ui->tableView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    ui->tableView->setSelectionMode(QAbstractItemView::SingleSelection);
+    ui->tableView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    ui->tableView->setShowGrid(false);
+    ui->tableView->setWordWrap(false);
+    ui->tableView->verticalHeader()->setVisible(false);
+    QFont font("Monospace");
+    font.setStyleHint(QFont::TypeWriter);
+    ui->tableView->setFont(font);
+    ui->tableView->verticalHeader()->setDefaultSectionSize(QFontMetrics(ui->tableView->font()).height() + 2);
+
+    //fixed widths, nothing is measured while lines stream in
+    QFontMetrics metrics(ui->tableView->font());
+    ui->tableView->setColumnWidth(0, metrics.width("0000000") + 12);
+    ui->tableView->setColumnWidth(1, metrics.width("000000000000") + 12);
+    ui->tableView->setColumnWidth(2, metrics.width("000000") + 12);
+    ui->tableView->horizontalHeader()->setStretchLastSection(true);
+}
+
+BlameDialog::~BlameDialog()
+{
+    delete ui;
+}
+
+void BlameDialog::appendLines(int nFirstLine, const BlameLine::Collection& lines)
+{
+    if(nFirstLine != m_pModel->rowCount())
+    {
+        return;
+    }
+
+    m_pModel->appendLines(lines);
+    ui->labelStats->setText(QString("Loading... %1 lines").arg(m_pModel->rowCount()));
+}
+
+void BlameDialog::setCompleted(bool bSuccess)
+{
+    if(!bSuccess)
+    {
+        ui->labelStats->setText(QString("svn blame failed after %1 lines.").arg(m_pModel->rowCount()));
+        return;
+    }
+
+    ui->labelStats->setText(QString("%1 lines, %2 revisions, %3 authors")
+                            .arg(m_pModel->rowCount())
+                            .arg(m_pModel->getRevisionsCount())
+                            .arg(m_pModel->getAuthorsCount()));
+}
+
+void BlameDialog::on_closeButton_clicked()
+{
+    close();
+}
@@ -0,0 +1,41 @@
+#ifndef BLAMEDIALOG_H
+#define BLAMEDIALOG_H
+
+#include <QDialog>
+
+#include "Repos/SVN/SvnCommands.h"
+
+namespace Ui {
+class BlameDialog;
+}
+
+class BlameModel;
+
+//annotated lines of one file; rows are appended while svn blame still runs. Lines are coloured per author,
+//stronger for the newer revisions of the log
+class BlameDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    BlameDialog(const QString& path, int nRevision, const RevisionInfo::Collection& revisions, QWidget *parent = 0);
+    ~BlameDialog();
+
+    const QString& getPath() const { return m_path; }
+    int getRevision() const { return m_nRevision; }
+
+    //lines that don't continue the rows already shown are dropped
+    void appendLines(int nFirstLine, const BlameLine::Collection& lines);
+    void setCompleted(bool bSuccess);
+
+private slots:
+    void on_closeButton_clicked();
+
+private:
+    Ui::BlameDialog *ui;
+    BlameModel* m_pModel;
+    QString m_path;
+    int m_nRevision;
+};
+
+#endif // BLAMEDIALOG_H
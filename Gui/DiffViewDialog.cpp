@@ -0,0 +1,312 @@
+#include "DiffViewDialog.h"
+#include "ui_DiffViewDialog.h"
+
+#include <QAbstractTableModel>
+#include <QHeaderView>
+#include <QFontMetrics>
+#include <QColor>
+
+//unchanged lines shown around every change when the whole file is not displayed
+static const int CONTEXT_LINES = 3;
+
+class DiffModel : public QAbstractTableModel
+{
+public:
+    DiffModel(QObject* parent)
+        : QAbstractTableModel(parent)
+        , m_bSideBySide(true)
+    {
+    }
+
+    void setRows(std::shared_ptr<const TextDiff> spDiff, bool bSideBySide, bool bWholeFile)
+    {
+        beginResetModel();
+        m_spDiff = spDiff;
+        m_bSideBySide = bSideBySide;
+        m_rows.clear();
+        if(m_spDiff && !m_spDiff->isBinary())
+        {
+            int nContext = bWholeFile ? -1 : CONTEXT_LINES;
+            m_rows = bSideBySide ? m_spDiff->buildSideBySideRows(nContext) : m_spDiff->buildUnifiedRows(nContext);
+        }
+        endResetModel();
+    }
+
+    const TextDiff::Row& getRow(int nRow) const { return m_rows[nRow]; }
+
+    //side by side: old line, old text, new line, new text; unified: old line, new line, text
+    int getTextColumnCount() const { return m_bSideBySide ? 2 : 1; }
+    bool isTextColumn(int nColumn) const { return m_bSideBySide ? (nColumn == 1 || nColumn == 3) : nColumn == 2; }
+
+    virtual int rowCount(const QModelIndex& parent = QModelIndex()) const
+    {
+        return parent.isValid() ? 0 : static_cast<int>(m_rows.size());
+    }
+
+    virtual int columnCount(const QModelIndex& parent = QModelIndex()) const
+    {
+        return parent.isValid() ? 0 : (m_bSideBySide ? 4 : 3);
+    }
+
+    virtual QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const
+    {
+        if(orientation != Qt::Horizontal || role != Qt::DisplayRole)
+        {
+            return QVariant();
+        }
+
+        static const char* sideBySide[] = {"", "Before", "", "After"};
+        static const char* unified[] = {"", "", "Changes"};
+        return QString(m_bSideBySide ? sideBySide[section] : unified[section]);
+    }
+
+    virtual QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const
+    {
+        if(!index.isValid() || index.row() >= static_cast<int>(m_rows.size()))
+        {
+            return QVariant();
+        }
+
+        const TextDiff::Row& row = m_rows[index.row()];
+        switch(role)
+        {
+        case Qt::DisplayRole:
+            return getText(index.row(), index.column());
+
+        case Qt::BackgroundRole:
+            return getBackground(row, index.column());
+
+        case Qt::TextAlignmentRole:
+            return isTextColumn(index.column()) ? QVariant(Qt::AlignLeft | Qt::AlignVCenter) : QVariant(Qt::AlignRight | Qt::AlignVCenter);
+
+        default:
+            return QVariant();
+        }
+    }
+
+private:
+    QVariant getText(int nRow, int nColumn) const
+    {
+        const TextDiff::Row& row = m_rows[nRow];
+        if(row.m_type == TextDiff::Skipped)
+        {
+            return isTextColumn(nColumn) ? QString("... %1 unchanged lines").arg(getSkippedCount(nRow)) : QString();
+        }
+
+        bool bOldSide = m_bSideBySide ? nColumn < 2 : (nColumn == 0 || (nColumn == 2 && row.m_nOldLine != -1));
+        int nLine = bOldSide ? row.m_nOldLine : row.m_nNewLine;
+        if(!isTextColumn(nColumn))
+        {
+            nLine = nColumn == 0 ? row.m_nOldLine : row.m_nNewLine;
+            return nLine == -1 ? QString() : QString::number(nLine + 1);
+        }
+
+        if(nLine == -1)
+        {
+            return QString();
+        }
+
+        StringRef line = bOldSide ? m_spDiff->getOldLine(nLine) : m_spDiff->getNewLine(nLine);
+        QString prefix;
+        if(!m_bSideBySide)
+        {
+            prefix = row.m_type == TextDiff::Deleted ? "- " : row.m_type == TextDiff::Inserted ? "+ " : "  ";
+        }
+        return prefix + QString::fromUtf8(line.data(), static_cast<int>(line.size()));
+    }
+
+    QVariant getBackground(const TextDiff::Row& row, int nColumn) const
+    {
+        bool bOldSide = m_bSideBySide && nColumn < 2;
+        switch(row.m_type)
+        {
+        case TextDiff::Deleted:
+            return (!m_bSideBySide || bOldSide) ? QColor(255, 220, 220) : QColor(235, 235, 235);
+        case TextDiff::Inserted:
+            return (!m_bSideBySide || !bOldSide) ? QColor(215, 250, 215) : QColor(235, 235, 235);
+        case TextDiff::Changed:
+            return bOldSide ? QColor(255, 235, 200) : QColor(230, 245, 200);
+        case TextDiff::Skipped:
+            return QColor(225, 230, 240);
+        default:
+            return QVariant();
+        }
+    }
+
+    int getSkippedCount(int nRow) const
+    {
+        const TextDiff::Row& row = m_rows[nRow];
+        if(nRow + 1 >= static_cast<int>(m_rows.size()))
+        {
+            return m_spDiff->getOldLinesCount() - row.m_nOldLine;
+        }
+
+        const TextDiff::Row& next = m_rows[nRow + 1];
+        return next.m_nOldLine != -1 ? next.m_nOldLine - row.m_nOldLine : next.m_nNewLine - row.m_nNewLine;
+    }
+
+private:
+    std::shared_ptr<const TextDiff> m_spDiff;
+    std::vector<TextDiff::Row> m_rows;
+    bool m_bSideBySide;
+};
+
+DiffViewDialog::DiffViewDialog(const QString& path, int nRevision, QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::DiffViewDialog),
+    m_path(path),
+    m_nRevision(nRevision)
+{
+    ui->setupUi(this);
+
+    setWindowTitle(nRevision == -1 ? QString("Local changes of %1").arg(path) : QString("Changes of %1 in revision %2").arg(path).arg(nRevision));
+    ui->labelTitle->setText(path);
+
+    m_pModel = new DiffModel(this);
+    ui->tableView->setModel(m_pModel);
+    ui->tableView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    ui->tableView->setSelectionMode(QAbstractItemView::SingleSelection);
+    ui->tableView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    ui->tableView->setShowGrid(false);
+    ui->tableView->setWordWrap(false);
+    ui->tableView->verticalHeader()->setVisible(false);
+    QFont font("Monospace");
+    font.setStyleHint(QFont::TypeWriter);
+    ui->tableView->setFont(font);
+    //every row has the height of one line, nothing has to be measured
+    ui->tableView->verticalHeader()->setDefaultSectionSize(QFontMetrics(ui->tableView->font()).height() + 2);
+
+    ui->checkBoxSideBySide->setEnabled(false);
+    ui->checkBoxWholeFile->setEnabled(false);
+    ui->previousButton->setEnabled(false);
+    ui->nextButton->setEnabled(false);
+}
+
+DiffViewDialog::~DiffViewDialog()
+{
+    delete ui;
+}
+
+void DiffViewDialog::setDiff(std::shared_ptr<const TextDiff> spDiff)
+{
+    m_spDiff = spDiff;
+    if(!m_spDiff)
+    {
+        ui->labelStats->setText("The file could not be fetched.");
+        return;
+    }
+
+    if(m_spDiff->isBinary())
+    {
+        ui->labelStats->setText("Binary file, no line changes to show.");
+        return;
+    }
+
+    ui->labelStats->setText(QString("%1 changes, %2 lines deleted, %3 lines inserted")
+                            .arg(static_cast<int>(m_spDiff->getHunks().size()))
+                            .arg(m_spDiff->getDeletedLinesCount())
+                            .arg(m_spDiff->getInsertedLinesCount()));
+
+    ui->checkBoxSideBySide->setEnabled(true);
+    ui->checkBoxWholeFile->setEnabled(true);
+    ui->previousButton->setEnabled(!m_spDiff->getHunks().empty());
+    ui->nextButton->setEnabled(!m_spDiff->getHunks().empty());
+
+    showRows();
+    goToChange(1);
+}
+
+void DiffViewDialog::setEmbedded()
+{
+    setWindowFlags(Qt::Widget);
+    ui->labelTitle->hide();
+    ui->closeButton->hide();
+}
+
+void DiffViewDialog::showRows()
+{
+    m_pModel->setRows(m_spDiff, ui->checkBoxSideBySide->isChecked(), ui->checkBoxWholeFile->isChecked());
+
+    //line numbers get the width of the largest one, the text columns share the rest
+    QFontMetrics metrics(ui->tableView->font());
+    int nNumbersWidth = metrics.width(QString::number(qMax(m_spDiff->getOldLinesCount(), m_spDiff->getNewLinesCount()))) + 12;
+    int nTextWidth = qMax(200, (ui->tableView->viewport()->width() - 2 * nNumbersWidth) / m_pModel->getTextColumnCount());
+    for(int i = 0; i < m_pModel->columnCount(); i++)
+    {
+        ui->tableView->setColumnWidth(i, m_pModel->isTextColumn(i) ? nTextWidth : nNumbersWidth);
+    }
+    ui->tableView->horizontalHeader()->setStretchLastSection(true);
+}
+
+void DiffViewDialog::goToChange(int nDirection)
+{
+    int nRows = m_pModel->rowCount();
+    if(!nRows)
+    {
+        return;
+    }
+
+    QModelIndexList selected = ui->tableView->selectionModel()->selectedRows();
+    int nRow = selected.isEmpty() ? (nDirection > 0 ? -1 : nRows) : selected.first().row();
+
+    auto isChange = [this](int nRow)
+    {
+        TextDiff::RowType type = m_pModel->getRow(nRow).m_type;
+        return type != TextDiff::Equal && type != TextDiff::Skipped;
+    };
+
+    //leave the change the selection is in, then find the next one
+    while(nRow >= 0 && nRow < nRows && isChange(nRow))
+    {
+        nRow += nDirection;
+    }
+    nRow += nDirection;
+    while(nRow >= 0 && nRow < nRows && !isChange(nRow))
+    {
+        nRow += nDirection;
+    }
+    if(nRow < 0 || nRow >= nRows)
+    {
+        return;
+    }
+
+    //backwards the first row of the change is wanted too
+    while(nDirection < 0 && nRow > 0 && isChange(nRow - 1))
+    {
+        nRow--;
+    }
+
+    ui->tableView->selectRow(nRow);
+    ui->tableView->scrollTo(m_pModel->index(nRow, 0), QAbstractItemView::PositionAtCenter);
+}
+
+void DiffViewDialog::on_closeButton_clicked()
+{
+    close();
+}
+
+void DiffViewDialog::on_checkBoxSideBySide_toggled(bool /*checked*/)
+{
+    if(m_spDiff)
+    {
+        showRows();
+    }
+}
+
+void DiffViewDialog::on_checkBoxWholeFile_toggled(bool /*checked*/)
+{
+    if(m_spDiff)
+    {
+        showRows();
+    }
+}
+
+void DiffViewDialog::on_previousButton_clicked()
+{
+    goToChange(-1);
+}
+
+void DiffViewDialog::on_nextButton_clicked()
+{
+    goToChange(1);
+}
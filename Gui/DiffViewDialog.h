@@ -0,0 +1,53 @@
+#ifndef DIFFVIEWDIALOG_H
+#define DIFFVIEWDIALOG_H
+
+#include <QDialog>
+
+#include "Diff/TextDiff.h"
+
+#include <memory>
+
+namespace Ui {
+class DiffViewDialog;
+}
+
+class DiffModel;
+
+//side by side or unified view of one file diff; the rows only hold line numbers, the text of a line is read
+//from the diff when the row is painted, so large files open at once
+class DiffViewDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    DiffViewDialog(const QString& path, int nRevision, QWidget *parent = 0);
+    ~DiffViewDialog();
+
+    const QString& getPath() const { return m_path; }
+    int getRevision() const { return m_nRevision; }
+
+    //an empty spDiff means the file could not be fetched
+    void setDiff(std::shared_ptr<const TextDiff> spDiff);
+    //turns the dialog into a plain widget for a view that embeds it
+    void setEmbedded();
+
+private slots:
+    void on_closeButton_clicked();
+    void on_checkBoxSideBySide_toggled(bool checked);
+    void on_checkBoxWholeFile_toggled(bool checked);
+    void on_previousButton_clicked();
+    void on_nextButton_clicked();
+
+private:
+    void showRows();
+    void goToChange(int nDirection);
+
+private:
+    Ui::DiffViewDialog *ui;
+    DiffModel* m_pModel;
+    QString m_path;
+    int m_nRevision;
+    std::shared_ptr<const TextDiff> m_spDiff;
+};
+
+#endif // DIFFVIEWDIALOG_H
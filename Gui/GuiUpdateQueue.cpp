@@ -0,0 +1,135 @@
+#include "GuiUpdateQueue.h"
+
+#include <QApplication>
+#include <QMetaObject>
+
+//one frame at 60 Hz
+static const qint64 FRAME_NS = 16666667;
+//latency samples kept for getLatencySamples
+static const size_t MAX_LATENCY_SAMPLES = 1000;
+
+GuiUpdateQueue::GuiUpdateQueue(QObject* pTarget)
+    : QObject(pTarget)
+    , m_pTarget(pTarget)
+    , m_nLastFlushNs(-FRAME_NS)
+    , m_bScheduled(false)
+    , m_nNextSample(0)
+{
+    m_clock.start();
+
+    m_pFlushTimer = new QTimer(this);
+    m_pFlushTimer->setSingleShot(true);
+    connect(m_pFlushTimer, SIGNAL(timeout()), SLOT(on_flush_timer_timeout()));
+}
+
+GuiUpdateQueue::~GuiUpdateQueue()
+{
+    std::unique_lock<std::mutex> locker(m_mutex);
+    for(PendingUpdate& update : m_pending)
+    {
+        delete update.m_pEvent;
+    }
+}
+
+void GuiUpdateQueue::post(QEvent* pEvent)
+{
+    std::unique_lock<std::mutex> locker(m_mutex);
+    m_stats[pEvent->type()].m_nPosted++;
+    m_stats[QEvent::None].m_nPosted++;
+
+    //only the latest pending update of the type may take the new one: merging into an earlier one would deliver
+    //it ahead of the updates that could not be merged
+    for(std::list<PendingUpdate>::reverse_iterator it = m_pending.rbegin(); it != m_pending.rend(); ++it)
+    {
+        if(it->m_pEvent->type() != pEvent->type())
+            continue;
+
+        MergeableEvent* pPending = dynamic_cast<MergeableEvent*>(it->m_pEvent);
+        MergeableEvent* pLater = dynamic_cast<MergeableEvent*>(pEvent);
+        if((!pPending && !pLater) || (pPending && pLater && pPending->mergeWith(*pLater)))
+        {
+            m_stats[pEvent->type()].m_nMerged++;
+            m_stats[QEvent::None].m_nMerged++;
+            delete pEvent;
+            return;
+        }
+        break;
+    }
+
+    PendingUpdate update;
+    update.m_pEvent = pEvent;
+    update.m_nPostedAtNs = m_clock.nsecsElapsed();
+    m_pending.push_back(update);
+
+    //the flush timer belongs to the GUI thread, it can't be started from a worker
+    if(!m_bScheduled)
+    {
+        m_bScheduled = true;
+        QMetaObject::invokeMethod(this, "on_schedule_requested", Qt::QueuedConnection);
+    }
+}
+
+std::map<int, GuiUpdateQueue::Stats> GuiUpdateQueue::getStats() const
+{
+    std::unique_lock<std::mutex> locker(m_mutex);
+    return m_stats;
+}
+
+std::vector<double> GuiUpdateQueue::getLatencySamples() const
+{
+    std::unique_lock<std::mutex> locker(m_mutex);
+    return m_latencySamples;
+}
+
+void GuiUpdateQueue::on_schedule_requested()
+{
+    //deliver right away unless the previous delivery was less than a frame ago
+    qint64 nSinceFlushNs = m_clock.nsecsElapsed() - m_nLastFlushNs;
+    int nDelayMs = nSinceFlushNs >= FRAME_NS ? 0 : static_cast<int>((FRAME_NS - nSinceFlushNs + 999999) / 1000000);
+    m_pFlushTimer->start(nDelayMs);
+}
+
+void GuiUpdateQueue::on_flush_timer_timeout()
+{
+    std::list<PendingUpdate> pending;
+    {
+        std::unique_lock<std::mutex> locker(m_mutex);
+        pending.swap(m_pending);
+        m_bScheduled = false;
+    }
+
+    m_nLastFlushNs = m_clock.nsecsElapsed();
+    for(PendingUpdate& update : pending)
+    {
+        double dLatencyMs = (m_clock.nsecsElapsed() - update.m_nPostedAtNs) / 1e6;
+        int nType = update.m_pEvent->type();
+
+        QApplication::sendEvent(m_pTarget, update.m_pEvent);
+        delete update.m_pEvent;
+
+        std::unique_lock<std::mutex> locker(m_mutex);
+        addLatencySample(nType, dLatencyMs);
+    }
+}
+
+void GuiUpdateQueue::addLatencySample(int nType, double dLatencyMs)
+{
+    Stats* stats[] = {&m_stats[nType], &m_stats[QEvent::None]};
+    for(Stats* pStats : stats)
+    {
+        pStats->m_nDelivered++;
+        pStats->m_dTotalLatencyMs += dLatencyMs;
+        if(dLatencyMs > pStats->m_dMaxLatencyMs)
+            pStats->m_dMaxLatencyMs = dLatencyMs;
+    }
+
+    if(m_latencySamples.size() < MAX_LATENCY_SAMPLES)
+    {
+        m_latencySamples.push_back(dLatencyMs);
+    }
+    else
+    {
+        m_latencySamples[m_nNextSample] = dLatencyMs;
+        m_nNextSample = (m_nNextSample + 1) % MAX_LATENCY_SAMPLES;
+    }
+}
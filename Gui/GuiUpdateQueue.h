@@ -0,0 +1,96 @@
+#ifndef GUIUPDATEQUEUE_H
+#define GUIUPDATEQUEUE_H
+
+#include <QObject>
+#include <QEvent>
+#include <QTimer>
+#include <QElapsedTimer>
+
+#include <mutex>
+#include <list>
+#include <map>
+#include <vector>
+
+//an update that can absorb a later update of the same type while both wait in the queue
+class MergeableEvent : public QEvent
+{
+public:
+    MergeableEvent(QEvent::Type type)
+        : QEvent(type)
+    {
+    }
+
+    //returns false when both have to be delivered
+    virtual bool mergeWith(const MergeableEvent& later) = 0;
+};
+
+//carries view updates from the svn worker threads to the GUI thread. A new update is merged into the latest pending
+//one of the same type (plain QEvents are dropped, MergeableEvents merged) and updates are delivered to the target
+//in order, at most once per frame.
+class GuiUpdateQueue : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Stats
+    {
+        Stats()
+            : m_nPosted(0)
+            , m_nDelivered(0)
+            , m_nMerged(0)
+            , m_dMaxLatencyMs(0)
+            , m_dTotalLatencyMs(0)
+        {
+        }
+
+        double getMeanLatencyMs() const
+        {
+            return m_nDelivered ? m_dTotalLatencyMs / m_nDelivered : 0;
+        }
+
+        int m_nPosted;
+        int m_nDelivered;
+        int m_nMerged;
+        double m_dMaxLatencyMs;
+        double m_dTotalLatencyMs;
+    };
+
+    GuiUpdateQueue(QObject* pTarget);
+    ~GuiUpdateQueue();
+
+    //thread safe; takes ownership of pEvent
+    void post(QEvent* pEvent);
+
+    //per event type, and the totals under QEvent::None
+    std::map<int, Stats> getStats() const;
+    //queue latency of the last delivered updates, in milliseconds
+    std::vector<double> getLatencySamples() const;
+
+private slots:
+    void on_schedule_requested();
+    void on_flush_timer_timeout();
+
+private:
+    struct PendingUpdate
+    {
+        QEvent* m_pEvent;
+        qint64 m_nPostedAtNs;
+    };
+
+    void addLatencySample(int nType, double dLatencyMs);
+
+private:
+    QObject* m_pTarget;
+    QTimer* m_pFlushTimer;
+    QElapsedTimer m_clock;
+    qint64 m_nLastFlushNs;
+
+    mutable std::mutex m_mutex;
+    std::list<PendingUpdate> m_pending;
+    bool m_bScheduled;
+    std::map<int, Stats> m_stats;
+    std::vector<double> m_latencySamples;
+    size_t m_nNextSample;
+};
+
+#endif // GUIUPDATEQUEUE_H
@@ -0,0 +1,241 @@
+#include "HighlightDelegate.h"
+
+#include <QApplication>
+#include <QPainter>
+#include <QFontMetrics>
+#include <QColor>
+#include <QtCore/qmath.h>
+
+//laid out lines kept, a few screens of rows
+static const int MAX_CACHED_LAYOUTS = 2000;
+//how often the matching thread checks whether its filter is still the current one
+static const int TEXTS_PER_CHECK = 256;
+
+HighlightDelegate::HighlightDelegate(QAbstractItemView* pView)
+    : QStyledItemDelegate(pView)
+    , m_pView(pView)
+    , m_layouts(MAX_CACHED_LAYOUTS)
+    , m_nGeneration(0)
+    , m_bStopping(false)
+{
+    m_matchThread = std::thread(&HighlightDelegate::matchThread, this);
+}
+
+HighlightDelegate::~HighlightDelegate()
+{
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        m_bStopping = true;
+        //the batch being matched is abandoned at the next check
+        m_nGeneration++;
+    }
+    m_condition.notify_one();
+    m_matchThread.join();
+}
+
+void HighlightDelegate::setFilter(const QString& strFilter)
+{
+    if(strFilter == m_filter)
+    {
+        return;
+    }
+
+    m_filter = strFilter;
+    m_spans.clear();
+    m_layouts.clear();
+
+    std::lock_guard<std::mutex> locker(m_mutex);
+    m_nGeneration++;
+    m_batches.clear();
+    m_pendingSpans.clear();
+}
+
+void HighlightDelegate::matchTexts(const QStringList& texts)
+{
+    if(m_filter.isEmpty() || texts.isEmpty())
+    {
+        return;
+    }
+
+    Batch batch;
+    batch.m_filter = m_filter;
+    batch.m_texts = texts;
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        batch.m_nGeneration = m_nGeneration;
+        m_batches.push_back(batch);
+    }
+    m_condition.notify_one();
+}
+
+void HighlightDelegate::matchThread()
+{
+    while(true)
+    {
+        Batch batch;
+        {
+            std::unique_lock<std::mutex> locker(m_mutex);
+            m_condition.wait(locker, [this]() { return m_bStopping || !m_batches.empty(); });
+            if(m_bStopping)
+            {
+                return;
+            }
+
+            batch = m_batches.front();
+            m_batches.pop_front();
+        }
+
+        QHash<QString, Spans> spans;
+        for(int i = 0; i < batch.m_texts.size(); i++)
+        {
+            if(i % TEXTS_PER_CHECK == 0 && m_nGeneration != batch.m_nGeneration)
+            {
+                break;
+            }
+
+            Spans textSpans = findSpans(batch.m_texts[i], batch.m_filter);
+            if(!textSpans.isEmpty())
+            {
+                spans.insert(batch.m_texts[i], textSpans);
+            }
+        }
+
+        std::lock_guard<std::mutex> locker(m_mutex);
+        if(m_nGeneration != batch.m_nGeneration)
+        {
+            continue;
+        }
+
+        //one repaint for everything arrived since the previous one
+        bool bNotify = m_pendingSpans.isEmpty();
+        for(QHash<QString, Spans>::const_iterator it = spans.begin(); it != spans.end(); ++it)
+        {
+            m_pendingSpans.insert(it.key(), it.value());
+        }
+        if(bNotify && !m_pendingSpans.isEmpty())
+        {
+            QMetaObject::invokeMethod(this, "on_spans_ready", Qt::QueuedConnection);
+        }
+    }
+}
+
+void HighlightDelegate::on_spans_ready()
+{
+    QHash<QString, Spans> spans;
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        spans.swap(m_pendingSpans);
+    }
+
+    for(QHash<QString, Spans>::const_iterator it = spans.begin(); it != spans.end(); ++it)
+    {
+        m_spans.insert(it.key(), it.value());
+    }
+
+    m_pView->viewport()->update();
+}
+
+HighlightDelegate::Spans HighlightDelegate::findSpans(const QString& text, const QString& strFilter)
+{
+    Spans spans;
+    if(strFilter.isEmpty())
+    {
+        return spans;
+    }
+
+    int nPos = text.indexOf(strFilter, 0, Qt::CaseInsensitive);
+    while(nPos != -1)
+    {
+        spans.append(qMakePair(nPos, strFilter.length()));
+        nPos = text.indexOf(strFilter, nPos + strFilter.length(), Qt::CaseInsensitive);
+    }
+
+    return spans;
+}
+
+void HighlightDelegate::paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const
+{
+    QStyleOptionViewItemV4 optionV4 = option;
+    initStyleOption(&optionV4, index);
+
+    //most items have nothing to highlight, or not yet: the style paints them as usual
+    QHash<QString, Spans>::const_iterator itSpans = m_spans.find(optionV4.text);
+    if(itSpans == m_spans.end())
+    {
+        QStyledItemDelegate::paint(painter, option, index);
+        return;
+    }
+
+    QStyle* style = optionV4.widget ? optionV4.widget->style() : QApplication::style();
+
+    QString text = optionV4.text;
+    optionV4.text = QString();
+    style->drawControl(QStyle::CE_ItemViewItem, &optionV4, painter, optionV4.widget);
+
+    //the same margins as the text painted by the style
+    QRect textRect = style->subElementRect(QStyle::SE_ItemViewItemText, &optionV4, optionV4.widget);
+    int nMargin = style->pixelMetric(QStyle::PM_FocusFrameHMargin, 0, optionV4.widget) + 1;
+    textRect.adjust(nMargin, 0, -nMargin, 0);
+    if(textRect.width() <= 0)
+    {
+        return;
+    }
+
+    QTextLayout* pLayout = getLayout(text, itSpans.value(), optionV4.font, textRect.width());
+    QTextLine line = pLayout->lineAt(0);
+    QSize lineSize(qCeil(line.naturalTextWidth()), qCeil(line.height()));
+    QRect lineRect = QStyle::alignedRect(optionV4.direction, optionV4.displayAlignment, lineSize, textRect);
+
+    QPalette::ColorGroup colorGroup = (optionV4.state & QStyle::State_Enabled) ? QPalette::Normal : QPalette::Disabled;
+    painter->save();
+    painter->setPen(optionV4.palette.color(colorGroup, (optionV4.state & QStyle::State_Selected) ? QPalette::HighlightedText : QPalette::Text));
+    painter->setClipRect(textRect);
+    pLayout->draw(painter, lineRect.topLeft());
+    painter->restore();
+}
+
+QTextLayout* HighlightDelegate::getLayout(const QString& text, const Spans& spans, const QFont& font, int nWidth) const
+{
+    //the text is the key rather than the row: rows are created again on each filter change and refresh
+    QString key = QString("%1|%2|").arg(nWidth).arg(font.key()) + text;
+    QTextLayout* pLayout = m_layouts.object(key);
+    if(pLayout)
+    {
+        return pLayout;
+    }
+
+    QString elided = QFontMetrics(font).elidedText(text, Qt::ElideRight, nWidth);
+    int nVisibleLength = elided == text ? text.length() : elided.length() - 1;
+
+    QList<QTextLayout::FormatRange> formats;
+    for(const QPair<int, int>& span : spans)
+    {
+        //occurrences cut by the ellipsis are highlighted up to it
+        int nLength = qMin(span.second, nVisibleLength - span.first);
+        if(nLength <= 0)
+        {
+            break;
+        }
+
+        QTextLayout::FormatRange range;
+        range.start = span.first;
+        range.length = nLength;
+        range.format.setBackground(QColor(255, 225, 100));
+        range.format.setForeground(Qt::black);
+        formats.append(range);
+    }
+
+    pLayout = new QTextLayout(elided, font);
+    pLayout->setAdditionalFormats(formats);
+    QTextOption textOption;
+    textOption.setWrapMode(QTextOption::NoWrap);
+    pLayout->setTextOption(textOption);
+    pLayout->beginLayout();
+    QTextLine line = pLayout->createLine();
+    line.setLineWidth(nWidth);
+    line.setPosition(QPointF(0, 0));
+    pLayout->endLayout();
+
+    m_layouts.insert(key, pLayout);
+    return pLayout;
+}
@@ -0,0 +1,73 @@
+#ifndef HIGHLIGHTDELEGATE_H
+#define HIGHLIGHTDELEGATE_H
+
+#include <QStyledItemDelegate>
+#include <QAbstractItemView>
+#include <QTextLayout>
+#include <QCache>
+#include <QHash>
+#include <QVector>
+#include <QPair>
+#include <QStringList>
+
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <list>
+
+//paints the items of a view with the occurrences of the filter highlighted. The occurrences are found by a
+//matching thread of the delegate for the texts handed over, items without them yet are painted plainly and
+//repainted once they arrive. Every highlighted line is laid out once per font and width and kept in a least recently used cache.
+class HighlightDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+
+public:
+    //start and length of each occurrence
+    typedef QVector<QPair<int, int> > Spans;
+
+    HighlightDelegate(QAbstractItemView* pView);
+    virtual ~HighlightDelegate();
+
+    //occurrences and laid out lines of the previous filter are dropped
+    void setFilter(const QString& strFilter);
+    void matchTexts(const QStringList& texts);
+
+    virtual void paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const;
+
+    //case insensitive, not overlapping, as the filter of the revisions list
+    static Spans findSpans(const QString& text, const QString& strFilter);
+
+private slots:
+    void on_spans_ready();
+
+private:
+    //texts handed over, matched against the filter of their generation
+    struct Batch
+    {
+        int m_nGeneration;
+        QString m_filter;
+        QStringList m_texts;
+    };
+
+    void matchThread();
+    QTextLayout* getLayout(const QString& text, const Spans& spans, const QFont& font, int nWidth) const;
+
+private:
+    QAbstractItemView* m_pView;
+    QString m_filter;
+    QHash<QString, Spans> m_spans;
+    mutable QCache<QString, QTextLayout> m_layouts;
+
+    //shared with the matching thread; a new filter makes the batches and results of the previous one useless
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::list<Batch> m_batches;
+    std::atomic<int> m_nGeneration;
+    QHash<QString, Spans> m_pendingSpans;
+    bool m_bStopping;
+    std::thread m_matchThread;
+};
+
+#endif // HIGHLIGHTDELEGATE_H
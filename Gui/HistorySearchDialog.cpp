@@ -0,0 +1,146 @@
+#include "HistorySearchDialog.h"
+#include "ui_HistorySearchDialog.h"
+
+#include <QHeaderView>
+#include <QTableWidgetItem>
+#include <QColor>
+
+HistorySearchDialog::HistorySearchDialog(HistorySearchDialogObserver* pObserver, int nFirstRevision, int nLastRevision, QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::HistorySearchDialog),
+    m_pObserver(pObserver),
+    m_nFirstRevision(nFirstRevision),
+    m_nLastRevision(nLastRevision),
+    m_nScannedRevisions(0),
+    m_bRunning(false)
+{
+    ui->setupUi(this);
+
+    ui->labelRange->setText(QString("Revisions %1 to %2 of the log").arg(m_nFirstRevision).arg(m_nLastRevision));
+
+    ui->tableResults->setColumnCount(4);
+    ui->tableResults->setHorizontalHeaderLabels(QStringList() << "Revision" << "" << "Path" << "Line");
+    ui->tableResults->verticalHeader()->setVisible(false);
+    ui->tableResults->horizontalHeader()->setStretchLastSection(true);
+
+    ui->labelStats->setText("");
+    ui->searchButton->setDefault(true);
+}
+
+HistorySearchDialog::~HistorySearchDialog()
+{
+    stopSearch();
+    delete ui;
+}
+
+int HistorySearchDialog::getSearchId() const
+{
+    return m_spSearch ? m_spSearch->getId() : -1;
+}
+
+void HistorySearchDialog::onMatch(int nRevision, const QString& url, bool bAdded, int nLine, const QString& line)
+{
+    //kept in revision order, the oldest first: the first row is where the text appeared
+    int nRow = ui->tableResults->rowCount();
+    while(nRow > 0 && ui->tableResults->item(nRow - 1, 0)->data(Qt::UserRole).toInt() > nRevision)
+    {
+        nRow--;
+    }
+
+    ui->tableResults->insertRow(nRow);
+    QTableWidgetItem* pRevision = new QTableWidgetItem(QString::number(nRevision));
+    pRevision->setData(Qt::UserRole, nRevision);
+    ui->tableResults->setItem(nRow, 0, pRevision);
+    ui->tableResults->setItem(nRow, 1, new QTableWidgetItem(bAdded ? "+" : "-"));
+    QTableWidgetItem* pPath = new QTableWidgetItem(url.section('/', -1));
+    pPath->setToolTip(url);
+    pPath->setData(Qt::UserRole, url);
+    ui->tableResults->setItem(nRow, 2, pPath);
+    ui->tableResults->setItem(nRow, 3, new QTableWidgetItem(QString("%1: %2").arg(nLine).arg(line.trimmed())));
+
+    for(int nColumn = 0; nColumn < 4; nColumn++)
+    {
+        ui->tableResults->item(nRow, nColumn)->setForeground(bAdded ? QColor(0, 110, 0) : QColor(170, 0, 0));
+    }
+
+    if(ui->tableResults->rowCount() == 1)
+    {
+        ui->tableResults->resizeColumnsToContents();
+    }
+    updateStats();
+}
+
+void HistorySearchDialog::onProgress(int nScannedRevisions)
+{
+    m_nScannedRevisions = qMax(m_nScannedRevisions, nScannedRevisions);
+    updateStats();
+}
+
+void HistorySearchDialog::onCompleted()
+{
+    m_bRunning = false;
+    ui->searchButton->setText("Search");
+    updateStats();
+}
+
+void HistorySearchDialog::on_searchButton_clicked()
+{
+    if(m_bRunning)
+    {
+        stopSearch();
+        onCompleted();
+        return;
+    }
+
+    stopSearch();
+    ui->tableResults->setRowCount(0);
+    m_nScannedRevisions = 0;
+
+    m_spSearch = m_pObserver->onStartHistorySearch(ui->patternEdit->text(), ui->regexCheck->isChecked(), ui->stopCheck->isChecked(),
+                                                   m_nFirstRevision, m_nLastRevision);
+    if(!m_spSearch || !m_spSearch->getError().empty())
+    {
+        ui->labelStats->setText(m_spSearch ? QString::fromStdString(m_spSearch->getError()) : QString("No repository is open."));
+        m_spSearch.reset();
+        return;
+    }
+
+    m_bRunning = true;
+    ui->searchButton->setText("Stop");
+    updateStats();
+}
+
+void HistorySearchDialog::on_closeButton_clicked()
+{
+    close();
+}
+
+void HistorySearchDialog::on_tableResults_cellDoubleClicked(int nRow, int /*nColumn*/)
+{
+    m_pObserver->onShowRevisionChanges(ui->tableResults->item(nRow, 2)->data(Qt::UserRole).toString(),
+                                       ui->tableResults->item(nRow, 0)->data(Qt::UserRole).toInt());
+}
+
+void HistorySearchDialog::stopSearch()
+{
+    if(m_spSearch)
+    {
+        m_spSearch->stop();
+    }
+}
+
+void HistorySearchDialog::updateStats()
+{
+    if(!m_spSearch)
+    {
+        return;
+    }
+
+    QString stats = QString("%1 matches, %2 of %3 revisions scanned").arg(ui->tableResults->rowCount())
+            .arg(m_nScannedRevisions).arg(m_spSearch->getRevisionsCount());
+    if(m_bRunning)
+    {
+        stats += "...";
+    }
+    ui->labelStats->setText(stats);
+}
@@ -0,0 +1,57 @@
+#ifndef HISTORYSEARCHDIALOG_H
+#define HISTORYSEARCHDIALOG_H
+
+#include <QDialog>
+
+#include "Repos/SVN/HistorySearch.h"
+
+#include <memory>
+
+namespace Ui {
+class HistorySearchDialog;
+}
+
+class HistorySearchDialogObserver
+{
+public:
+    virtual std::shared_ptr<HistorySearch> onStartHistorySearch(const QString& pattern, bool bRegex, bool bStopAtIntroduction,
+                                                                int nFirstRevision, int nLastRevision) = 0;
+    virtual void onShowRevisionChanges(const QString& url, int nRevision) = 0;
+};
+
+//the revisions of a range that added or removed lines containing a text; matches are listed as they are found
+class HistorySearchDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    HistorySearchDialog(HistorySearchDialogObserver* pObserver, int nFirstRevision, int nLastRevision, QWidget *parent = 0);
+    ~HistorySearchDialog();
+
+    //-1 while no search was started
+    int getSearchId() const;
+
+    void onMatch(int nRevision, const QString& url, bool bAdded, int nLine, const QString& line);
+    void onProgress(int nScannedRevisions);
+    void onCompleted();
+
+private slots:
+    void on_searchButton_clicked();
+    void on_closeButton_clicked();
+    void on_tableResults_cellDoubleClicked(int nRow, int nColumn);
+
+private:
+    void stopSearch();
+    void updateStats();
+
+private:
+    Ui::HistorySearchDialog *ui;
+    HistorySearchDialogObserver* m_pObserver;
+    int m_nFirstRevision;
+    int m_nLastRevision;
+    std::shared_ptr<HistorySearch> m_spSearch;
+    int m_nScannedRevisions;
+    bool m_bRunning;
+};
+
+#endif // HISTORYSEARCHDIALOG_H
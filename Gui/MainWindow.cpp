@@ -3,66 +3,307 @@
 
 #include "Settings/AppSettings.h"
 #include "Gui/AboutDialog.h"
+#include "Gui/DiffViewDialog.h"
+#include "Gui/BlameDialog.h"
+#include "Gui/ReviewDialog.h"
+#include "Gui/HighlightDelegate.h"
+#include "Repos/SVN/FileRevisionCache.h"
 
 #include <QTreeWidgetItemIterator>
+#include <QSet>
 
-#include <QStyledItemDelegate>
-#include <QTextDocument>
-#include <QAbstractTextDocumentLayout>
-#include <QPainter>
+#include <QScrollBar>
 
 #include <qtimer.h>
 
-class HtmlDelegate : public QStyledItemDelegate
+static const QEvent::Type REVISIONS_UPDATED = (QEvent::Type)QEvent::registerEventType();
+static const QEvent::Type LOCAL_CHANGES_UPDATED = (QEvent::Type)QEvent::registerEventType();
+static const QEvent::Type AFFECTED_ITEMS_UPDATED = (QEvent::Type)QEvent::registerEventType();
+static const QEvent::Type REPO_CONTENT_UPDATED = (QEvent::Type)QEvent::registerEventType();
+static const QEvent::Type LOCAL_CHANGES_DELTA = (QEvent::Type)QEvent::registerEventType();
+static const QEvent::Type COMMAND_COMPLETED = (QEvent::Type)QEvent::registerEventType();
+static const QEvent::Type UPDATE_PROGRESS = (QEvent::Type)QEvent::registerEventType();
+static const QEvent::Type REVISIONS_PREPENDED = (QEvent::Type)QEvent::registerEventType();
+static const QEvent::Type AFFECTED_ITEMS_LOADED = (QEvent::Type)QEvent::registerEventType();
+static const QEvent::Type REPO_NODE_LISTED = (QEvent::Type)QEvent::registerEventType();
+static const QEvent::Type FILE_DIFF_LOADED = (QEvent::Type)QEvent::registerEventType();
+static const QEvent::Type BLAME_LOADED = (QEvent::Type)QEvent::registerEventType();
+static const QEvent::Type REVIEW_PROGRESS = (QEvent::Type)QEvent::registerEventType();
+static const QEvent::Type REVISION_STATS_LOADED = (QEvent::Type)QEvent::registerEventType();
+static const QEvent::Type HISTORY_SEARCH_PROGRESS = (QEvent::Type)QEvent::registerEventType();
+
+//columns of the revisions table
+static const int REVISION_COLUMN = 0;
+static const int FILES_COLUMN = 3;
+static const int ADDED_LINES_COLUMN = 4;
+static const int REMOVED_LINES_COLUMN = 5;
+static const int REVISION_COLUMNS_COUNT = 7;
+
+//the prefetch window follows the selection and the scrolling once they settle
+static const int PREFETCH_DELAY_MS = 150;
+//the memory usage in the status bar is refreshed on its own, not by every view update
+static const int MEMORY_USAGE_REFRESH_MS = 1000;
+
+class LocalChangesDeltaEvent : public MergeableEvent
 {
-protected:
-    void paint ( QPainter * painter, const QStyleOptionViewItem & option, const QModelIndex & index ) const;
-    QSize sizeHint ( const QStyleOptionViewItem & option, const QModelIndex & index ) const;
+public:
+    LocalChangesDeltaEvent(const LocalChangesDelta& delta)
+        : MergeableEvent(LOCAL_CHANGES_DELTA)
+        , m_delta(delta)
+    {
+    }
+
+    //the view reads the current state of every entry it is pointed to, so the entries can simply be joined
+    virtual bool mergeWith(const MergeableEvent& later)
+    {
+        const LocalChangesDelta& delta = static_cast<const LocalChangesDeltaEvent&>(later).m_delta;
+        m_delta.m_bFullStatus |= delta.m_bFullStatus;
+        m_delta.m_added.insert(m_delta.m_added.end(), delta.m_added.begin(), delta.m_added.end());
+        m_delta.m_removed.insert(m_delta.m_removed.end(), delta.m_removed.begin(), delta.m_removed.end());
+        m_delta.m_changed.insert(m_delta.m_changed.end(), delta.m_changed.begin(), delta.m_changed.end());
+        return true;
+    }
+
+    LocalChangesDelta m_delta;
 };
 
-void HtmlDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+class CommandCompletedEvent : public MergeableEvent
 {
-    QStyleOptionViewItemV4 optionV4 = option;
-    initStyleOption(&optionV4, index);
+public:
+    CommandCompletedEvent(RefreshScheduler::Kind kind, bool bSuccess)
+        : MergeableEvent(COMMAND_COMPLETED)
+        , m_kind(kind)
+        , m_bSuccess(bSuccess)
+    {
+    }
 
-    QStyle *style = optionV4.widget? optionV4.widget->style() : QApplication::style();
+    //repeated successes say nothing new; every failure counts for the backoff
+    virtual bool mergeWith(const MergeableEvent& later)
+    {
+        const CommandCompletedEvent& event = static_cast<const CommandCompletedEvent&>(later);
+        return m_kind == event.m_kind && m_bSuccess && event.m_bSuccess;
+    }
 
-    QTextDocument doc;
-    doc.setHtml(optionV4.text);
+    RefreshScheduler::Kind m_kind;
+    bool m_bSuccess;
+};
 
-    /// Painting item without text
-    optionV4.text = QString();
-    style->drawControl(QStyle::CE_ItemViewItem, &optionV4, painter);
+class UpdateProgressEvent : public MergeableEvent
+{
+public:
+    UpdateProgressEvent(const QString& message)
+        : MergeableEvent(UPDATE_PROGRESS)
+        , m_message(message)
+    {
+    }
 
-    QAbstractTextDocumentLayout::PaintContext ctx;
+    //only the latest progress is worth showing
+    virtual bool mergeWith(const MergeableEvent& later)
+    {
+        m_message = static_cast<const UpdateProgressEvent&>(later).m_message;
+        return true;
+    }
 
-    // Highlighting text if item is selected
-    if (optionV4.state & QStyle::State_Selected)
-        ctx.palette.setColor(QPalette::Text, optionV4.palette.color(QPalette::Active, QPalette::HighlightedText));
+    QString m_message;
+};
 
-    QRect textRect = style->subElementRect(QStyle::SE_ItemViewItemText, &optionV4);
-    painter->save();
-    painter->translate(textRect.topLeft());
-    painter->setClipRect(textRect.translated(-textRect.topLeft()));
-    doc.documentLayout()->draw(painter, ctx);
-    painter->restore();
-}
+class AffectedItemsLoadedEvent : public MergeableEvent
+{
+public:
+    AffectedItemsLoadedEvent(int nRevision)
+        : MergeableEvent(AFFECTED_ITEMS_LOADED)
+        , m_nRevision(nRevision)
+    {
+    }
+
+    virtual bool mergeWith(const MergeableEvent& later)
+    {
+        return m_nRevision == static_cast<const AffectedItemsLoadedEvent&>(later).m_nRevision;
+    }
+
+    int m_nRevision;
+};
 
-QSize HtmlDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const
+class RevisionStatsLoadedEvent : public MergeableEvent
 {
-    QStyleOptionViewItemV4 optionV4 = option;
-    initStyleOption(&optionV4, index);
+public:
+    RevisionStatsLoadedEvent(int nRevision)
+        : MergeableEvent(REVISION_STATS_LOADED)
+    {
+        m_revisions.insert(nRevision);
+    }
 
-    QTextDocument doc;
-    doc.setHtml(optionV4.text);
-    doc.setTextWidth(optionV4.rect.width());
-    return QSize(doc.idealWidth(), doc.size().height());
-}
+    virtual bool mergeWith(const MergeableEvent& later)
+    {
+        m_revisions += static_cast<const RevisionStatsLoadedEvent&>(later).m_revisions;
+        return true;
+    }
 
-static const QEvent::Type REVISIONS_UPDATED = (QEvent::Type)QEvent::registerEventType();
-static const QEvent::Type LOCAL_CHANGES_UPDATED = (QEvent::Type)QEvent::registerEventType();
-static const QEvent::Type AFFECTED_ITEMS_UPDATED = (QEvent::Type)QEvent::registerEventType();
-static const QEvent::Type REPO_CONTENT_UPDATED = (QEvent::Type)QEvent::registerEventType();
+    QSet<int> m_revisions;
+};
+
+class HistorySearchProgressEvent : public MergeableEvent
+{
+public:
+    struct Match
+    {
+        int m_nRevision;
+        QString m_url;
+        bool m_bAdded;
+        int m_nLine;
+        QString m_line;
+    };
+
+    HistorySearchProgressEvent(int nSearchId)
+        : MergeableEvent(HISTORY_SEARCH_PROGRESS)
+        , m_nSearchId(nSearchId)
+        , m_nScannedRevisions(0)
+        , m_bCompleted(false)
+    {
+    }
+
+    virtual bool mergeWith(const MergeableEvent& later)
+    {
+        const HistorySearchProgressEvent& event = static_cast<const HistorySearchProgressEvent&>(later);
+        if(m_nSearchId != event.m_nSearchId)
+        {
+            return false;
+        }
+
+        m_matches += event.m_matches;
+        m_nScannedRevisions = qMax(m_nScannedRevisions, event.m_nScannedRevisions);
+        m_bCompleted |= event.m_bCompleted;
+        return true;
+    }
+
+    int m_nSearchId;
+    QList<Match> m_matches;
+    int m_nScannedRevisions;
+    bool m_bCompleted;
+};
+
+class RepoNodeListedEvent : public MergeableEvent
+{
+public:
+    RepoNodeListedEvent(const QString& nodePath)
+        : MergeableEvent(REPO_NODE_LISTED)
+        , m_nodePath(nodePath)
+    {
+    }
+
+    virtual bool mergeWith(const MergeableEvent& later)
+    {
+        return m_nodePath == static_cast<const RepoNodeListedEvent&>(later).m_nodePath;
+    }
+
+    QString m_nodePath;
+};
+
+class FileDiffLoadedEvent : public MergeableEvent
+{
+public:
+    FileDiffLoadedEvent(const QString& path, int nRevision, std::shared_ptr<const TextDiff> spDiff)
+        : MergeableEvent(FILE_DIFF_LOADED)
+        , m_path(path)
+        , m_nRevision(nRevision)
+        , m_spDiff(spDiff)
+    {
+    }
+
+    //the same file loaded again replaces the pending result
+    virtual bool mergeWith(const MergeableEvent& later)
+    {
+        const FileDiffLoadedEvent& event = static_cast<const FileDiffLoadedEvent&>(later);
+        if(m_path != event.m_path || m_nRevision != event.m_nRevision)
+        {
+            return false;
+        }
+
+        m_spDiff = event.m_spDiff;
+        return true;
+    }
+
+    QString m_path;
+    int m_nRevision;
+    std::shared_ptr<const TextDiff> m_spDiff;
+};
+
+class BlameLoadedEvent : public MergeableEvent
+{
+public:
+    BlameLoadedEvent(const QString& path, int nRevision, int nFirstLine, const BlameLine::Collection& lines)
+        : MergeableEvent(BLAME_LOADED)
+        , m_path(path)
+        , m_nRevision(nRevision)
+        , m_nFirstLine(nFirstLine)
+        , m_lines(lines)
+        , m_bCompleted(false)
+        , m_bSuccess(false)
+    {
+    }
+
+    //lines continuing the pending ones are appended, the completion of the same blame is taken over
+    virtual bool mergeWith(const MergeableEvent& later)
+    {
+        const BlameLoadedEvent& event = static_cast<const BlameLoadedEvent&>(later);
+        if(m_path != event.m_path || m_nRevision != event.m_nRevision || m_bCompleted)
+        {
+            return false;
+        }
+
+        if(!event.m_lines.empty())
+        {
+            if(event.m_nFirstLine != m_nFirstLine + static_cast<int>(m_lines.size()))
+            {
+                return false;
+            }
+            m_lines.insert(m_lines.end(), event.m_lines.begin(), event.m_lines.end());
+        }
+
+        m_bCompleted = event.m_bCompleted;
+        m_bSuccess = event.m_bSuccess;
+        return true;
+    }
+
+    QString m_path;
+    int m_nRevision;
+    int m_nFirstLine;
+    BlameLine::Collection m_lines;
+    bool m_bCompleted;
+    bool m_bSuccess;
+};
+
+class ReviewProgressEvent : public MergeableEvent
+{
+public:
+    ReviewProgressEvent(int nReviewId, int nStagedFile)
+        : MergeableEvent(REVIEW_PROGRESS)
+        , m_nReviewId(nReviewId)
+        , m_bCompleted(nStagedFile == -1)
+    {
+        if(nStagedFile != -1)
+        {
+            m_stagedFiles.push_back(nStagedFile);
+        }
+    }
+
+    virtual bool mergeWith(const MergeableEvent& later)
+    {
+        const ReviewProgressEvent& event = static_cast<const ReviewProgressEvent&>(later);
+        if(m_nReviewId != event.m_nReviewId)
+        {
+            return false;
+        }
+
+        m_stagedFiles.insert(m_stagedFiles.end(), event.m_stagedFiles.begin(), event.m_stagedFiles.end());
+        m_bCompleted |= event.m_bCompleted;
+        return true;
+    }
+
+    int m_nReviewId;
+    std::vector<int> m_stagedFiles;
+    bool m_bCompleted;
+};
 
 
 class RefreshGuiEventFilter : public QObject
@@ -89,23 +330,94 @@ protected:
                 return true;
             }
 
+            if(event->type() == REVISIONS_PREPENDED)
+            {
+                m_pMainWindow->displayPrependedRevisions();
+                return true;
+            }
+
             if(event->type() == LOCAL_CHANGES_UPDATED)
             {
                 m_pMainWindow->displayLocalChanges();
                 return true;
             }
 
+            if(event->type() == LOCAL_CHANGES_DELTA)
+            {
+                m_pMainWindow->displayLocalChanges(static_cast<LocalChangesDeltaEvent*>(event)->m_delta);
+                return true;
+            }
+
             if(event->type() == AFFECTED_ITEMS_UPDATED)
             {
                 m_pMainWindow->displayAffectedItems();
                 return true;
             }
 
+            if(event->type() == AFFECTED_ITEMS_LOADED)
+            {
+                m_pMainWindow->displayAffectedItems(static_cast<AffectedItemsLoadedEvent*>(event)->m_nRevision);
+                return true;
+            }
+
+            if(event->type() == REVISION_STATS_LOADED)
+            {
+                m_pMainWindow->displayRevisionStats(static_cast<RevisionStatsLoadedEvent*>(event)->m_revisions);
+                return true;
+            }
+
+            if(event->type() == REPO_NODE_LISTED)
+            {
+                m_pMainWindow->displayRepoNode(static_cast<RepoNodeListedEvent*>(event)->m_nodePath);
+                return true;
+            }
+
+            if(event->type() == FILE_DIFF_LOADED)
+            {
+                FileDiffLoadedEvent* pEvent = static_cast<FileDiffLoadedEvent*>(event);
+                m_pMainWindow->displayFileDiff(pEvent->m_path, pEvent->m_nRevision, pEvent->m_spDiff);
+                return true;
+            }
+
+            if(event->type() == BLAME_LOADED)
+            {
+                BlameLoadedEvent* pEvent = static_cast<BlameLoadedEvent*>(event);
+                m_pMainWindow->displayBlame(pEvent->m_path, pEvent->m_nRevision, pEvent->m_nFirstLine, pEvent->m_lines,
+                                            pEvent->m_bCompleted, pEvent->m_bSuccess);
+                return true;
+            }
+
+            if(event->type() == REVIEW_PROGRESS)
+            {
+                ReviewProgressEvent* pEvent = static_cast<ReviewProgressEvent*>(event);
+                m_pMainWindow->displayReviewProgress(pEvent->m_nReviewId, pEvent->m_stagedFiles, pEvent->m_bCompleted);
+                return true;
+            }
+
+            if(event->type() == HISTORY_SEARCH_PROGRESS)
+            {
+                m_pMainWindow->displayHistorySearchProgress(*static_cast<HistorySearchProgressEvent*>(event));
+                return true;
+            }
+
             if(event->type() == REPO_CONTENT_UPDATED)
             {
                 m_pMainWindow->displayRepoContent();
                 return true;
             }
+
+            if(event->type() == UPDATE_PROGRESS)
+            {
+                m_pMainWindow->ui->statusBar->showMessage(static_cast<UpdateProgressEvent*>(event)->m_message);
+                return true;
+            }
+
+            if(event->type() == COMMAND_COMPLETED)
+            {
+                CommandCompletedEvent* pEvent = static_cast<CommandCompletedEvent*>(event);
+                m_pMainWindow->m_pRefreshScheduler->onRefreshCompleted(pEvent->m_kind, pEvent->m_bSuccess);
+                return true;
+            }
         }
 
         return false;
@@ -123,22 +435,35 @@ MainWindow::MainWindow(QApplication &app, QWidget *parent) :
 {
     ui->setupUi(this);
 
+    //SvnViewer notifications arrive on worker threads and are delivered merged, once per frame
+    m_pUpdateQueue = new GuiUpdateQueue(this);
+
+    m_pMemoryLabel = new QLabel(this);
+    ui->statusBar->addPermanentWidget(m_pMemoryLabel);
+
     modelRevisions = new QStandardItemModel(this);
 
     QStringList lineItems;
-    lineItems << "Revision" << "Date" << "Author" << "Description";
+    lineItems << "Revision" << "Date" << "Author" << "Files" << "Added" << "Removed" << "Description";
 
-    modelRevisions->setColumnCount(4);
+    modelRevisions->setColumnCount(REVISION_COLUMNS_COUNT);
     modelRevisions->setHorizontalHeaderLabels(lineItems);
+    //every cell holds its value for sorting, numbers stay numbers
+    modelRevisions->setSortRole(Qt::UserRole);
 
 
     ui->revisionsTable->setModel(modelRevisions);
     ui->revisionsTable->setSelectionBehavior(QAbstractItemView::SelectRows);
-    ui->revisionsTable->setSelectionMode(QAbstractItemView::SingleSelection);
+    //several revisions are reviewed together
+    ui->revisionsTable->setSelectionMode(QAbstractItemView::ExtendedSelection);
     ui->revisionsTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
     ui->revisionsTable->horizontalHeader()->setStretchLastSection(true);
     ui->revisionsTable->setShowGrid(false);
     ui->revisionsTable->verticalHeader()->setVisible(false);
+    ui->revisionsTable->setSortingEnabled(true);
+    ui->revisionsTable->sortByColumn(REVISION_COLUMN, Qt::DescendingOrder);
+    m_pRevisionsDelegate = new HighlightDelegate(ui->revisionsTable);
+    ui->revisionsTable->setItemDelegate(m_pRevisionsDelegate);
 
     modelAffectedItems = new QStandardItemModel(this);
 
@@ -156,6 +481,8 @@ MainWindow::MainWindow(QApplication &app, QWidget *parent) :
     ui->revisionDetails->horizontalHeader()->setStretchLastSection(true);
     ui->revisionDetails->setShowGrid(false);
     ui->revisionDetails->verticalHeader()->setVisible(false);
+    m_pAffectedItemsDelegate = new HighlightDelegate(ui->revisionDetails);
+    ui->revisionDetails->setItemDelegate(m_pAffectedItemsDelegate);
 
     RefreshGuiEventFilter* pWatcher = new RefreshGuiEventFilter(this);
     this->installEventFilter(pWatcher);
@@ -172,16 +499,29 @@ MainWindow::MainWindow(QApplication &app, QWidget *parent) :
             SLOT(on_revisionsTable_selection_changed(QItemSelection,QItemSelection)));
 
     m_bInitalUpdatePerfromed = false;
+    m_nNewestDisplayedRevision = -1;
+    m_nTreeItems = 0;
 
     SvnViewer::instance()->setObserver(this);
 
-    //set auto refresh interval at 2 min
-    QTimer* timer = new QTimer(this);
-    timer->setInterval(120000);
-    connect(timer, SIGNAL(timeout()), SLOT(on_actionRefresh_triggered()));
-    timer->start();
-
-    //ui->revisionsTable->setItemDelegate(new HtmlDelegate());
+    //log, status and tree are refreshed on their own schedules
+    m_pScheduleLabel = new QLabel(this);
+    ui->statusBar->addPermanentWidget(m_pScheduleLabel);
+    m_pRefreshScheduler = new RefreshScheduler(this);
+    connect(m_pRefreshScheduler, SIGNAL(refreshRequested(int)), SLOT(on_refresh_requested(int)));
+    connect(m_pRefreshScheduler, SIGNAL(scheduleChanged()), SLOT(on_schedule_changed()));
+    connect(m_pRefreshScheduler, SIGNAL(backgroundWorkPaused(bool)), SLOT(on_background_work_paused(bool)));
+    m_pRefreshScheduler->start();
+
+    m_nPrefetchRevisions = AppSettings::instance()->getIntValue("prefetchRevisions", 5);
+    m_pPrefetchTimer = new QTimer(this);
+    m_pPrefetchTimer->setSingleShot(true);
+    connect(m_pPrefetchTimer, SIGNAL(timeout()), SLOT(on_prefetch_timeout()));
+    connect(ui->revisionsTable->verticalScrollBar(), SIGNAL(valueChanged(int)), SLOT(on_revisions_scrolled()));
+
+    m_pMemoryTimer = new QTimer(this);
+    connect(m_pMemoryTimer, SIGNAL(timeout()), SLOT(on_memory_timer_timeout()));
+    m_pMemoryTimer->start(MEMORY_USAGE_REFRESH_MS);
 }
 
 MainWindow::~MainWindow()
@@ -196,6 +536,7 @@ void MainWindow::on_actionOpen_triggered()
     if(nResult == QDialog::Accepted)
     {
         ui->treeWidgetRepo->clear();
+        m_nTreeItems = 0;
         if(modelAffectedItems->rowCount())
         {
             modelAffectedItems->removeRows(0, modelAffectedItems->rowCount());
@@ -205,6 +546,7 @@ void MainWindow::on_actionOpen_triggered()
         {
             modelRevisions->removeRows(0, modelRevisions->rowCount());
         }
+        m_nNewestDisplayedRevision = -1;
 
         m_currentRepoPath = dlg.getSelectedPath().c_str();
         SvnViewer::instance()->init(dlg.getSelectedPath());
@@ -220,6 +562,119 @@ void MainWindow::on_actionRefresh_triggered()
     }
 }
 
+void MainWindow::on_refresh_requested(int nKind)
+{
+    if(!SvnViewer::instance()->isInitialized())
+    {
+        return;
+    }
+
+    switch(nKind)
+    {
+    case RefreshScheduler::RemoteLog:
+        m_currentRepoPath = SvnViewer::instance()->getRepoPath().c_str();
+        SvnViewer::instance()->refreshRevisions();
+        break;
+
+    case RefreshScheduler::LocalStatus:
+        //the working copy watcher already keeps the status current
+        if(!SvnViewer::instance()->isWatchingWorkingCopy())
+        {
+            SvnViewer::instance()->checkForModifications();
+        }
+        break;
+
+    case RefreshScheduler::TreeListing:
+        SvnViewer::instance()->refreshRepoContent();
+        break;
+    }
+}
+
+void MainWindow::on_schedule_changed()
+{
+    m_pScheduleLabel->setText(m_pRefreshScheduler->describeSchedule());
+}
+
+void MainWindow::on_background_work_paused(bool bPaused)
+{
+    SvnViewer::instance()->setBackgroundWorkPaused(bPaused);
+}
+
+void MainWindow::on_revisions_scrolled()
+{
+    m_pPrefetchTimer->start(PREFETCH_DELAY_MS);
+}
+
+void MainWindow::on_prefetch_timeout()
+{
+    updatePrefetchWindow();
+}
+
+void MainWindow::on_memory_timer_timeout()
+{
+    displayMemoryUsage();
+}
+
+void MainWindow::updatePrefetchWindow()
+{
+    if(m_nPrefetchRevisions <= 0 || !SvnViewer::instance()->isInitialized())
+    {
+        return;
+    }
+
+    //nearest to the selection first, the next row down before the one up: that is where stepping usually goes.
+    //Rows hidden by the filter are stepped over
+    QList<int> rows;
+    int nSelectedRow = ui->revisionsTable->currentIndex().row();
+    int nBelow = nSelectedRow;
+    int nAbove = nSelectedRow;
+    for(int nDistance = 1; nSelectedRow != -1 && nDistance <= m_nPrefetchRevisions; nDistance++)
+    {
+        do
+        {
+            nBelow++;
+        }
+        while(nBelow < modelRevisions->rowCount() && ui->revisionsTable->isRowHidden(nBelow));
+        do
+        {
+            nAbove--;
+        }
+        while(nAbove >= 0 && ui->revisionsTable->isRowHidden(nAbove));
+        rows << nBelow << nAbove;
+    }
+
+    int nFirstVisible = ui->revisionsTable->rowAt(0);
+    int nLastVisible = ui->revisionsTable->rowAt(ui->revisionsTable->viewport()->height() - 1);
+    if(nLastVisible == -1)
+    {
+        nLastVisible = modelRevisions->rowCount() - 1;
+    }
+    for(int nRow = nFirstVisible; nRow != -1 && nRow <= nLastVisible; nRow++)
+    {
+        if(!ui->revisionsTable->isRowHidden(nRow))
+        {
+            rows << nRow;
+        }
+    }
+
+    std::vector<int> revisions;
+    QSet<int> added;
+    for(int nRow : rows)
+    {
+        if(nRow >= 0 && nRow < modelRevisions->rowCount())
+        {
+            int nRevision = modelRevisions->item(nRow, REVISION_COLUMN)->text().toInt();
+            if(!added.contains(nRevision))
+            {
+                added.insert(nRevision);
+                revisions.push_back(nRevision);
+            }
+        }
+    }
+
+    SvnViewer::instance()->prefetchChangeSets(revisions);
+}
+
 void MainWindow::on_revisionsTable_clicked(const QModelIndex& /*index*/)
 {
     displayAffectedItems();
@@ -251,20 +706,61 @@ void MainWindow::on_revisionDetails_doubleClicked(const QModelIndex &index)
         return;
     }
 
+    QString strPath = getAffectedItemPath(index);
+    if(!strPath.isEmpty())
+    {
+        showFileDiff(strPath, nRevision);
+    }
+}
+
+QString MainWindow::getAffectedItemPath(const QModelIndex& index) const
+{
     QStandardItem* pSelectedItem = modelAffectedItems->itemFromIndex(index);
-    if(pSelectedItem)
+    if(!pSelectedItem)
     {
-        //remove status (M, A, ...)
-        QString strPath = pSelectedItem->text().mid(1);
+        return QString();
+    }
 
-        //trim spaces
-        while(strPath[0] == ' ')
-        {
-            strPath = strPath.mid(1);
-        }
+    //remove status (M, A, ...)
+    QString strPath = pSelectedItem->text().mid(1);
+
+    //trim spaces
+    while(strPath[0] == ' ')
+    {
+        strPath = strPath.mid(1);
+    }
+
+    return strPath;
+}
 
-        SvnViewer::instance()->launchDiffViewer(strPath.toStdString(), nRevision);
+void MainWindow::on_revisionDetails_customContextMenuRequested(const QPoint &pos)
+{
+    if(getSelectedRevision() == -1 || getAffectedItemPath(ui->revisionDetails->indexAt(pos)).isEmpty())
+    {
+        return;
     }
+
+    QMenu* contextMenu = new QMenu(ui->revisionDetails);
+    contextMenu->addAction("Show changes", this, SLOT(on_show_changes_of_affected_item()));
+    contextMenu->addAction("Blame", this, SLOT(on_blame_affected_item()));
+    contextMenu->popup(ui->revisionDetails->viewport()->mapToGlobal(pos));
+}
+
+void MainWindow::on_show_changes_of_affected_item()
+{
+    on_revisionDetails_doubleClicked(ui->revisionDetails->currentIndex());
+}
+
+void MainWindow::on_blame_affected_item()
+{
+    int nRevision = getSelectedRevision();
+    QString strPath = getAffectedItemPath(ui->revisionDetails->currentIndex());
+    if(nRevision == -1 || strPath.isEmpty())
+    {
+        return;
+    }
+
+    showBlame(strPath, nRevision);
 }
 
 void MainWindow::on_actionUpdate_to_head_triggered()
@@ -272,6 +768,7 @@ void MainWindow::on_actionUpdate_to_head_triggered()
     if(!SvnViewer::instance()->isInitialized())
         return;
 
+    ui->statusBar->showMessage("Updating...");
     SvnViewer::instance()->updateToHead();
 }
 
@@ -306,14 +803,23 @@ void MainWindow::on_actionCommit_triggered()
 
 void MainWindow::on_revisionsTable_customContextMenuRequested(const QPoint &pos)
 {
-    int nRevision = getSelectedRevision();
-    if(nRevision == -1)
+    std::set<int> revisions = getSelectedRevisions();
+    if(revisions.empty())
     {
         return;
     }
 
     QMenu* contextMenu = new QMenu(ui->revisionsTable);
-    contextMenu->addAction("Update to this revision", this, SLOT(on_update_to_revision()));
+    if(revisions.size() == 1)
+    {
+        contextMenu->addAction("Update to this revision", this, SLOT(on_update_to_revision()));
+        contextMenu->addAction("Review revision", this, SLOT(on_review_revision()));
+    }
+    else
+    {
+        contextMenu->addAction(QString("Review %1 revisions together").arg(revisions.size()), this, SLOT(on_review_revision()));
+    }
+    contextMenu->addAction("Search history...", this, SLOT(on_search_history()));
     contextMenu->popup(ui->revisionsTable->viewport()->mapToGlobal(pos));
 }
 
@@ -326,9 +832,167 @@ void MainWindow::on_update_to_revision()
         return;
     }
 
+    ui->statusBar->showMessage("Updating...");
     SvnViewer::instance()->updateToRevision(nRevision);
 }
 
+void MainWindow::on_review_revision()
+{
+    std::set<int> revisions = getSelectedRevisions();
+    if(revisions.empty())
+    {
+        return;
+    }
+
+    for(QList<QPointer<ReviewDialog> >::iterator it = m_reviewViews.begin(); it != m_reviewViews.end(); ++it)
+    {
+        if(!it->isNull() && (*it)->getSession()->getRevisions() == revisions)
+        {
+            (*it)->raise();
+            (*it)->activateWindow();
+            return;
+        }
+    }
+
+    QString description = ReviewDialog::describeRevisions(revisions);
+    std::shared_ptr<ReviewSession> spSession = SvnViewer::instance()->startReview(revisions);
+    if(!spSession)
+    {
+        ui->statusBar->showMessage(QString("The changed paths of %1 are still loading.").arg(description));
+        return;
+    }
+
+    //meld gets both trees once every file is staged
+    if(AppSettings::instance()->getStringValue("diffViewer", "internal") == "meld")
+    {
+        m_meldReviews[spSession->getId()] = spSession;
+        ui->statusBar->showMessage(QString("Fetching the files of %1...").arg(description));
+        return;
+    }
+
+    RevisionInfo changeset;
+    QString title = QString("Revision %1").arg(spSession->getLastRevision());
+    if(revisions.size() > 1)
+    {
+        //a feature landed in several commits: the files go from before the first to after the last
+        title = QString("Combined changes of %1").arg(description);
+    }
+    else
+    if(SvnViewer::instance()->getChangeSet(spSession->getLastRevision(), changeset))
+    {
+        title += QString(" by %1: %2").arg(changeset.m_Author.c_str()).arg(QString(changeset.m_Description.c_str()).section('\n', 0, 0));
+    }
+
+    ReviewDialog* pDialog = new ReviewDialog(spSession, title, this);
+    pDialog->setAttribute(Qt::WA_DeleteOnClose);
+    pDialog->show();
+    m_reviewViews.append(pDialog);
+}
+
+void MainWindow::on_search_history()
+{
+    //the range of several selected revisions, otherwise every revision of the log
+    std::set<int> revisions = getSelectedRevisions();
+    int nFirstRevision = SvnViewer::instance()->getOldestRevision();
+    int nLastRevision = m_nNewestDisplayedRevision;
+    if(revisions.size() > 1)
+    {
+        nFirstRevision = *revisions.begin();
+        nLastRevision = *revisions.rbegin();
+    }
+
+    HistorySearchDialog* pDialog = new HistorySearchDialog(this, nFirstRevision, nLastRevision, this);
+    pDialog->setAttribute(Qt::WA_DeleteOnClose);
+    pDialog->show();
+    m_historySearchViews.append(pDialog);
+}
+
+std::shared_ptr<HistorySearch> MainWindow::onStartHistorySearch(const QString& pattern, bool bRegex, bool bStopAtIntroduction,
+                                                               int nFirstRevision, int nLastRevision)
+{
+    if(!SvnViewer::instance()->isInitialized())
+    {
+        return std::shared_ptr<HistorySearch>();
+    }
+
+    return SvnViewer::instance()->startHistorySearch(pattern.toStdString(), bRegex, bStopAtIntroduction, nFirstRevision, nLastRevision);
+}
+
+void MainWindow::onShowRevisionChanges(const QString& url, int nRevision)
+{
+    showFileDiff(url, nRevision);
+}
+
+void MainWindow::displayHistorySearchProgress(const HistorySearchProgressEvent& event)
+{
+    for(QList<QPointer<HistorySearchDialog> >::iterator it = m_historySearchViews.begin(); it != m_historySearchViews.end();)
+    {
+        if(it->isNull())
+        {
+            it = m_historySearchViews.erase(it);
+            continue;
+        }
+
+        if((*it)->getSearchId() == event.m_nSearchId)
+        {
+            for(const HistorySearchProgressEvent::Match& match : event.m_matches)
+            {
+                (*it)->onMatch(match.m_nRevision, match.m_url, match.m_bAdded, match.m_nLine, match.m_line);
+            }
+
+            (*it)->onProgress(event.m_nScannedRevisions);
+            if(event.m_bCompleted)
+            {
+                (*it)->onCompleted();
+            }
+        }
+        ++it;
+    }
+}
+
+void MainWindow::displayReviewProgress(int nReviewId, const std::vector<int>& stagedFiles, bool bCompleted)
+{
+    for(QList<QPointer<ReviewDialog> >::iterator it = m_reviewViews.begin(); it != m_reviewViews.end();)
+    {
+        if(it->isNull())
+        {
+            it = m_reviewViews.erase(it);
+            continue;
+        }
+
+        if((*it)->getSession()->getId() == nReviewId)
+        {
+            for(int nIndex : stagedFiles)
+            {
+                (*it)->onFileStaged(nIndex);
+            }
+
+            if(bCompleted)
+            {
+                (*it)->onCompleted();
+            }
+        }
+        ++it;
+    }
+
+    QMap<int, std::shared_ptr<ReviewSession> >::iterator meldReview = m_meldReviews.find(nReviewId);
+    if(meldReview != m_meldReviews.end())
+    {
+        QString description = ReviewDialog::describeRevisions((*meldReview)->getRevisions());
+        if(bCompleted)
+        {
+            ui->statusBar->showMessage(QString("%1 ready for review.").arg(description));
+            SvnViewer::instance()->launchDirectoryDiffViewer((*meldReview)->getBeforePath(), (*meldReview)->getAfterPath());
+            m_meldReviews.erase(meldReview);
+        }
+        else
+        {
+            ui->statusBar->showMessage(QString("Fetched %1 of %2 files of %3...")
+                                       .arg((*meldReview)->getStagedFilesCount()).arg((*meldReview)->getFilesCount()).arg(description));
+        }
+    }
+}
+
 void MainWindow::onLaunchDiff(const QString& strItem)
 {
     if(!SvnViewer::instance()->isInitialized())
@@ -336,7 +1000,7 @@ void MainWindow::onLaunchDiff(const QString& strItem)
         return;
     }
 
-    SvnViewer::instance()->launchDiffViewer(strItem.toStdString(), -1);
+    showFileDiff(strItem, -1);
 }
 
 void MainWindow::onRevertModifiedItem(const QString& strItem)
@@ -361,6 +1025,8 @@ void MainWindow::on_revisionsTable_selection_changed(const QItemSelection& selec
     {
         on_revisionsTable_clicked(selected.indexes().first());
     }
+
+    m_pPrefetchTimer->start(PREFETCH_DELAY_MS);
 }
 
 void MainWindow::on_actionAbout_triggered()
@@ -399,7 +1065,7 @@ void MainWindow::on_treeWidgetRepo_itemDoubleClicked(QTreeWidgetItem *item, int
 
         if(itChanges != localChanges.end())
         {
-            SvnViewer::instance()->launchDiffViewer(pathToRoot.toStdString(), -1);
+            showFileDiff(pathToRoot, -1);
         }
         else
         {
@@ -409,18 +1075,42 @@ void MainWindow::on_treeWidgetRepo_itemDoubleClicked(QTreeWidgetItem *item, int
     }
 }
 
-void MainWindow::on_revisionsFilterEdit_textChanged(const QString& /*arg1*/)
+void MainWindow::on_revisionsFilterEdit_textChanged(const QString& arg1)
 {
+    m_pRevisionsDelegate->setFilter(arg1);
+    m_pAffectedItemsDelegate->setFilter(arg1);
     displayRevisionsList();
+
+    QStringList paths;
+    for(int i = 0; i < modelAffectedItems->rowCount(); i++)
+    {
+        paths << modelAffectedItems->item(i)->text();
+    }
+    m_pAffectedItemsDelegate->matchTexts(paths);
 }
 
 void MainWindow::on_treeWidgetRepo_customContextMenuRequested(const QPoint &pos)
 {
     QMenu* contextMenu = new QMenu(ui->treeWidgetRepo);
     contextMenu->addAction("Show logs", this, SLOT(on_show_logs_at_node()));
+    QTreeWidgetItem* pItem = ui->treeWidgetRepo->itemAt(pos);
+    if(pItem && pItem->childIndicatorPolicy() != QTreeWidgetItem::ShowIndicator)
+    {
+        contextMenu->addAction("Blame", this, SLOT(on_blame_node()));
+    }
     contextMenu->popup(ui->treeWidgetRepo->viewport()->mapToGlobal(pos));
 }
 
+void MainWindow::on_blame_node()
+{
+    if(ui->treeWidgetRepo->selectedItems().size() != 1)
+    {
+        return;
+    }
+
+    showBlame(getPathToRoot(ui->treeWidgetRepo->selectedItems().back()), -1);
+}
+
 void MainWindow::on_show_logs_at_node()
 {
     if(ui->treeWidgetRepo->selectedItems().size() != 1)
@@ -440,40 +1130,241 @@ void MainWindow::on_show_logs_at_node()
     {
         modelRevisions->removeRows(0, modelRevisions->rowCount());
     }
+    m_nNewestDisplayedRevision = -1;
+
+    m_currentRepoPath = strFullRepoPath;
+    SvnViewer::instance()->viewLog(strFullRepoPath.toStdString());
+}
+
+void MainWindow::onRevisionsListUpdated()
+{
+    m_pUpdateQueue->post(new QEvent(REVISIONS_UPDATED));
+}
+
+void MainWindow::onLocalModificationsUpdated()
+{
+    m_pUpdateQueue->post(new QEvent(LOCAL_CHANGES_UPDATED));
+}
+
+void MainWindow::onLocalModificationsChanged(const LocalChangesDelta& delta)
+{
+    m_pUpdateQueue->post(new LocalChangesDeltaEvent(delta));
+}
+
+void MainWindow::onAffectedItemsUpdated()
+{
+    m_pUpdateQueue->post(new QEvent(AFFECTED_ITEMS_UPDATED));
+}
+
+void MainWindow::onErrosGenerated()
+{
+
+}
+
+void MainWindow::onRepoContentUpdated()
+{
+    m_pUpdateQueue->post(new QEvent(REPO_CONTENT_UPDATED));
+}
+
+void MainWindow::onRevisionsPrepended(int /*nCount*/)
+{
+    //the view inserts whatever is newer than its top row, so pending prepends merge into one
+    m_pUpdateQueue->post(new QEvent(REVISIONS_PREPENDED));
+}
+
+void MainWindow::onAffectedItemsLoaded(int nRevision)
+{
+    m_pUpdateQueue->post(new AffectedItemsLoadedEvent(nRevision));
+}
+
+void MainWindow::onRevisionStatsLoaded(int nRevision)
+{
+    m_pUpdateQueue->post(new RevisionStatsLoadedEvent(nRevision));
+}
+
+void MainWindow::onRepoNodeListed(const std::string& nodePath)
+{
+    m_pUpdateQueue->post(new RepoNodeListedEvent(nodePath.c_str()));
+}
+
+void MainWindow::onFileDiffLoaded(const std::string& path, int nRevision, std::shared_ptr<const TextDiff> spDiff)
+{
+    m_pUpdateQueue->post(new FileDiffLoadedEvent(path.c_str(), nRevision, spDiff));
+}
+
+void MainWindow::onBlameLinesLoaded(const std::string& path, int nRevision, int nFirstLine, const BlameLine::Collection& lines)
+{
+    m_pUpdateQueue->post(new BlameLoadedEvent(path.c_str(), nRevision, nFirstLine, lines));
+}
+
+void MainWindow::onBlameCompleted(const std::string& path, int nRevision, bool bSuccess)
+{
+    BlameLoadedEvent* pEvent = new BlameLoadedEvent(path.c_str(), nRevision, 0, BlameLine::Collection());
+    pEvent->m_bCompleted = true;
+    pEvent->m_bSuccess = bSuccess;
+    m_pUpdateQueue->post(pEvent);
+}
+
+void MainWindow::onReviewFileStaged(int nReviewId, int nIndex)
+{
+    m_pUpdateQueue->post(new ReviewProgressEvent(nReviewId, nIndex));
+}
+
+void MainWindow::onHistorySearchMatch(int nSearchId, int nRevision, const std::string& url, bool bAdded, int nLine, const std::string& line)
+{
+    HistorySearchProgressEvent::Match match;
+    match.m_nRevision = nRevision;
+    match.m_url = QString::fromStdString(url);
+    match.m_bAdded = bAdded;
+    match.m_nLine = nLine;
+    match.m_line = QString::fromStdString(line);
+
+    HistorySearchProgressEvent* pEvent = new HistorySearchProgressEvent(nSearchId);
+    pEvent->m_matches.append(match);
+    m_pUpdateQueue->post(pEvent);
+}
+
+void MainWindow::onHistorySearchProgress(int nSearchId, int nScannedRevisions)
+{
+    HistorySearchProgressEvent* pEvent = new HistorySearchProgressEvent(nSearchId);
+    pEvent->m_nScannedRevisions = nScannedRevisions;
+    m_pUpdateQueue->post(pEvent);
+}
+
+void MainWindow::onHistorySearchCompleted(int nSearchId)
+{
+    HistorySearchProgressEvent* pEvent = new HistorySearchProgressEvent(nSearchId);
+    pEvent->m_bCompleted = true;
+    m_pUpdateQueue->post(pEvent);
+}
+
+void MainWindow::onReviewCompleted(int nReviewId)
+{
+    m_pUpdateQueue->post(new ReviewProgressEvent(nReviewId, -1));
+}
+
+void MainWindow::onUpdateProgress(int nUpdatedItems, const std::string& currentItem)
+{
+    m_pUpdateQueue->post(new UpdateProgressEvent(QString("Updating: %1 items, %2").arg(nUpdatedItems).arg(currentItem.c_str())));
+}
+
+void MainWindow::onUpdateCompleted(int nRevision, int nUpdatedItems, bool bSuccess)
+{
+    QString message = bSuccess ? QString("Updated to revision %1, %2 items changed.").arg(nRevision).arg(nUpdatedItems)
+                               : QString("Update failed after %1 items.").arg(nUpdatedItems);
+    m_pUpdateQueue->post(new UpdateProgressEvent(message));
+}
+
+void MainWindow::onCommandCompleted(const std::string& commandType, bool bSuccess)
+{
+    RefreshScheduler::Kind kind;
+    if(RefreshScheduler::getKindOfCommand(commandType, kind))
+    {
+        m_pUpdateQueue->post(new CommandCompletedEvent(kind, bSuccess));
+    }
+}
+
+void MainWindow::showFileDiff(const QString& strItem, int nRevision)
+{
+    if(AppSettings::instance()->getStringValue("diffViewer", "internal") == "meld")
+    {
+        SvnViewer::instance()->launchDiffViewer(strItem.toStdString(), nRevision);
+        return;
+    }
+
+    //a modal dialog blocks every window except its own children
+    QWidget* pParent = this;
+    if(m_activeStatusDialog)
+        pParent = m_activeStatusDialog;
+    else
+    if(m_activeCommitDialog)
+        pParent = m_activeCommitDialog;
 
-    m_currentRepoPath = strFullRepoPath;
-    SvnViewer::instance()->viewLog(strFullRepoPath.toStdString());
-}
+    DiffViewDialog* pDialog = new DiffViewDialog(strItem, nRevision, pParent);
+    pDialog->setAttribute(Qt::WA_DeleteOnClose);
+    pDialog->show();
+    m_diffViews.append(pDialog);
 
-void MainWindow::onRevisionsListUpdated()
-{
-    m_app.postEvent(this, new QEvent(REVISIONS_UPDATED));
+    SvnViewer::instance()->loadFileDiff(strItem.toStdString(), nRevision);
 }
 
-void MainWindow::onLocalModificationsUpdated()
+void MainWindow::showBlame(const QString& strItem, int nRevision)
 {
-    m_app.postEvent(this, new QEvent(LOCAL_CHANGES_UPDATED));
-}
+    for(QList<QPointer<BlameDialog> >::iterator it = m_blameViews.begin(); it != m_blameViews.end(); ++it)
+    {
+        if(!it->isNull() && (*it)->getPath() == strItem && (*it)->getRevision() == nRevision)
+        {
+            (*it)->raise();
+            (*it)->activateWindow();
+            return;
+        }
+    }
 
-void MainWindow::onAffectedItemsUpdated()
-{
-    m_app.postEvent(this, new QEvent(AFFECTED_ITEMS_UPDATED));
+    BlameDialog* pDialog = new BlameDialog(strItem, nRevision, SvnViewer::instance()->getRevisionsList(), this);
+    pDialog->setAttribute(Qt::WA_DeleteOnClose);
+    pDialog->show();
+    m_blameViews.append(pDialog);
+
+    SvnViewer::instance()->loadBlame(strItem.toStdString(), nRevision);
 }
 
-void MainWindow::onErrosGenerated()
+void MainWindow::displayBlame(const QString& path, int nRevision, int nFirstLine, const BlameLine::Collection& lines,
+                              bool bCompleted, bool bSuccess)
 {
+    for(QList<QPointer<BlameDialog> >::iterator it = m_blameViews.begin(); it != m_blameViews.end();)
+    {
+        if(it->isNull())
+        {
+            it = m_blameViews.erase(it);
+            continue;
+        }
+
+        if((*it)->getPath() == path && (*it)->getRevision() == nRevision)
+        {
+            if(!lines.empty())
+            {
+                (*it)->appendLines(nFirstLine, lines);
+            }
 
+            if(bCompleted)
+            {
+                (*it)->setCompleted(bSuccess);
+            }
+        }
+        ++it;
+    }
 }
 
-void MainWindow::onRepoContentUpdated()
+void MainWindow::displayFileDiff(const QString& path, int nRevision, std::shared_ptr<const TextDiff> spDiff)
 {
-    m_app.postEvent(this, new QEvent(REPO_CONTENT_UPDATED));
+    for(QList<QPointer<DiffViewDialog> >::iterator it = m_diffViews.begin(); it != m_diffViews.end();)
+    {
+        if(it->isNull())
+        {
+            it = m_diffViews.erase(it);
+            continue;
+        }
+
+        if((*it)->getPath() == path && (*it)->getRevision() == nRevision)
+        {
+            (*it)->setDiff(spDiff);
+        }
+        ++it;
+    }
 }
 
 int MainWindow::getSelectedRevision() const
 {
     int nRevision = -1;
     QItemSelectionModel *selectionModel = ui->revisionsTable->selectionModel();
+
+    //of several selected revisions, the one last clicked
+    QModelIndex current = ui->revisionsTable->currentIndex();
+    if(selectionModel && current.isValid() && selectionModel->isRowSelected(current.row(), QModelIndex()))
+    {
+        return modelRevisions->item(current.row(), REVISION_COLUMN)->text().toInt();
+    }
+
     if(selectionModel && selectionModel->hasSelection())
     {
         QModelIndexList selectedList = selectionModel->selectedIndexes();
@@ -488,6 +1379,22 @@ int MainWindow::getSelectedRevision() const
     return nRevision;
 }
 
+std::set<int> MainWindow::getSelectedRevisions() const
+{
+    std::set<int> revisions;
+    QItemSelectionModel *selectionModel = ui->revisionsTable->selectionModel();
+    if(selectionModel)
+    {
+        QModelIndexList selectedList = selectionModel->selectedRows(REVISION_COLUMN);
+        for(const QModelIndex& index : selectedList)
+        {
+            revisions.insert(modelRevisions->itemFromIndex(index)->text().toInt());
+        }
+    }
+
+    return revisions;
+}
+
 void MainWindow::performInitialUpdates(QObject* /*filter*/)
 {
     if(m_bInitalUpdatePerfromed)
@@ -523,44 +1430,36 @@ QString MainWindow::getPathToRoot(const QTreeWidgetItem* pTreeItem)
     return pathToRot;
 }
 
-void MainWindow::displayRevisionsList()
+QList<QStandardItem*> MainWindow::createRevisionRow(const RevisionInfo& revision, int nCurrentRevision)
 {
-    QString strFilter = ui->revisionsFilterEdit->text();
-
-    RevisionInfo::Collection revisions = SvnViewer::instance()->getRevisionsList();
-    int nCurrentRevision = SvnViewer::instance()->getCurrentRevision();
+    bool bCurrentRev = (revision.m_No == nCurrentRevision);
+    bool bNewRev = (revision.m_No > nCurrentRevision);
 
-    //save selection
-    QString strSelectedRevision = ui->lebelRevision->text();
-
-    if(modelRevisions->rowCount())
+    QString strDescription(revision.m_Description.c_str());
+    if(strDescription.contains("\n"))
     {
-        modelRevisions->removeRows(0, modelRevisions->rowCount());
+        strDescription = strDescription.mid(0, strDescription.indexOf("\n"));
+        strDescription += "...";
     }
 
-    for(RevisionInfo::Collection::const_iterator it = revisions.begin(); it != revisions.end(); ++it)
+    QList<QStandardItem*> lineItems;
+    lineItems.append(new QStandardItem(QString::number(revision.m_No)));
+    lineItems.append(new QStandardItem(revision.m_Date.c_str()));
+    lineItems.append(new QStandardItem(revision.m_Author.c_str()));
+    lineItems.append(new QStandardItem());
+    lineItems.append(new QStandardItem());
+    lineItems.append(new QStandardItem());
+    lineItems.append(new QStandardItem(QString("   ") + strDescription));
+
+    lineItems[REVISION_COLUMN]->setData(revision.m_No, Qt::UserRole);
+    setRevisionStatsItems(lineItems[FILES_COLUMN], lineItems[ADDED_LINES_COLUMN], lineItems[REMOVED_LINES_COLUMN], revision.m_Stats);
+    for(QStandardItem* pItem : lineItems)
     {
-        bool bCurrentRev = (it->m_No == nCurrentRevision);
-        bool bNewRev = (it->m_No > nCurrentRevision);
-
-        QList<QStandardItem*> lineItems;
-        std::stringstream ss; ss << it->m_No;
-        QStandardItem* pItem = new QStandardItem(ss.str().c_str());
-
-        if(bCurrentRev || bNewRev)
+        if(!pItem->data(Qt::UserRole).isValid())
         {
-            QFont font = pItem->font();
-            if(bCurrentRev)
-                font.setBold(true);
-            else
-                font.setItalic(true);
-            pItem->setFont(font);
+            pItem->setData(pItem->text(), Qt::UserRole);
         }
-        pItem->setTextAlignment(Qt::AlignHCenter | Qt::AlignVCenter);
 
-        lineItems.append(pItem);
-
-        pItem = new QStandardItem(it->m_Date.c_str());
         if(bCurrentRev || bNewRev)
         {
             QFont font = pItem->font();
@@ -571,52 +1470,115 @@ void MainWindow::displayRevisionsList()
             pItem->setFont(font);
         }
         pItem->setTextAlignment(Qt::AlignHCenter | Qt::AlignVCenter);
-        lineItems.append(pItem);
+    }
+    lineItems.back()->setTextAlignment(Qt::AlignLeft | Qt::AlignVCenter);
 
-        pItem = new QStandardItem(it->m_Author.c_str());
-        if(bCurrentRev || bNewRev)
-        {
-            QFont font = pItem->font();
-            if(bCurrentRev)
-                font.setBold(true);
-            else
-                font.setItalic(true);
-            pItem->setFont(font);
-        }
-        pItem->setTextAlignment(Qt::AlignHCenter | Qt::AlignVCenter);
-        lineItems.append(pItem);
+    return lineItems;
+}
 
-        QString strDescription(it->m_Description.c_str());
-        if(strDescription.contains("\n"))
-        {
-            strDescription = strDescription.mid(0, strDescription.indexOf("\n"));
-            strDescription += "...";
-        }
-        pItem = new QStandardItem(QString("   ") + strDescription);
-        if(bCurrentRev || bNewRev)
+void MainWindow::addHighlightTexts(const QList<QStandardItem*>& lineItems, const QString& strFilter, QStringList& texts)
+{
+    if(strFilter.isEmpty())
+    {
+        return;
+    }
+
+    for(QStandardItem* pItem : lineItems)
+    {
+        texts << pItem->text();
+    }
+}
+
+bool MainWindow::revisionRowMatches(const QList<QStandardItem*>& lineItems, const QString& strFilter)
+{
+    bool bFiltered = strFilter.isEmpty();
+    for(int i = 0; !bFiltered && i < lineItems.size(); i++)
+    {
+        //the statistics arrive later, a row does not appear or vanish with them
+        if(i != FILES_COLUMN && i != ADDED_LINES_COLUMN && i != REMOVED_LINES_COLUMN)
         {
-            QFont font = pItem->font();
-            if(bCurrentRev)
-                font.setBold(true);
-            else
-                font.setItalic(true);
-            pItem->setFont(font);
+            bFiltered = lineItems[i]->text().contains(strFilter, Qt::CaseInsensitive);
         }
-        pItem->setTextAlignment(Qt::AlignLeft | Qt::AlignVCenter);
-        lineItems.append(pItem);
+    }
+
+    return bFiltered;
+}
+
+void MainWindow::setRevisionStatsItems(QStandardItem* pFiles, QStandardItem* pAdded, QStandardItem* pRemoved, const RevisionStats& stats)
+{
+    //unknown statistics are empty and sort as -1, before every known one
+    pFiles->setText(stats.isKnown() ? QString::number(stats.m_nChangedFiles) : QString());
+    pFiles->setData(stats.m_nChangedFiles, Qt::UserRole);
+    pAdded->setText(stats.isKnown() ? QString("+%1").arg(stats.m_nAddedLines) : QString());
+    pAdded->setData(stats.m_nAddedLines, Qt::UserRole);
+    pRemoved->setText(stats.isKnown() ? QString("-%1").arg(stats.m_nRemovedLines) : QString());
+    pRemoved->setData(stats.m_nRemovedLines, Qt::UserRole);
+}
+
+void MainWindow::sortRevisionsTable()
+{
+    //rows are added in the order of the log, newest first; a different order chosen in the header is applied again
+    QHeaderView* pHeader = ui->revisionsTable->horizontalHeader();
+    if(pHeader->sortIndicatorSection() != REVISION_COLUMN || pHeader->sortIndicatorOrder() != Qt::DescendingOrder)
+    {
+        modelRevisions->sort(pHeader->sortIndicatorSection(), pHeader->sortIndicatorOrder());
+    }
+}
 
-        bool bFiltered = strFilter.isEmpty();
-        for(QList<QStandardItem*>::Iterator lineItemIt = lineItems.begin(); !bFiltered && lineItemIt != lineItems.end(); ++lineItemIt)
+void MainWindow::displayRevisionStats(const QSet<int>& revisions)
+{
+    for(int i = 0; i < modelRevisions->rowCount(); i++)
+    {
+        int nRevision = modelRevisions->item(i, REVISION_COLUMN)->text().toInt();
+        RevisionStats stats;
+        if(revisions.contains(nRevision) && SvnViewer::instance()->getRevisionStats(nRevision, stats))
         {
-            bFiltered = (*lineItemIt)->text().contains(strFilter, Qt::CaseInsensitive);
+            setRevisionStatsItems(modelRevisions->item(i, FILES_COLUMN), modelRevisions->item(i, ADDED_LINES_COLUMN),
+                                  modelRevisions->item(i, REMOVED_LINES_COLUMN), stats);
         }
+    }
+
+    int nSortColumn = ui->revisionsTable->horizontalHeader()->sortIndicatorSection();
+    if(nSortColumn == FILES_COLUMN || nSortColumn == ADDED_LINES_COLUMN || nSortColumn == REMOVED_LINES_COLUMN)
+    {
+        sortRevisionsTable();
+    }
+}
+
+void MainWindow::displayRevisionsList()
+{
+    QString strFilter = ui->revisionsFilterEdit->text();
+
+    RevisionInfo::Collection revisions = SvnViewer::instance()->getRevisionsList();
+    int nCurrentRevision = SvnViewer::instance()->getCurrentRevision();
+
+    //save selection
+    QString strSelectedRevision = ui->lebelRevision->text();
+
+    if(modelRevisions->rowCount())
+    {
+        modelRevisions->removeRows(0, modelRevisions->rowCount());
+    }
 
-        if(bFiltered)
+    QStringList highlightTexts;
+    for(RevisionInfo::Collection::const_iterator it = revisions.begin(); it != revisions.end(); ++it)
+    {
+        QList<QStandardItem*> lineItems = createRevisionRow(*it, nCurrentRevision);
+        if(revisionRowMatches(lineItems, strFilter))
         {
+            addHighlightTexts(lineItems, strFilter, highlightTexts);
             modelRevisions->appendRow(lineItems);
         }
+        else
+        {
+            qDeleteAll(lineItems);
+        }
     }
 
+    m_nNewestDisplayedRevision = revisions.empty() ? -1 : revisions.front().m_No;
+    m_pRevisionsDelegate->matchTexts(highlightTexts);
+    sortRevisionsTable();
+
     ui->revisionsTable->resizeColumnsToContents();
     ui->revisionsTable->horizontalHeader()->resizeSection(0, ui->revisionsTable->horizontalHeader()->sectionSize(0) + 40);
     ui->revisionsTable->horizontalHeader()->resizeSection(1, ui->revisionsTable->horizontalHeader()->sectionSize(1) + 40);
@@ -647,6 +1609,69 @@ void MainWindow::displayRevisionsList()
     ui->labelLogsTitle->setText(QString("Revisions list for <") + m_currentRepoPath + ">");
 }
 
+void MainWindow::displayPrependedRevisions()
+{
+    if(m_nNewestDisplayedRevision == -1)
+    {
+        displayRevisionsList();
+        return;
+    }
+
+    //insert only what is newer than the top of the table; a full rebuild delivered in between already shows it
+    QString strFilter = ui->revisionsFilterEdit->text();
+    RevisionInfo::Collection revisions = SvnViewer::instance()->getRevisionsNewerThan(m_nNewestDisplayedRevision);
+    int nCurrentRevision = SvnViewer::instance()->getCurrentRevision();
+
+    int nRow = 0;
+    QStringList highlightTexts;
+    for(RevisionInfo::Collection::const_iterator it = revisions.begin(); it != revisions.end(); ++it)
+    {
+        QList<QStandardItem*> lineItems = createRevisionRow(*it, nCurrentRevision);
+        if(revisionRowMatches(lineItems, strFilter))
+        {
+            addHighlightTexts(lineItems, strFilter, highlightTexts);
+            modelRevisions->insertRow(nRow++, lineItems);
+        }
+        else
+        {
+            qDeleteAll(lineItems);
+        }
+    }
+
+    if(!revisions.empty())
+    {
+        m_nNewestDisplayedRevision = revisions.front().m_No;
+    }
+    m_pRevisionsDelegate->matchTexts(highlightTexts);
+
+    sortRevisionsTable();
+
+    //the oldest revisions dropped to keep the list size, anywhere in the table when it is sorted differently
+    int nOldestRevision = SvnViewer::instance()->getOldestRevision();
+    for(int nOldRow = modelRevisions->rowCount() - 1; nOldRow >= 0; nOldRow--)
+    {
+        if(modelRevisions->item(nOldRow, REVISION_COLUMN)->text().toInt() < nOldestRevision)
+        {
+            modelRevisions->removeRow(nOldRow);
+        }
+    }
+
+    if(!ui->revisionsTable->selectionModel()->hasSelection() && modelRevisions->rowCount())
+    {
+        ui->revisionsTable->selectRow(0);
+        on_revisionsTable_clicked(modelRevisions->index(0,0));
+    }
+}
+
+void MainWindow::displayAffectedItems(int nRevision)
+{
+    //the changed paths of any other revision are shown when it gets selected
+    if(nRevision == getSelectedRevision())
+    {
+        displayAffectedItems();
+    }
+}
+
 void MainWindow::displayAffectedItems()
 {
     int nRevision = getSelectedRevision();
@@ -698,10 +1723,13 @@ void MainWindow::displayAffectedItems()
     }
 
 
+    QStringList paths;
     for(std::list<std::string>::const_iterator it = changeset.m_AffectedItems.begin(); it != changeset.m_AffectedItems.end(); ++it)
     {
         modelAffectedItems->appendRow(new QStandardItem(it->c_str()));
+        paths << it->c_str();
     }
+    m_pAffectedItemsDelegate->matchTexts(paths);
 
     ui->revisionDetails->resizeColumnsToContents();
     ui->revisionDetails->horizontalHeader()->setStretchLastSection(true);
@@ -731,7 +1759,87 @@ void MainWindow::displayLocalChanges()
     }
 }
 
-void MainWindow::fillParentItem(RepoItemInfo::SmartPtr& repoItem, QTreeWidgetItem* parentItem, QTreeWidget* parentView)
+void MainWindow::displayLocalChanges(const LocalChangesDelta& delta)
+{
+    if(delta.m_bFullStatus)
+    {
+        displayLocalChanges();
+        return;
+    }
+
+    ChangeInfo::Collection localChanges = SvnViewer::instance()->getLocalChanges();
+    if(m_activeStatusDialog)
+    {
+        m_activeStatusDialog->updateChanges(localChanges);
+    }
+
+    if(m_activeCommitDialog)
+    {
+        m_activeCommitDialog->updateChanges(localChanges);
+    }
+
+    //only the tree items on the path of a changed entry can change their state
+    QSet<QTreeWidgetItem*> affectedItems;
+    for(const ChangeInfo::Collection* pEntries : {&delta.m_added, &delta.m_removed, &delta.m_changed})
+    {
+        for(const ChangeInfo& change : *pEntries)
+        {
+            for(QTreeWidgetItem* pItem : findTreeItemsOnPath(change.m_AffectedItem.c_str()))
+            {
+                affectedItems.insert(pItem);
+            }
+        }
+    }
+
+    for(QTreeWidgetItem* pItem : affectedItems)
+    {
+        updateTreeItemState(pItem, localChanges);
+    }
+}
+
+QList<QTreeWidgetItem*> MainWindow::findTreeItemsOnPath(const QString& path) const
+{
+    QList<QTreeWidgetItem*> items;
+    QTreeWidgetItem* pItem = ui->treeWidgetRepo->topLevelItem(0);
+    if(!pItem)
+    {
+        return items;
+    }
+
+    QString strRoot = pItem->text(0);
+    if(!path.startsWith(strRoot))
+    {
+        return items;
+    }
+
+    //walk down from the root one path component at a time; directory items end with '/'
+    items.append(pItem);
+    QStringList components = path.mid(strRoot.length()).split('/', QString::SkipEmptyParts);
+    for(const QString& component : components)
+    {
+        QTreeWidgetItem* pChild = nullptr;
+        for(int i = 0; i < pItem->childCount() && !pChild; i++)
+        {
+            QString strChild = pItem->child(i)->text(0);
+            if(strChild == component || strChild == component + "/")
+            {
+                pChild = pItem->child(i);
+            }
+        }
+
+        if(!pChild)
+        {
+            break;
+        }
+
+        items.append(pChild);
+        pItem = pChild;
+    }
+
+    return items;
+}
+
+size_t MainWindow::fillParentItem(RepoItemInfo::SmartPtr& repoItem, QTreeWidgetItem* parentItem, QTreeWidget* parentView)
 {
     QTreeWidgetItem* pItem = parentItem == nullptr ? new QTreeWidgetItem(parentView) : new QTreeWidgetItem(parentItem);
     QString strItemText(repoItem->m_name.c_str());
@@ -739,15 +1847,18 @@ void MainWindow::fillParentItem(RepoItemInfo::SmartPtr& repoItem, QTreeWidgetIte
     if(repoItem->m_type == RepoItemInfo::Directory)
         pItem->setChildIndicatorPolicy(QTreeWidgetItem::ShowIndicator);
 
-    fillChildItems(repoItem, pItem);
+    return 1 + fillChildItems(repoItem, pItem);
 }
 
-void MainWindow::fillChildItems(RepoItemInfo::SmartPtr& repoItem, QTreeWidgetItem* parentItem)
+size_t MainWindow::fillChildItems(RepoItemInfo::SmartPtr& repoItem, QTreeWidgetItem* parentItem)
 {
+    size_t nItems = 0;
     for(RepoItemInfo::SmartPtr& child : repoItem->m_subItems)
     {
-        fillParentItem(child, parentItem, nullptr);
+        nItems += fillParentItem(child, parentItem, nullptr);
     }
+
+    return nItems;
 }
 
 void MainWindow::updateTreeItemState(QTreeWidgetItem* pTreeItem, ChangeInfo::Collection& localChanges)
@@ -790,7 +1901,7 @@ void MainWindow::displayRepoContent()
     if(!ui->treeWidgetRepo->topLevelItem(0))
     {
         QTreeWidgetItem* pRootItem = nullptr;
-        fillParentItem(repoContent, pRootItem, ui->treeWidgetRepo);
+        m_nTreeItems += fillParentItem(repoContent, pRootItem, ui->treeWidgetRepo);
         ui->treeWidgetRepo->addTopLevelItem(pRootItem);
     }
     else
@@ -804,7 +1915,7 @@ void MainWindow::displayRepoContent()
                 RepoItemInfo::SmartPtr childContent = repoContent->findChildNode(strItemPath.toStdString());
                 if(childContent && !childContent->m_subItems.empty())
                 {
-                    fillChildItems(childContent, *it);
+                    m_nTreeItems += fillChildItems(childContent, *it);
                 }
             }
 
@@ -815,3 +1926,95 @@ void MainWindow::displayRepoContent()
     //update status icons also
     displayLocalChanges();
 }
+
+void MainWindow::displayRepoNode(const QString& nodePath)
+{
+    QString strNodePath = nodePath.endsWith("/") ? nodePath.left(nodePath.length() - 1) : nodePath;
+    QList<QTreeWidgetItem*> items = findTreeItemsOnPath(strNodePath);
+    QString strItemPath = items.isEmpty() ? QString() : getPathToRoot(items.back());
+    if(strItemPath.endsWith("/"))
+    {
+        strItemPath.chop(1);
+    }
+
+    if(strItemPath.isEmpty() || strItemPath != strNodePath)
+    {
+        //not shown yet (or the first listing of the root)
+        displayRepoContent();
+        return;
+    }
+
+    QTreeWidgetItem* pItem = items.back();
+    if(pItem->childCount())
+    {
+        return;
+    }
+
+    RepoItemInfo::SmartPtr repoContent = SvnViewer::instance()->getRepoContent();
+    RepoItemInfo::SmartPtr nodeContent = pItem->parent() ? repoContent->findChildNode(getPathToRoot(pItem).toStdString()) : repoContent;
+    if(!nodeContent || nodeContent->m_subItems.empty())
+    {
+        return;
+    }
+
+    m_nTreeItems += fillChildItems(nodeContent, pItem);
+
+    //only the new items need their status icons
+    ChangeInfo::Collection localChanges = SvnViewer::instance()->getLocalChanges();
+    for(int i = 0; i < pItem->childCount(); i++)
+    {
+        updateTreeItemState(pItem->child(i), localChanges);
+    }
+}
+
+void MainWindow::displayMemoryUsage()
+{
+    //rough cost of one QStandardItem / QTreeWidgetItem with its text
+    static const size_t GUI_ITEM_BYTES = 160;
+
+    //the views count against the budget of the viewer, evicting changed paths when they grow
+    size_t nGuiBytes = GUI_ITEM_BYTES * (modelRevisions->rowCount() * modelRevisions->columnCount()
+                                         + modelAffectedItems->rowCount() + m_nTreeItems);
+    SvnViewer::instance()->setViewsMemoryUsage(nGuiBytes);
+    SvnViewerMemoryStats stats = SvnViewer::instance()->getMemoryStats();
+
+    GuiUpdateQueue::Stats queueStats = m_pUpdateQueue->getStats()[QEvent::None];
+    FileRevisionCacheStats cacheStats = FileRevisionCache::instance()->getStats();
+    SvnViewerPrefetchStats prefetchStats = SvnViewer::instance()->getPrefetchStats();
+
+    auto toKB = [](size_t nBytes) { return QString::number(nBytes / 1024.0, 'f', 1) + " KB"; };
+
+    m_pMemoryLabel->setText(QString("Memory: %1 of %2 MB")
+                            .arg(stats.getTotalBytes() / (1024.0 * 1024.0), 0, 'f', 1)
+                            .arg(stats.m_nBudgetBytes / (1024 * 1024)));
+    m_pMemoryLabel->setToolTip(QString("Revisions: %1\nAffected items: %2 (%3 revisions loaded, %4 evicted)\n"
+                                       "Repository tree: %5\nLocal changes: %6\nViews (estimated): %7")
+                               .arg(toKB(stats.m_nRevisionsBytes))
+                               .arg(toKB(stats.m_nAffectedItemsBytes))
+                               .arg(stats.m_nLoadedChangeSets)
+                               .arg(stats.m_nEvictedChangeSets)
+                               .arg(toKB(stats.m_nRepoContentBytes))
+                               .arg(toKB(stats.m_nLocalChangesBytes))
+                               .arg(toKB(stats.m_nViewsBytes))
+                               + QString("\nGUI updates: %1 posted, %2 merged, latency %3 ms mean, %4 ms max")
+                               .arg(queueStats.m_nPosted)
+                               .arg(queueStats.m_nMerged)
+                               .arg(queueStats.getMeanLatencyMs(), 0, 'f', 1)
+                               .arg(queueStats.m_dMaxLatencyMs, 0, 'f', 1)
+                               + QString("\nFile cache: %1 hits, %2 misses (%3% hit rate), %4 revisions in %5 files, %6 of %7 MB")
+                               .arg(cacheStats.m_nHits)
+                               .arg(cacheStats.m_nMisses)
+                               .arg(cacheStats.getHitRate() * 100, 0, 'f', 1)
+                               .arg(cacheStats.m_nKeys)
+                               .arg(cacheStats.m_nObjects)
+                               .arg(cacheStats.m_nStoredBytes / (1024.0 * 1024.0), 0, 'f', 1)
+                               .arg(cacheStats.m_nSizeLimit / (1024 * 1024))
+                               + QString("\nPrefetch: %1 hits, %2 still loading, %3 misses (%4% hit rate), %5 fetched, %6 wasted, %7 cancelled")
+                               .arg(prefetchStats.m_nHits)
+                               .arg(prefetchStats.m_nLateHits)
+                               .arg(prefetchStats.m_nMisses)
+                               .arg(prefetchStats.getHitRate() * 100, 0, 'f', 1)
+                               .arg(prefetchStats.m_nFetched)
+                               .arg(prefetchStats.m_nWasted)
+                               .arg(prefetchStats.m_nCancelled));
+}
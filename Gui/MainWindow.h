@@ -5,6 +5,12 @@
 #include "Gui/CommitDialog.h"
 #include "Gui/StatusDialog.h"
 #include "Gui/CommonUI.h"
+#include "Gui/RefreshScheduler.h"
+#include "Gui/GuiUpdateQueue.h"
+#include "Gui/DiffViewDialog.h"
+#include "Gui/BlameDialog.h"
+#include "Gui/ReviewDialog.h"
+#include "Gui/HistorySearchDialog.h"
 #include "Repos/SVN/SvnViewer.h"
 
 
@@ -14,12 +20,19 @@
 #include <QItemSelection>
 #include <QApplication>
 #include <QTreeWidgetItem>
+#include <QLabel>
+#include <QPointer>
+#include <QMap>
+#include <QSet>
 
 namespace Ui {
 class MainWindow;
 }
 
-class MainWindow : public QMainWindow, public SvnViewerObserver, public RepoDialogsObserver
+class HistorySearchProgressEvent;
+class HighlightDelegate;
+
+class MainWindow : public QMainWindow, public SvnViewerObserver, public RepoDialogsObserver, public HistorySearchDialogObserver
 {
     Q_OBJECT
 
@@ -27,6 +40,8 @@ public:
     explicit MainWindow(QApplication& app, QWidget *parent = 0);
     ~MainWindow();
 
+    const GuiUpdateQueue* getUpdateQueue() const { return m_pUpdateQueue; }
+
 private slots:
     void on_actionOpen_triggered();
     void on_revisionsTable_clicked(const QModelIndex &index);
@@ -38,6 +53,8 @@ private slots:
     void on_actionCommit_triggered();
     void on_revisionsTable_customContextMenuRequested(const QPoint &pos);
     void on_update_to_revision();
+    void on_review_revision();
+    void on_search_history();
     void on_revisionsTable_selection_changed(const QItemSelection & selected, const QItemSelection & deselected);
     void on_actionAbout_triggered();
     void on_treeWidgetRepo_itemExpanded(QTreeWidgetItem *item);
@@ -45,6 +62,16 @@ private slots:
     void on_revisionsFilterEdit_textChanged(const QString &arg1);
     void on_treeWidgetRepo_customContextMenuRequested(const QPoint &pos);
     void on_show_logs_at_node();
+    void on_blame_node();
+    void on_revisionDetails_customContextMenuRequested(const QPoint &pos);
+    void on_show_changes_of_affected_item();
+    void on_blame_affected_item();
+    void on_refresh_requested(int nKind);
+    void on_schedule_changed();
+    void on_background_work_paused(bool bPaused);
+    void on_revisions_scrolled();
+    void on_prefetch_timeout();
+    void on_memory_timer_timeout();
 
 private:
 
@@ -52,39 +79,104 @@ private:
     virtual void onRevisionsListUpdated();
     virtual void onAffectedItemsUpdated();
     virtual void onLocalModificationsUpdated();
+    virtual void onLocalModificationsChanged(const LocalChangesDelta& delta);
     virtual void onErrosGenerated();
     virtual void onRepoContentUpdated();
+    virtual void onRevisionsPrepended(int nCount);
+    virtual void onAffectedItemsLoaded(int nRevision);
+    virtual void onRepoNodeListed(const std::string& nodePath);
+    virtual void onFileDiffLoaded(const std::string& path, int nRevision, std::shared_ptr<const TextDiff> spDiff);
+    virtual void onBlameLinesLoaded(const std::string& path, int nRevision, int nFirstLine, const BlameLine::Collection& lines);
+    virtual void onBlameCompleted(const std::string& path, int nRevision, bool bSuccess);
+    virtual void onReviewFileStaged(int nReviewId, int nIndex);
+    virtual void onReviewCompleted(int nReviewId);
+    virtual void onRevisionStatsLoaded(int nRevision);
+    virtual void onHistorySearchMatch(int nSearchId, int nRevision, const std::string& url, bool bAdded, int nLine, const std::string& line);
+    virtual void onHistorySearchProgress(int nSearchId, int nScannedRevisions);
+    virtual void onHistorySearchCompleted(int nSearchId);
+    virtual void onCommandCompleted(const std::string& commandType, bool bSuccess);
+    virtual void onUpdateProgress(int nUpdatedItems, const std::string& currentItem);
+    virtual void onUpdateCompleted(int nRevision, int nUpdatedItems, bool bSuccess);
 
     //RepoDialogsObserver
     virtual void onLaunchDiff(const QString& strItem);
     virtual void onRevertModifiedItem(const QString& strItem);
     virtual void onAdToSourceControl(const QString& strItem);
 
+    //HistorySearchDialogObserver
+    virtual std::shared_ptr<HistorySearch> onStartHistorySearch(const QString& pattern, bool bRegex, bool bStopAtIntroduction,
+                                                                int nFirstRevision, int nLastRevision);
+    virtual void onShowRevisionChanges(const QString& url, int nRevision);
+
 
     int getSelectedRevision() const;
+    std::set<int> getSelectedRevisions() const;
+    QString getAffectedItemPath(const QModelIndex& index) const;
+    //the built-in diff view, or meld with diffViewer=meld in the settings
+    void showFileDiff(const QString& strItem, int nRevision);
+    void displayFileDiff(const QString& path, int nRevision, std::shared_ptr<const TextDiff> spDiff);
+    void showBlame(const QString& strItem, int nRevision);
+    void displayBlame(const QString& path, int nRevision, int nFirstLine, const BlameLine::Collection& lines,
+                      bool bCompleted, bool bSuccess);
+    void displayReviewProgress(int nReviewId, const std::vector<int>& stagedFiles, bool bCompleted);
+    void displayHistorySearchProgress(const HistorySearchProgressEvent& event);
     void performInitialUpdates(QObject* filter);
     static QString getPathToRoot(const QTreeWidgetItem* pTreeItem);
 
-    static void fillParentItem(RepoItemInfo::SmartPtr& repoItem, QTreeWidgetItem* parentItem, QTreeWidget* parentView);
-    static void fillChildItems(RepoItemInfo::SmartPtr& repoItem, QTreeWidgetItem* parentItem);
+    //both return the number of tree items created
+    static size_t fillParentItem(RepoItemInfo::SmartPtr& repoItem, QTreeWidgetItem* parentItem, QTreeWidget* parentView);
+    static size_t fillChildItems(RepoItemInfo::SmartPtr& repoItem, QTreeWidgetItem* parentItem);
     static void updateTreeItemState(QTreeWidgetItem* pTreeItem, ChangeInfo::Collection& localChanges);
 
+    static QList<QStandardItem*> createRevisionRow(const RevisionInfo& revision, int nCurrentRevision);
+    static bool revisionRowMatches(const QList<QStandardItem*>& lineItems, const QString& strFilter);
+    //texts of a row shown with the filter, their occurrences get highlighted
+    static void addHighlightTexts(const QList<QStandardItem*>& lineItems, const QString& strFilter, QStringList& texts);
+    static void setRevisionStatsItems(QStandardItem* pFiles, QStandardItem* pAdded, QStandardItem* pRemoved, const RevisionStats& stats);
+    void sortRevisionsTable();
+    void displayRevisionStats(const QSet<int>& revisions);
     void displayRevisionsList();
+    void displayPrependedRevisions();
     void displayLocalChanges();
+    void displayLocalChanges(const LocalChangesDelta& delta);
+    QList<QTreeWidgetItem*> findTreeItemsOnPath(const QString& path) const;
     void displayAffectedItems();
+    //the revisions around the selection, then the visible ones, get their affected items fetched ahead
+    void updatePrefetchWindow();
+    void displayAffectedItems(int nRevision);
     void displayRepoContent();
+    void displayRepoNode(const QString& nodePath);
+    void displayMemoryUsage();
 private:
     Ui::MainWindow *ui;
     QStandardItemModel *modelRevisions;
     QStandardItemModel *modelAffectedItems;
+    HighlightDelegate* m_pRevisionsDelegate;
+    HighlightDelegate* m_pAffectedItemsDelegate;
 
     friend class RefreshGuiEventFilter;
     QApplication& m_app;
     bool m_bInitalUpdatePerfromed;
+    int m_nNewestDisplayedRevision;
 
     StatusDialog* m_activeStatusDialog;
     CommitDialog* m_activeCommitDialog;
     QString m_currentRepoPath;
+    QLabel* m_pMemoryLabel;
+    QLabel* m_pScheduleLabel;
+    RefreshScheduler* m_pRefreshScheduler;
+    QTimer* m_pPrefetchTimer;
+    int m_nPrefetchRevisions;
+    QTimer* m_pMemoryTimer;
+    //items of the repository tree, they are only added until the tree is cleared
+    size_t m_nTreeItems;
+    GuiUpdateQueue* m_pUpdateQueue;
+    QList<QPointer<DiffViewDialog> > m_diffViews;
+    QList<QPointer<BlameDialog> > m_blameViews;
+    QList<QPointer<ReviewDialog> > m_reviewViews;
+    QList<QPointer<HistorySearchDialog> > m_historySearchViews;
+    //reviews handed to meld when staged
+    QMap<int, std::shared_ptr<ReviewSession> > m_meldReviews;
 };
 
 #endif // MAINWINDOW_H
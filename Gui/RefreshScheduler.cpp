@@ -0,0 +1,249 @@
+#include "RefreshScheduler.h"
+
+#include "Settings/AppSettings.h"
+
+#include <QApplication>
+#include <QEvent>
+#include <QStringList>
+
+//no interaction for this long means the user is away
+static const qint64 IDLE_AFTER_MS = 5 * 60 * 1000;
+//interaction within this window counts as actively working
+static const qint64 INTERACTING_WITHIN_MS = 60 * 1000;
+static const int MIN_INTERVAL_MS = 15 * 1000;
+static const int MAX_INTERVAL_MS = 30 * 60 * 1000;
+//each failure or idle period doubles the interval, up to 2^MAX_BACKOFF_LEVEL
+static const int MAX_BACKOFF_LEVEL = 6;
+//background work resumes after this long without input
+static const int RESUME_BACKGROUND_AFTER_MS = 2000;
+
+static const char* KIND_NAMES[RefreshScheduler::KindsCount] = {"log", "status", "tree"};
+
+static QString formatInterval(int nMs)
+{
+    int nSeconds = nMs / 1000;
+    if(nSeconds < 60)
+    {
+        return QString("%1 s").arg(nSeconds);
+    }
+
+    return QString("%1 min").arg((nSeconds + 30) / 60);
+}
+
+RefreshScheduler::RefreshScheduler(QWidget* pWindow)
+    : QObject(pWindow)
+    , m_pWindow(pWindow)
+    , m_bInteracting(true)
+    , m_bBackgroundPaused(false)
+{
+    m_schedules[RemoteLog].m_nBaseInterval = AppSettings::instance()->getIntValue("refreshLogSeconds", 120) * 1000;
+    m_schedules[LocalStatus].m_nBaseInterval = AppSettings::instance()->getIntValue("refreshStatusSeconds", 300) * 1000;
+    m_schedules[TreeListing].m_nBaseInterval = AppSettings::instance()->getIntValue("refreshTreeSeconds", 600) * 1000;
+
+    for(int i = 0; i < KindsCount; i++)
+    {
+        m_schedules[i].m_nBaseInterval = qBound(MIN_INTERVAL_MS, m_schedules[i].m_nBaseInterval, MAX_INTERVAL_MS);
+        m_schedules[i].m_pTimer = new QTimer(this);
+        m_schedules[i].m_pTimer->setSingleShot(true);
+        m_schedules[i].m_pTimer->setProperty("kind", i);
+        connect(m_schedules[i].m_pTimer, SIGNAL(timeout()), SLOT(on_timer_timeout()));
+    }
+
+    m_pResumeTimer = new QTimer(this);
+    m_pResumeTimer->setSingleShot(true);
+    connect(m_pResumeTimer, SIGNAL(timeout()), SLOT(on_resumeTimer_timeout()));
+
+    m_lastInteraction.start();
+    qApp->installEventFilter(this);
+}
+
+void RefreshScheduler::start()
+{
+    for(int i = 0; i < KindsCount; i++)
+    {
+        reschedule(m_schedules[i], false);
+    }
+}
+
+void RefreshScheduler::onRefreshCompleted(Kind kind, bool bSuccess)
+{
+    Schedule& schedule = m_schedules[kind];
+    if(bSuccess)
+    {
+        if(!schedule.m_nFailures)
+        {
+            return;
+        }
+
+        schedule.m_nFailures = 0;
+        reschedule(schedule, true);
+    }
+    else
+    {
+        schedule.m_nFailures = qMin(schedule.m_nFailures + 1, MAX_BACKOFF_LEVEL);
+        reschedule(schedule, false);
+    }
+}
+
+int RefreshScheduler::getInterval(Kind kind) const
+{
+    return m_schedules[kind].m_nInterval;
+}
+
+QString RefreshScheduler::describeSchedule() const
+{
+    QStringList parts;
+    for(int i = 0; i < KindsCount; i++)
+    {
+        QString part = QString("%1 %2").arg(KIND_NAMES[i]).arg(formatInterval(m_schedules[i].m_nInterval));
+        if(m_schedules[i].m_nFailures)
+        {
+            part += QString(" (%1 errors)").arg(m_schedules[i].m_nFailures);
+        }
+        parts.push_back(part);
+    }
+
+    QString state = isHidden() ? "hidden" : isIdle() ? "idle" : isInteracting() ? "active" : "normal";
+    return QString("Refresh: %1 [%2]").arg(parts.join(", ")).arg(state);
+}
+
+bool RefreshScheduler::getKindOfCommand(const std::string& commandType, Kind& kind)
+{
+    if(commandType == "svn info" || commandType == "svn info -r HEAD" || commandType == "svn log")
+    {
+        kind = RemoteLog;
+        return true;
+    }
+
+    if(commandType == "svn status")
+    {
+        kind = LocalStatus;
+        return true;
+    }
+
+    if(commandType == "svn list")
+    {
+        kind = TreeListing;
+        return true;
+    }
+
+    return false;
+}
+
+bool RefreshScheduler::eventFilter(QObject* obj, QEvent* event)
+{
+    switch(event->type())
+    {
+    case QEvent::KeyPress:
+    case QEvent::MouseButtonPress:
+    case QEvent::Wheel:
+        onUserInteraction();
+        break;
+
+    case QEvent::WindowActivate:
+        if(obj == m_pWindow)
+        {
+            onUserInteraction();
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    return QObject::eventFilter(obj, event);
+}
+
+void RefreshScheduler::on_timer_timeout()
+{
+    QTimer* pTimer = qobject_cast<QTimer*>(sender());
+    if(!pTimer)
+    {
+        return;
+    }
+
+    Schedule& schedule = m_schedules[pTimer->property("kind").toInt()];
+    if(m_bInteracting && !isInteracting())
+    {
+        m_bInteracting = false;
+    }
+
+    if(isIdle() || isHidden())
+    {
+        schedule.m_nIdleLevel = qMin(schedule.m_nIdleLevel + 1, MAX_BACKOFF_LEVEL);
+    }
+
+    emit refreshRequested(pTimer->property("kind").toInt());
+    reschedule(schedule, false);
+}
+
+void RefreshScheduler::on_resumeTimer_timeout()
+{
+    m_bBackgroundPaused = false;
+    emit backgroundWorkPaused(false);
+}
+
+bool RefreshScheduler::isHidden() const
+{
+    return !m_pWindow->isVisible() || m_pWindow->isMinimized();
+}
+
+bool RefreshScheduler::isIdle() const
+{
+    return m_lastInteraction.elapsed() > IDLE_AFTER_MS;
+}
+
+bool RefreshScheduler::isInteracting() const
+{
+    return m_lastInteraction.elapsed() < INTERACTING_WITHIN_MS;
+}
+
+int RefreshScheduler::computeInterval(const Schedule& schedule) const
+{
+    qint64 nInterval = schedule.m_nBaseInterval;
+    if(isInteracting() && !isHidden() && !schedule.m_nFailures)
+    {
+        nInterval /= 2;
+    }
+
+    nInterval <<= schedule.m_nFailures + schedule.m_nIdleLevel;
+    return static_cast<int>(qBound<qint64>(MIN_INTERVAL_MS, nInterval, MAX_INTERVAL_MS));
+}
+
+void RefreshScheduler::reschedule(Schedule& schedule, bool bKeepEarlierTimeout)
+{
+    schedule.m_nInterval = computeInterval(schedule);
+    if(!bKeepEarlierTimeout || !schedule.m_pTimer->isActive() || schedule.m_pTimer->remainingTime() > schedule.m_nInterval)
+    {
+        schedule.m_pTimer->start(schedule.m_nInterval);
+    }
+
+    emit scheduleChanged();
+}
+
+void RefreshScheduler::onUserInteraction()
+{
+    m_lastInteraction.restart();
+    m_pResumeTimer->start(RESUME_BACKGROUND_AFTER_MS);
+    if(!m_bBackgroundPaused)
+    {
+        m_bBackgroundPaused = true;
+        emit backgroundWorkPaused(true);
+    }
+
+    if(m_bInteracting)
+    {
+        return;
+    }
+
+    //back from idle: drop the idle backoff and bring the pending refreshes closer
+    m_bInteracting = true;
+    for(int i = 0; i < KindsCount; i++)
+    {
+        m_schedules[i].m_nIdleLevel = 0;
+        if(m_schedules[i].m_pTimer->isActive())
+        {
+            reschedule(m_schedules[i], true);
+        }
+    }
+}
@@ -0,0 +1,85 @@
+#ifndef REFRESHSCHEDULER_H
+#define REFRESHSCHEDULER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QWidget>
+#include <QElapsedTimer>
+#include <QString>
+
+#include <string>
+
+//decides when each kind of refresh runs: faster while the user interacts with the window,
+//exponentially slower after errors and while the window is idle or hidden
+class RefreshScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Kind
+    {
+        RemoteLog = 0,
+        LocalStatus,
+        TreeListing,
+        KindsCount
+    };
+
+    RefreshScheduler(QWidget* pWindow);
+
+    void start();
+
+    void onRefreshCompleted(Kind kind, bool bSuccess);
+    int getInterval(Kind kind) const;
+    QString describeSchedule() const;
+
+    static bool getKindOfCommand(const std::string& commandType, Kind& kind);
+
+signals:
+    void refreshRequested(int nKind);
+    void scheduleChanged();
+    //background work yields to input: paused on each interaction, resumed after a short quiet period
+    void backgroundWorkPaused(bool bPaused);
+
+protected:
+    bool eventFilter(QObject* obj, QEvent* event);
+
+private slots:
+    void on_timer_timeout();
+    void on_resumeTimer_timeout();
+
+private:
+    struct Schedule
+    {
+        Schedule()
+            : m_pTimer(nullptr)
+            , m_nBaseInterval(0)
+            , m_nInterval(0)
+            , m_nFailures(0)
+            , m_nIdleLevel(0)
+        {
+        }
+
+        QTimer* m_pTimer;
+        int m_nBaseInterval;
+        int m_nInterval;
+        int m_nFailures;
+        int m_nIdleLevel;
+    };
+
+    bool isHidden() const;
+    bool isIdle() const;
+    bool isInteracting() const;
+    int computeInterval(const Schedule& schedule) const;
+    void reschedule(Schedule& schedule, bool bKeepEarlierTimeout);
+    void onUserInteraction();
+
+private:
+    QWidget* m_pWindow;
+    Schedule m_schedules[KindsCount];
+    QElapsedTimer m_lastInteraction;
+    bool m_bInteracting;
+    QTimer* m_pResumeTimer;
+    bool m_bBackgroundPaused;
+};
+
+#endif // REFRESHSCHEDULER_H
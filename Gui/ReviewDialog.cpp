@@ -0,0 +1,146 @@
+#include "ReviewDialog.h"
+#include "ui_ReviewDialog.h"
+
+#include "Gui/DiffViewDialog.h"
+
+#include <QHeaderView>
+#include <QTableWidgetItem>
+
+ReviewDialog::ReviewDialog(std::shared_ptr<ReviewSession> spSession, const QString& title, QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::ReviewDialog),
+    m_spSession(spSession),
+    m_pDiffView(nullptr),
+    m_nShownFile(-1)
+{
+    ui->setupUi(this);
+
+    setWindowTitle(QString("Review of %1").arg(describeRevisions(m_spSession->getRevisions())));
+    ui->labelTitle->setText(title);
+
+    ui->tableFiles->setColumnCount(2);
+    ui->tableFiles->setHorizontalHeaderLabels(QStringList() << "" << "Path");
+    ui->tableFiles->verticalHeader()->setVisible(false);
+    ui->tableFiles->horizontalHeader()->setStretchLastSection(true);
+    ui->tableFiles->setRowCount(m_spSession->getFilesCount());
+    for(int i = 0; i < m_spSession->getFilesCount(); i++)
+    {
+        ReviewSession::File file = m_spSession->getFile(i);
+        ui->tableFiles->setItem(i, 0, new QTableWidgetItem(QString::fromStdString(file.m_status)));
+        ui->tableFiles->setItem(i, 1, new QTableWidgetItem(QString::fromStdString(file.m_relativePath)));
+        updateFileRow(i);
+    }
+    ui->tableFiles->resizeColumnToContents(0);
+    ui->splitter->setSizes(QList<int>() << 300 << 900);
+
+    connect(ui->tableFiles->selectionModel(), SIGNAL(selectionChanged(QItemSelection,QItemSelection)), this, SLOT(on_files_selection_changed()));
+
+    updateStats();
+    if(m_spSession->getFilesCount())
+    {
+        ui->tableFiles->selectRow(0);
+    }
+}
+
+ReviewDialog::~ReviewDialog()
+{
+    m_spSession->stop();
+    delete ui;
+}
+
+void ReviewDialog::onFileStaged(int nIndex)
+{
+    updateFileRow(nIndex);
+    updateStats();
+    if(nIndex == m_nShownFile)
+    {
+        showFile(nIndex);
+    }
+}
+
+void ReviewDialog::onCompleted()
+{
+    updateStats();
+}
+
+void ReviewDialog::updateFileRow(int nIndex)
+{
+    //files still being fetched are greyed out
+    ReviewSession::File file = m_spSession->getFile(nIndex);
+    for(int nColumn = 0; nColumn < 2; nColumn++)
+    {
+        QTableWidgetItem* pItem = ui->tableFiles->item(nIndex, nColumn);
+        pItem->setForeground(file.m_state == ReviewSession::Staged ? palette().color(QPalette::Text) : palette().color(QPalette::Disabled, QPalette::Text));
+        pItem->setToolTip(file.m_state == ReviewSession::Failed ? QString("No text before or after the revision (a directory?)") : QString::fromStdString(file.m_url));
+    }
+}
+
+void ReviewDialog::updateStats()
+{
+    int nStaged = m_spSession->getStagedFilesCount();
+    ui->labelStats->setText(nStaged == m_spSession->getFilesCount()
+                            ? QString("%1 files").arg(nStaged)
+                            : QString("Fetched %1 of %2 files...").arg(nStaged).arg(m_spSession->getFilesCount()));
+}
+
+void ReviewDialog::showFile(int nIndex)
+{
+    m_nShownFile = nIndex;
+    ui->previousButton->setEnabled(nIndex > 0);
+    ui->nextButton->setEnabled(nIndex + 1 < m_spSession->getFilesCount());
+
+    ReviewSession::File file = m_spSession->getFile(nIndex);
+    if(file.m_state == ReviewSession::Pending || file.m_state == ReviewSession::Staging)
+    {
+        //shown by onFileStaged once it is there
+        m_spSession->prioritize(nIndex);
+        return;
+    }
+
+    delete m_pDiffView;
+    m_pDiffView = new DiffViewDialog(QString::fromStdString(file.m_relativePath), m_spSession->getLastRevision(), ui->diffContainer);
+    m_pDiffView->setEmbedded();
+    ui->diffLayout->addWidget(m_pDiffView);
+    m_pDiffView->show();
+    m_pDiffView->setDiff(m_spSession->loadDiff(nIndex));
+}
+
+QString ReviewDialog::describeRevisions(const std::set<int>& revisions)
+{
+    if(revisions.size() == 1)
+    {
+        return QString("revision %1").arg(*revisions.begin());
+    }
+
+    return QString("%1 revisions, %2 to %3").arg(revisions.size()).arg(*revisions.begin()).arg(*revisions.rbegin());
+}
+
+void ReviewDialog::on_files_selection_changed()
+{
+    QModelIndexList selected = ui->tableFiles->selectionModel()->selectedRows();
+    if(!selected.isEmpty())
+    {
+        showFile(selected.first().row());
+    }
+}
+
+void ReviewDialog::on_closeButton_clicked()
+{
+    close();
+}
+
+void ReviewDialog::on_previousButton_clicked()
+{
+    if(m_nShownFile > 0)
+    {
+        ui->tableFiles->selectRow(m_nShownFile - 1);
+    }
+}
+
+void ReviewDialog::on_nextButton_clicked()
+{
+    if(m_nShownFile + 1 < m_spSession->getFilesCount())
+    {
+        ui->tableFiles->selectRow(m_nShownFile + 1);
+    }
+}
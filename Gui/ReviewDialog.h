@@ -0,0 +1,51 @@
+#ifndef REVIEWDIALOG_H
+#define REVIEWDIALOG_H
+
+#include <QDialog>
+
+#include "Repos/SVN/ReviewSession.h"
+
+#include <memory>
+
+namespace Ui {
+class ReviewDialog;
+}
+
+class DiffViewDialog;
+
+//every file changed in one or more revisions, one after the other; the files are staged in the background by a
+//ReviewSession, the one selected is fetched first
+class ReviewDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    ReviewDialog(std::shared_ptr<ReviewSession> spSession, const QString& title, QWidget *parent = 0);
+    ~ReviewDialog();
+
+    std::shared_ptr<ReviewSession> getSession() const { return m_spSession; }
+    //"revision 12", or "3 revisions, 10 to 14"
+    static QString describeRevisions(const std::set<int>& revisions);
+
+    void onFileStaged(int nIndex);
+    void onCompleted();
+
+private slots:
+    void on_closeButton_clicked();
+    void on_previousButton_clicked();
+    void on_nextButton_clicked();
+    void on_files_selection_changed();
+
+private:
+    void updateFileRow(int nIndex);
+    void updateStats();
+    void showFile(int nIndex);
+
+private:
+    Ui::ReviewDialog *ui;
+    std::shared_ptr<ReviewSession> m_spSession;
+    DiffViewDialog* m_pDiffView;
+    int m_nShownFile;
+};
+
+#endif // REVIEWDIALOG_H
@@ -0,0 +1,375 @@
+#include "FileRevisionCache.h"
+
+#include "Settings/AppSettings.h"
+#include "Logger/Logger.h"
+
+#include <QByteArray>
+#include <QCryptographicHash>
+
+#include <sys/stat.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <algorithm>
+
+static const int SAVE_INDEX_AFTER_HITS = 32;
+//the journal is rewritten once it holds this many lines per live entry, and never below MIN_INDEX_LINES
+static const size_t COMPACT_INDEX_RATIO = 2;
+static const size_t MIN_INDEX_LINES = 1024;
+
+FileRevisionCache::FileRevisionCache()
+    : m_nAccessCounter(0)
+    , m_nStoredBytes(0)
+    , m_nHits(0)
+    , m_nMisses(0)
+    , m_nUnsavedHits(0)
+    , m_nIndexLines(0)
+{
+    m_path = AppSettings::instance()->getSettingsPath() + "Cache/";
+    mkdir(m_path.c_str(), 0755);
+    mkdir((m_path + "objects/").c_str(), 0755);
+
+    m_nSizeLimit = static_cast<size_t>(AppSettings::instance()->getIntValue("cacheSizeMB", 256)) * 1024 * 1024;
+    loadIndex();
+}
+
+FileRevisionCache* FileRevisionCache::instance()
+{
+    static FileRevisionCache* cache = new FileRevisionCache();
+    return cache;
+}
+
+bool FileRevisionCache::get(const std::string& key, std::string& content)
+{
+    std::string hash;
+    {
+        std::unique_lock<std::mutex> locker(m_mutex);
+        std::map<std::string, std::string>::const_iterator keyIt = m_keys.find(key);
+        if(keyIt == m_keys.end())
+        {
+            m_nMisses++;
+            return false;
+        }
+        hash = keyIt->second;
+    }
+
+    //read and uncompressed without the lock, the other fetch threads use the cache meanwhile
+    std::ifstream file(getObjectPath(hash).c_str(), std::ios_base::in | std::ios_base::binary);
+    std::stringstream ss;
+    ss << file.rdbuf();
+    const std::string stored = ss.str();
+    QByteArray data = qUncompress(reinterpret_cast<const uchar*>(stored.data()), static_cast<int>(stored.size()));
+    //qCompress prefixes the uncompressed size, an empty result is only right for an empty file
+    bool bEmptyContent = stored.size() >= 4 && !stored[0] && !stored[1] && !stored[2] && !stored[3];
+    if(!file || (data.isEmpty() && !bEmptyContent))
+    {
+        //deleted or damaged on disk: forget it, the caller fetches the content again
+        Logger::instance()->logCommandMessage(std::string("File cache: dropping unreadable ") + hash);
+        std::unique_lock<std::mutex> locker(m_mutex);
+        removeObject(hash);
+        m_nMisses++;
+        return false;
+    }
+
+    content.assign(data.constData(), data.size());
+
+    std::unique_lock<std::mutex> locker(m_mutex);
+    Objects::iterator objectIt = m_objects.find(hash);
+    if(objectIt != m_objects.end())
+    {
+        touch(objectIt);
+        m_unsavedAccesses.insert(hash);
+    }
+    m_nHits++;
+    if(++m_nUnsavedHits >= SAVE_INDEX_AFTER_HITS)
+    {
+        saveAccesses();
+    }
+    return true;
+}
+
+void FileRevisionCache::put(const std::string& key, const std::string& content)
+{
+    const std::string hash = QCryptographicHash::hash(QByteArray::fromRawData(content.data(), static_cast<int>(content.size())),
+                                                      QCryptographicHash::Sha1).toHex().constData();
+
+    {
+        std::unique_lock<std::mutex> locker(m_mutex);
+        Objects::iterator objectIt = m_objects.find(hash);
+        if(objectIt != m_objects.end())
+        {
+            //the same content under another key, nothing to write
+            touch(objectIt);
+            setKey(key, hash);
+            appendToIndex(getObjectLine(objectIt) + getKeyLine(key, hash));
+            return;
+        }
+    }
+
+    //compressed and written without the lock; threads storing the same content write identical files.
+    //Written aside and renamed, a reader never sees half an object
+    QByteArray compressed = qCompress(reinterpret_cast<const uchar*>(content.data()), static_cast<int>(content.size()));
+    const std::string objectPath = getObjectPath(hash);
+    std::stringstream tempPath;
+    tempPath << objectPath << ".tmp" << std::this_thread::get_id();
+    {
+        std::ofstream file(tempPath.str().c_str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+        file.write(compressed.constData(), compressed.size());
+        if(!file)
+        {
+            remove(tempPath.str().c_str());
+            return;
+        }
+    }
+
+    if(rename(tempPath.str().c_str(), objectPath.c_str()) != 0)
+    {
+        remove(tempPath.str().c_str());
+        return;
+    }
+
+    std::unique_lock<std::mutex> locker(m_mutex);
+    Objects::iterator objectIt = m_objects.find(hash);
+    if(objectIt == m_objects.end())
+    {
+        Object object;
+        object.m_nStoredBytes = compressed.size();
+        objectIt = m_objects.insert(std::make_pair(hash, object)).first;
+        m_nStoredBytes += object.m_nStoredBytes;
+    }
+
+    touch(objectIt);
+    setKey(key, hash);
+    appendToIndex(getObjectLine(objectIt) + getKeyLine(key, hash));
+    evict();
+}
+
+FileRevisionCacheStats FileRevisionCache::getStats() const
+{
+    std::unique_lock<std::mutex> locker(m_mutex);
+    FileRevisionCacheStats stats;
+    stats.m_nHits = m_nHits;
+    stats.m_nMisses = m_nMisses;
+    stats.m_nKeys = m_keys.size();
+    stats.m_nObjects = m_objects.size();
+    stats.m_nStoredBytes = m_nStoredBytes;
+    stats.m_nSizeLimit = m_nSizeLimit;
+    return stats;
+}
+
+void FileRevisionCache::setSizeLimit(size_t nBytes)
+{
+    std::unique_lock<std::mutex> locker(m_mutex);
+    m_nSizeLimit = nBytes;
+    evict();
+}
+
+std::string FileRevisionCache::getObjectPath(const std::string& hash) const
+{
+    return m_path + "objects/" + hash;
+}
+
+void FileRevisionCache::loadIndex()
+{
+    //"object <hash> <stored bytes> <last access>", "key <hash> <key>" and "drop <hash>" lines, a later line
+    //about an object or a key replaces the earlier ones
+    std::ifstream index((m_path + "index").c_str(), std::ios_base::in);
+    std::string line;
+    bool bTornLine = false;
+    while(getline(index, line, '\n'))
+    {
+        //the last line of an interrupted append has no end of line
+        if(index.eof())
+        {
+            bTornLine = true;
+            break;
+        }
+
+        m_nIndexLines++;
+        std::stringstream ss(line);
+        std::string type, hash;
+        ss >> type >> hash;
+        if(type == "object")
+        {
+            Object object;
+            ss >> object.m_nStoredBytes >> object.m_nLastAccess;
+            Objects::iterator objectIt = m_objects.find(hash);
+            if(objectIt == m_objects.end())
+            {
+                objectIt = m_objects.insert(std::make_pair(hash, object)).first;
+            }
+            else
+            {
+                m_nStoredBytes -= objectIt->second.m_nStoredBytes;
+                objectIt->second.m_nStoredBytes = object.m_nStoredBytes;
+                objectIt->second.m_nLastAccess = object.m_nLastAccess;
+            }
+            m_nStoredBytes += object.m_nStoredBytes;
+            m_nAccessCounter = std::max(m_nAccessCounter, object.m_nLastAccess);
+        }
+        else
+        if(type == "key" && m_objects.count(hash) && line.length() > 5 + hash.length())
+        {
+            setKey(line.substr(5 + hash.length()), hash);
+        }
+        else
+        if(type == "drop")
+        {
+            forgetObject(hash);
+        }
+    }
+
+    for(const std::pair<const std::string, Object>& object : m_objects)
+    {
+        m_byAccess.insert(std::make_pair(object.second.m_nLastAccess, object.first));
+    }
+
+    //appending after a torn line would join the two
+    if(bTornLine || m_nIndexLines > std::max(MIN_INDEX_LINES, COMPACT_INDEX_RATIO * (m_objects.size() + m_keys.size())))
+    {
+        saveIndex();
+    }
+}
+
+void FileRevisionCache::saveIndex()
+{
+    m_nUnsavedHits = 0;
+    m_unsavedAccesses.clear();
+
+    const std::string indexPath = m_path + "index";
+    const std::string tempPath = indexPath + ".tmp";
+    {
+        std::ofstream index(tempPath.c_str(), std::ios_base::out | std::ios_base::trunc);
+        for(Objects::const_iterator objectIt = m_objects.begin(); objectIt != m_objects.end(); ++objectIt)
+        {
+            index << getObjectLine(objectIt);
+        }
+
+        for(const std::pair<const std::string, std::string>& key : m_keys)
+        {
+            index << getKeyLine(key.first, key.second);
+        }
+
+        if(!index)
+        {
+            return;
+        }
+    }
+
+    if(rename(tempPath.c_str(), indexPath.c_str()) == 0)
+    {
+        m_nIndexLines = m_objects.size() + m_keys.size();
+    }
+}
+
+void FileRevisionCache::appendToIndex(const std::string& lines)
+{
+    m_nIndexLines += std::count(lines.begin(), lines.end(), '\n');
+    if(m_nIndexLines > std::max(MIN_INDEX_LINES, COMPACT_INDEX_RATIO * (m_objects.size() + m_keys.size())))
+    {
+        saveIndex();
+        return;
+    }
+
+    std::ofstream index((m_path + "index").c_str(), std::ios_base::out | std::ios_base::app);
+    index << lines;
+}
+
+void FileRevisionCache::saveAccesses()
+{
+    m_nUnsavedHits = 0;
+
+    std::string lines;
+    for(const std::string& hash : m_unsavedAccesses)
+    {
+        Objects::const_iterator objectIt = m_objects.find(hash);
+        if(objectIt != m_objects.end())
+        {
+            lines += getObjectLine(objectIt);
+        }
+    }
+    m_unsavedAccesses.clear();
+
+    if(!lines.empty())
+    {
+        appendToIndex(lines);
+    }
+}
+
+std::string FileRevisionCache::getObjectLine(const Objects::const_iterator& objectIt)
+{
+    std::stringstream ss;
+    ss << "object " << objectIt->first << " " << objectIt->second.m_nStoredBytes << " " << objectIt->second.m_nLastAccess << "\n";
+    return ss.str();
+}
+
+std::string FileRevisionCache::getKeyLine(const std::string& key, const std::string& hash)
+{
+    return "key " + hash + " " + key + "\n";
+}
+
+void FileRevisionCache::touch(const Objects::iterator& objectIt)
+{
+    m_byAccess.erase(std::make_pair(objectIt->second.m_nLastAccess, objectIt->first));
+    objectIt->second.m_nLastAccess = ++m_nAccessCounter;
+    m_byAccess.insert(std::make_pair(objectIt->second.m_nLastAccess, objectIt->first));
+}
+
+void FileRevisionCache::setKey(const std::string& key, const std::string& hash)
+{
+    std::string& current = m_keys[key];
+    if(current == hash)
+    {
+        return;
+    }
+
+    Objects::iterator previousIt = m_objects.find(current);
+    if(previousIt != m_objects.end())
+    {
+        previousIt->second.m_keys.erase(key);
+    }
+
+    current = hash;
+    m_objects[hash].m_keys.insert(key);
+}
+
+void FileRevisionCache::forgetObject(const std::string& hash)
+{
+    Objects::iterator objectIt = m_objects.find(hash);
+    if(objectIt == m_objects.end())
+    {
+        return;
+    }
+
+    for(const std::string& key : objectIt->second.m_keys)
+    {
+        m_keys.erase(key);
+    }
+
+    m_byAccess.erase(std::make_pair(objectIt->second.m_nLastAccess, objectIt->first));
+    m_unsavedAccesses.erase(hash);
+    m_nStoredBytes -= objectIt->second.m_nStoredBytes;
+    m_objects.erase(objectIt);
+}
+
+void FileRevisionCache::removeObject(const std::string& hash)
+{
+    if(!m_objects.count(hash))
+    {
+        return;
+    }
+
+    forgetObject(hash);
+    remove(getObjectPath(hash).c_str());
+    appendToIndex("drop " + hash + "\n");
+}
+
+void FileRevisionCache::evict()
+{
+    while(m_nStoredBytes > m_nSizeLimit && !m_byAccess.empty())
+    {
+        const std::string hash = m_byAccess.begin()->second;
+        removeObject(hash);
+    }
+}
@@ -0,0 +1,101 @@
+#ifndef FILEREVISIONCACHE_H
+#define FILEREVISIONCACHE_H
+
+#include <string>
+#include <map>
+#include <set>
+#include <mutex>
+
+struct FileRevisionCacheStats
+{
+    FileRevisionCacheStats()
+        : m_nHits(0)
+        , m_nMisses(0)
+        , m_nKeys(0)
+        , m_nObjects(0)
+        , m_nStoredBytes(0)
+        , m_nSizeLimit(0)
+    {
+    }
+
+    double getHitRate() const
+    {
+        return m_nHits + m_nMisses ? static_cast<double>(m_nHits) / (m_nHits + m_nMisses) : 0;
+    }
+
+    int m_nHits;
+    int m_nMisses;
+    size_t m_nKeys;
+    size_t m_nObjects;
+    size_t m_nStoredBytes;
+    size_t m_nSizeLimit;
+};
+
+//contents of files at given revisions, shared by everything running "svn cat". Keys look like
+//"<repository uuid>:<path in the repository>@<revision>"; every distinct content is stored once, compressed,
+//under <settings path>/Cache/ and named by its SHA-1. Above the size cap the least recently used contents go.
+//Contents are compressed, written and read outside the lock; the index is a journal the changes are appended to,
+//rewritten whole once it is mostly outdated lines.
+class FileRevisionCache
+{
+private:
+    FileRevisionCache();
+
+public:
+    static FileRevisionCache* instance();
+
+    bool get(const std::string& key, std::string& content);
+    void put(const std::string& key, const std::string& content);
+
+    FileRevisionCacheStats getStats() const;
+    void setSizeLimit(size_t nBytes);
+
+private:
+    struct Object
+    {
+        Object()
+            : m_nStoredBytes(0)
+            , m_nLastAccess(0)
+        {
+        }
+
+        size_t m_nStoredBytes;
+        unsigned long long m_nLastAccess;
+        //the keys naming this content, they go with it
+        std::set<std::string> m_keys;
+    };
+    typedef std::map<std::string, Object> Objects;
+
+    std::string getObjectPath(const std::string& hash) const;
+    void loadIndex();
+    void saveIndex();
+    void appendToIndex(const std::string& lines);
+    void saveAccesses();
+    static std::string getObjectLine(const Objects::const_iterator& objectIt);
+    static std::string getKeyLine(const std::string& key, const std::string& hash);
+    void touch(const Objects::iterator& objectIt);
+    void setKey(const std::string& key, const std::string& hash);
+    //forgetObject only drops it from memory, removeObject also from disk and from the index
+    void forgetObject(const std::string& hash);
+    void removeObject(const std::string& hash);
+    void evict();
+
+private:
+    mutable std::mutex m_mutex;
+    std::string m_path;
+    //key -> content hash, content hash -> stored object, least recently used object first
+    std::map<std::string, std::string> m_keys;
+    Objects m_objects;
+    std::set<std::pair<unsigned long long, std::string> > m_byAccess;
+    unsigned long long m_nAccessCounter;
+    size_t m_nStoredBytes;
+    size_t m_nSizeLimit;
+    int m_nHits;
+    int m_nMisses;
+    //hits only reorder the LRU, the index is written after a few of them
+    int m_nUnsavedHits;
+    std::set<std::string> m_unsavedAccesses;
+    size_t m_nIndexLines;
+};
+
+#endif // FILEREVISIONCACHE_H
@@ -0,0 +1,250 @@
+#include "Repos/SVN/HistorySearch.h"
+#include "Repos/SVN/SvnCommands.h"
+
+#include <thread>
+#include <sstream>
+#include <cstring>
+#include <climits>
+#include <map>
+
+HistorySearch::HistorySearch(int nId, const std::string& pattern, bool bRegex, bool bStopAtIntroduction, const std::string& repoUrl,
+                             const std::vector<Revision>& revisions, std::function<std::string(const std::string&)> cacheKeyOf,
+                             HistorySearchObserver* pObserver)
+    : m_nId(nId)
+    , m_pattern(pattern)
+    , m_bRegex(bRegex)
+    , m_bStopAtIntroduction(bStopAtIntroduction)
+    , m_repoUrl(repoUrl)
+    , m_revisions(revisions)
+    , m_cacheKeyOf(cacheKeyOf)
+    , m_pObserver(pObserver)
+    , m_nNextRevision(0)
+    , m_nScannedRevisions(0)
+    , m_nIntroducedAt(INT_MAX)
+    , m_nRunningThreads(0)
+    , m_bStopped(false)
+{
+    if(m_pattern.empty())
+    {
+        m_error = "Nothing to search for.";
+        return;
+    }
+
+    if(m_bRegex)
+    {
+        try
+        {
+            m_regex.assign(m_pattern, std::regex::ECMAScript | std::regex::optimize);
+        }
+        catch(const std::regex_error& error)
+        {
+            m_error = std::string("Invalid regular expression: ") + error.what();
+        }
+    }
+}
+
+void HistorySearch::start(int nThreads)
+{
+    std::unique_lock<std::mutex> locker(m_mutex);
+    if(!m_error.empty() || m_revisions.empty())
+    {
+        locker.unlock();
+        m_pObserver->onHistorySearchCompleted(m_nId);
+        return;
+    }
+
+    for(int i = 0; i < nThreads && i < static_cast<int>(m_revisions.size()); i++)
+    {
+        m_nRunningThreads++;
+        std::shared_ptr<HistorySearch> spSelf = shared_from_this();
+        std::thread([spSelf]() { spSelf->run(); }).detach();
+    }
+}
+
+void HistorySearch::stop()
+{
+    std::unique_lock<std::mutex> locker(m_mutex);
+    m_bStopped = true;
+}
+
+void HistorySearch::findMatchingLines(const std::string& content, std::vector<std::pair<int, std::string> >& lines) const
+{
+    const char* pBegin = content.data();
+    const char* pEnd = pBegin + content.size();
+    const char* pLineStart = pBegin;
+    int nLine = 1;
+
+    if(m_bRegex)
+    {
+        while(pLineStart < pEnd)
+        {
+            const char* pLineEnd = static_cast<const char*>(memchr(pLineStart, '\n', pEnd - pLineStart));
+            if(!pLineEnd)
+                pLineEnd = pEnd;
+
+            if(std::regex_search(pLineStart, pLineEnd, m_regex))
+            {
+                lines.push_back(std::make_pair(nLine, std::string(pLineStart, pLineEnd)));
+            }
+
+            pLineStart = pLineEnd + 1;
+            nLine++;
+        }
+        return;
+    }
+
+    //memmem scans for the pattern over the whole content, lines are only counted up to each hit
+    const char* pCounted = pBegin;
+    const char* pPos = pBegin;
+    while(pPos < pEnd)
+    {
+        const char* pHit = static_cast<const char*>(memmem(pPos, pEnd - pPos, m_pattern.data(), m_pattern.size()));
+        if(!pHit)
+            break;
+
+        for(const char* pNewLine = pCounted; (pNewLine = static_cast<const char*>(memchr(pNewLine, '\n', pHit - pNewLine))); pNewLine++)
+        {
+            nLine++;
+            pLineStart = pNewLine + 1;
+        }
+
+        const char* pLineEnd = static_cast<const char*>(memchr(pHit, '\n', pEnd - pHit));
+        if(!pLineEnd)
+            pLineEnd = pEnd;
+
+        lines.push_back(std::make_pair(nLine, std::string(pLineStart, pLineEnd)));
+        pCounted = pPos = pLineEnd;
+    }
+}
+
+void HistorySearch::run()
+{
+    while(true)
+    {
+        size_t nIndex = 0;
+        {
+            std::unique_lock<std::mutex> locker(m_mutex);
+            if(m_nNextRevision >= m_revisions.size() || m_bStopped
+               || (m_bStopAtIntroduction && m_revisions[m_nNextRevision].m_nRevision > m_nIntroducedAt))
+            {
+                bool bLast = --m_nRunningThreads == 0 && !m_bStopped;
+                locker.unlock();
+                if(bLast)
+                {
+                    m_pObserver->onHistorySearchCompleted(m_nId);
+                }
+                return;
+            }
+
+            nIndex = m_nNextRevision++;
+        }
+
+        scan(m_revisions[nIndex]);
+
+        std::unique_lock<std::mutex> locker(m_mutex);
+        int nScanned = ++m_nScannedRevisions;
+        if(m_bStopped)
+        {
+            continue;
+        }
+        locker.unlock();
+
+        m_pObserver->onHistorySearchProgress(m_nId, nScanned);
+    }
+}
+
+bool HistorySearch::isCancelled(int nRevision) const
+{
+    std::unique_lock<std::mutex> locker(m_mutex);
+    return m_bStopped || (m_bStopAtIntroduction && nRevision > m_nIntroducedAt);
+}
+
+void HistorySearch::scan(const Revision& revision)
+{
+    std::list<std::string> affectedItems = revision.m_AffectedItems;
+    if(affectedItems.empty())
+    {
+        DiffSvnCommand command(m_repoUrl, revision.m_nRevision);
+        if(command.execute())
+        {
+            affectedItems = command.getAffectedItems();
+        }
+    }
+
+    std::stringstream ssBefore, ssAfter;
+    ssBefore << revision.m_nRevision - 1;
+    ssAfter << revision.m_nRevision;
+
+    for(const std::string& item : affectedItems)
+    {
+        size_t nUrl = item.find_first_not_of(' ', 1);
+        if(item.empty() || nUrl == std::string::npos)
+        {
+            continue;
+        }
+
+        if(isCancelled(revision.m_nRevision))
+        {
+            return;
+        }
+
+        //an added file has no before, a deleted one no after; svn cat fails on a directory
+        const std::string url = item.substr(nUrl);
+        const std::string cacheKey = m_cacheKeyOf(url);
+        std::string before, after;
+        bool bBefore = item[0] != 'A' && revision.m_nRevision > 1 && SvnCommand::catFile(url, ssBefore.str(), cacheKey, before);
+        bool bAfter = item[0] != 'D' && SvnCommand::catFile(url, ssAfter.str(), cacheKey, after);
+        if(!bBefore && !bAfter)
+        {
+            continue;
+        }
+
+        std::vector<std::pair<int, std::string> > beforeLines, afterLines;
+        findMatchingLines(before, beforeLines);
+        findMatchingLines(after, afterLines);
+        if(beforeLines.size() == afterLines.size())
+        {
+            continue;
+        }
+
+        //the first line of the side with more matches that the other side does not have
+        bool bAdded = afterLines.size() > beforeLines.size();
+        const std::vector<std::pair<int, std::string> >& more = bAdded ? afterLines : beforeLines;
+        const std::vector<std::pair<int, std::string> >& fewer = bAdded ? beforeLines : afterLines;
+        std::map<std::string, int> otherLines;
+        for(const std::pair<int, std::string>& line : fewer)
+        {
+            otherLines[line.second]++;
+        }
+
+        std::pair<int, std::string> reported = more.front();
+        for(const std::pair<int, std::string>& line : more)
+        {
+            if(otherLines[line.second]-- <= 0)
+            {
+                reported = line;
+                break;
+            }
+        }
+
+        if(!reported.second.empty() && reported.second[reported.second.length() - 1] == '\r')
+        {
+            reported.second.erase(reported.second.length() - 1);
+        }
+
+        {
+            std::unique_lock<std::mutex> locker(m_mutex);
+            if(m_bStopped)
+            {
+                return;
+            }
+
+            if(bAdded && beforeLines.empty() && revision.m_nRevision < m_nIntroducedAt)
+            {
+                m_nIntroducedAt = revision.m_nRevision;
+            }
+        }
+
+        m_pObserver->onHistorySearchMatch(m_nId, revision.m_nRevision, url, bAdded, reported.first, reported.second);
+    }
+}
@@ -0,0 +1,87 @@
+#ifndef HISTORYSEARCH_H
+#define HISTORYSEARCH_H
+
+#include <string>
+#include <vector>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <regex>
+#include <functional>
+
+class HistorySearchObserver
+{
+public:
+    //called from the search threads: every match as soon as it is found, the count of scanned revisions after each one
+    virtual void onHistorySearchProgress(int nSearchId, int nScannedRevisions) = 0;
+    virtual void onHistorySearchMatch(int nSearchId, int nRevision, const std::string& url, bool bAdded, int nLine,
+                                      const std::string& line) = 0;
+    virtual void onHistorySearchCompleted(int nSearchId) = 0;
+};
+
+//finds the revisions whose changed files gained or lost lines containing a text (or matching a regular
+//expression), comparing every changed file before and after the revision. Revisions are scanned oldest first by
+//several threads; the contents come from the file revision cache. When asked to, no revision after the first one
+//that introduced the text is started.
+class HistorySearch : public std::enable_shared_from_this<HistorySearch>
+{
+public:
+    struct Revision
+    {
+        Revision()
+            : m_nRevision(-1)
+        {
+        }
+
+        int m_nRevision;
+        //"M       <url>" lines of svn diff --summarize, fetched by the search when empty
+        std::list<std::string> m_AffectedItems;
+    };
+
+    //cacheKeyOf maps an url to its file revision cache key, without the revision
+    HistorySearch(int nId, const std::string& pattern, bool bRegex, bool bStopAtIntroduction, const std::string& repoUrl,
+                  const std::vector<Revision>& revisions, std::function<std::string(const std::string&)> cacheKeyOf,
+                  HistorySearchObserver* pObserver);
+
+    //empty when the pattern is usable
+    const std::string& getError() const { return m_error; }
+
+    //the search threads keep the search alive until they are done
+    void start(int nThreads);
+    //running revisions finish, nothing new is started and the observer is not called any more
+    void stop();
+
+    int getId() const { return m_nId; }
+    int getRevisionsCount() const { return static_cast<int>(m_revisions.size()); }
+    const std::string& getPattern() const { return m_pattern; }
+
+    //lines of content containing the pattern, as 1-based line number and text
+    void findMatchingLines(const std::string& content, std::vector<std::pair<int, std::string> >& lines) const;
+
+private:
+    void run();
+    void scan(const Revision& revision);
+    bool isCancelled(int nRevision) const;
+
+private:
+    const int m_nId;
+    const std::string m_pattern;
+    const bool m_bRegex;
+    const bool m_bStopAtIntroduction;
+    const std::string m_repoUrl;
+    const std::vector<Revision> m_revisions;
+    std::function<std::string(const std::string&)> m_cacheKeyOf;
+    HistorySearchObserver* m_pObserver;
+    std::regex m_regex;
+    std::string m_error;
+
+    mutable std::mutex m_mutex;
+    size_t m_nNextRevision;
+    int m_nScannedRevisions;
+    //the oldest revision found introducing the text, newer ones are not scanned
+    int m_nIntroducedAt;
+    int m_nRunningThreads;
+    bool m_bStopped;
+};
+
+#endif // HISTORYSEARCH_H
@@ -0,0 +1,255 @@
+#include "Repos/SVN/PristineStore.h"
+#include "Logger/Logger.h"
+
+#include <sqlite3.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+
+//the deepest layer of a file is what its working text is compared with: BASE, or the copy source of a copy
+static const char* PRISTINE_QUERY =
+        "SELECT nodes.checksum, nodes.properties, pristine.size, pristine.compression "
+        "FROM nodes LEFT JOIN pristine ON pristine.checksum = nodes.checksum "
+        "WHERE nodes.local_relpath = ?1 AND nodes.presence = 'normal' AND nodes.kind = 'file' "
+        "ORDER BY nodes.op_depth DESC LIMIT 1";
+
+static std::string getRealPath(const std::string& path)
+{
+    char resolved[PATH_MAX];
+    if(!realpath(path.c_str(), resolved))
+    {
+        return std::string();
+    }
+
+    return resolved;
+}
+
+PristineStore::PristineStore()
+    : m_pDatabase(nullptr)
+    , m_pStatement(nullptr)
+{
+}
+
+PristineStore::~PristineStore()
+{
+    close();
+}
+
+bool PristineStore::open(const std::string& path)
+{
+    std::unique_lock<std::mutex> locker(m_mutex);
+    if(m_pStatement)
+    {
+        sqlite3_finalize(m_pStatement);
+        m_pStatement = nullptr;
+    }
+    if(m_pDatabase)
+    {
+        sqlite3_close(m_pDatabase);
+        m_pDatabase = nullptr;
+    }
+
+    //since 1.7 only the root of a working copy has a .svn directory
+    std::string rootPath = getRealPath(path);
+    struct stat info;
+    while(!rootPath.empty() && stat((rootPath + "/.svn/wc.db").c_str(), &info) != 0)
+    {
+        size_t nSlash = rootPath.rfind('/');
+        rootPath = (nSlash == std::string::npos || rootPath == "/") ? std::string() : rootPath.substr(0, nSlash ? nSlash : 1);
+    }
+
+    if(rootPath.empty())
+    {
+        return false;
+    }
+
+    if(sqlite3_open_v2((rootPath + "/.svn/wc.db").c_str(), &m_pDatabase, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK
+            || sqlite3_prepare_v2(m_pDatabase, PRISTINE_QUERY, -1, &m_pStatement, nullptr) != SQLITE_OK)
+    {
+        Logger::instance()->logCommandMessage("Pristine store unavailable for " + rootPath + ": "
+                                              + (m_pDatabase ? sqlite3_errmsg(m_pDatabase) : "out of memory"));
+        sqlite3_close(m_pDatabase);
+        m_pDatabase = nullptr;
+        return false;
+    }
+
+    //svn may hold the database while it writes
+    sqlite3_busy_timeout(m_pDatabase, 1000);
+    m_rootPath = rootPath == "/" ? std::string() : rootPath;
+    return true;
+}
+
+void PristineStore::close()
+{
+    std::unique_lock<std::mutex> locker(m_mutex);
+    if(m_pStatement)
+    {
+        sqlite3_finalize(m_pStatement);
+        m_pStatement = nullptr;
+    }
+
+    if(m_pDatabase)
+    {
+        sqlite3_close(m_pDatabase);
+        m_pDatabase = nullptr;
+    }
+}
+
+bool PristineStore::readBase(const std::string& path, std::string& content)
+{
+    std::string realPath = getRealPath(path);
+
+    std::unique_lock<std::mutex> locker(m_mutex);
+    if(!m_pStatement || realPath.compare(0, m_rootPath.length() + 1, m_rootPath + "/") != 0)
+    {
+        return false;
+    }
+
+    std::string checksum;
+    long long nSize = 0;
+    if(!findPristine(realPath.substr(m_rootPath.length() + 1), checksum, nSize))
+    {
+        return false;
+    }
+
+    std::string pristinePath = m_rootPath + "/.svn/pristine/" + checksum.substr(0, 2) + "/" + checksum + ".svn-base";
+    int nFile = ::open(pristinePath.c_str(), O_RDONLY | O_CLOEXEC);
+    if(nFile < 0)
+    {
+        return false;
+    }
+
+    struct stat info;
+    if(fstat(nFile, &info) != 0 || info.st_size != nSize)
+    {
+        ::close(nFile);
+        return false;
+    }
+
+    if(nSize == 0)
+    {
+        ::close(nFile);
+        content.clear();
+        return true;
+    }
+
+    //pristines are never modified in place, the mapping is copied once into the diff input
+    void* pData = mmap(nullptr, static_cast<size_t>(nSize), PROT_READ, MAP_PRIVATE, nFile, 0);
+    ::close(nFile);
+    if(pData == MAP_FAILED)
+    {
+        return false;
+    }
+
+    madvise(pData, static_cast<size_t>(nSize), MADV_SEQUENTIAL);
+    content.assign(static_cast<const char*>(pData), static_cast<size_t>(nSize));
+    munmap(pData, static_cast<size_t>(nSize));
+    return true;
+}
+
+bool PristineStore::findPristine(const std::string& relativePath, std::string& checksum, long long& nSize)
+{
+    sqlite3_reset(m_pStatement);
+    sqlite3_bind_text(m_pStatement, 1, relativePath.c_str(), static_cast<int>(relativePath.length()), SQLITE_TRANSIENT);
+    if(sqlite3_step(m_pStatement) != SQLITE_ROW)
+    {
+        return false;
+    }
+
+    //"$sha1$<40 hex digits>"; a missing pristine row, or a compressed one, is left to svn
+    const char* pChecksum = reinterpret_cast<const char*>(sqlite3_column_text(m_pStatement, 0));
+    if(!pChecksum || strncmp(pChecksum, "$sha1$", 6) != 0 || strlen(pChecksum) != 46
+            || sqlite3_column_type(m_pStatement, 2) == SQLITE_NULL || sqlite3_column_type(m_pStatement, 3) != SQLITE_NULL)
+    {
+        return false;
+    }
+
+    checksum = pChecksum + 6;
+    nSize = sqlite3_column_int64(m_pStatement, 2);
+
+    std::map<std::string, std::string> properties;
+    const char* pProperties = static_cast<const char*>(sqlite3_column_blob(m_pStatement, 1));
+    if(pProperties && !parseProperties(std::string(pProperties, sqlite3_column_bytes(m_pStatement, 1)), properties))
+    {
+        return false;
+    }
+
+    //the working text has keywords expanded and line endings translated, svn cat does the same
+    std::map<std::string, std::string>::const_iterator eolStyle = properties.find("svn:eol-style");
+    if(properties.count("svn:keywords") || (eolStyle != properties.end() && eolStyle->second != "native" && eolStyle->second != "LF"))
+    {
+        return false;
+    }
+
+    return true;
+}
+
+//properties are a skel list of names and values: "(svn:keywords 7 Id Date svn:eol-style native )",
+//atoms are either a bare word or "<length> <bytes>"
+bool PristineStore::parseProperties(const std::string& skel, std::map<std::string, std::string>& properties)
+{
+    size_t nPos = skel.find('(');
+    if(nPos == std::string::npos)
+    {
+        return false;
+    }
+    nPos++;
+
+    std::string name;
+    bool bHaveName = false;
+    while(nPos < skel.length())
+    {
+        char c = skel[nPos];
+        if(c == ' ' || c == '\t' || c == '\n' || c == '\r')
+        {
+            nPos++;
+            continue;
+        }
+
+        if(c == ')')
+        {
+            return !bHaveName;
+        }
+
+        std::string atom;
+        if(c >= '0' && c <= '9')
+        {
+            char* pEnd = nullptr;
+            size_t nLength = strtoul(skel.c_str() + nPos, &pEnd, 10);
+            size_t nData = pEnd - skel.c_str() + 1;
+            if(nData > skel.length() || nLength > skel.length() - nData)
+            {
+                return false;
+            }
+            atom = skel.substr(nData, nLength);
+            nPos = nData + nLength;
+        }
+        else
+        {
+            size_t nEnd = skel.find_first_of(" \t\n\r()", nPos);
+            if(nEnd == std::string::npos)
+            {
+                return false;
+            }
+            atom = skel.substr(nPos, nEnd - nPos);
+            nPos = nEnd;
+        }
+
+        if(bHaveName)
+        {
+            properties[name] = atom;
+        }
+        else
+        {
+            name = atom;
+        }
+        bHaveName = !bHaveName;
+    }
+
+    return false;
+}
@@ -0,0 +1,39 @@
+#ifndef PRISTINESTORE_H
+#define PRISTINESTORE_H
+
+#include <string>
+#include <map>
+#include <mutex>
+
+struct sqlite3;
+struct sqlite3_stmt;
+
+//reads the BASE text of files straight from the pristine store of a working copy (format 1.7 and later):
+//.svn/wc.db gives the SHA-1 of a file's pristine, .svn/pristine/<xx>/<sha1>.svn-base holds its text.
+//Files whose BASE differs from what svn cat would print (keywords, non-native line endings) or whose
+//pristine is not on disk are refused, the caller runs svn instead.
+class PristineStore
+{
+public:
+    PristineStore();
+    ~PristineStore();
+
+    //finds the working copy root above path; false when there is no readable wc.db
+    bool open(const std::string& path);
+    void close();
+
+    //path is absolute or relative to the current directory
+    bool readBase(const std::string& path, std::string& content);
+
+private:
+    bool findPristine(const std::string& relativePath, std::string& checksum, long long& nSize);
+    static bool parseProperties(const std::string& skel, std::map<std::string, std::string>& properties);
+
+private:
+    std::mutex m_mutex;
+    std::string m_rootPath;
+    sqlite3* m_pDatabase;
+    sqlite3_stmt* m_pStatement;
+};
+
+#endif // PRISTINESTORE_H
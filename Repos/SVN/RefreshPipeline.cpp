@@ -0,0 +1,157 @@
+#include "RefreshPipeline.h"
+
+#include <sstream>
+
+RefreshPipeline::RefreshPipeline()
+    : m_nLastDurationMs(-1)
+{
+}
+
+void RefreshPipeline::addStep(const std::string& name, const std::list<std::string>& dependencies, Launcher launcher)
+{
+    if(!isRunning())
+    {
+        //a finished graph is replaced by the next one
+        m_steps.clear();
+    }
+
+    Step step;
+    step.m_name = name;
+    step.m_dependencies = dependencies;
+    step.m_launcher = launcher;
+    step.m_state = Waiting;
+    step.m_pCommand = nullptr;
+    m_steps.push_back(step);
+}
+
+void RefreshPipeline::start()
+{
+    m_start = std::chrono::steady_clock::now();
+    launchReadySteps();
+}
+
+bool RefreshPipeline::isRunning() const
+{
+    for(const Step& step : m_steps)
+    {
+        if(step.m_state == Waiting || step.m_state == Running)
+            return true;
+    }
+
+    return false;
+}
+
+bool RefreshPipeline::onCommandCompleted(const SvnCommand* pCommand, bool bSuccess)
+{
+    for(Step& step : m_steps)
+    {
+        if(step.m_state == Running && step.m_pCommand == pCommand)
+        {
+            step.m_state = bSuccess ? Done : Failed;
+            step.m_pCommand = nullptr;
+            step.m_end = std::chrono::steady_clock::now();
+
+            launchReadySteps();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+std::string RefreshPipeline::getTimingReport() const
+{
+    std::stringstream ss;
+    ss << "refresh " << m_nLastDurationMs << " ms:";
+    for(const Step& step : m_steps)
+    {
+        ss << " " << step.m_name << "=";
+        if(step.m_state == Skipped)
+        {
+            ss << "skipped";
+            continue;
+        }
+
+        ss << std::chrono::duration_cast<std::chrono::milliseconds>(step.m_start - m_start).count() << "+"
+           << std::chrono::duration_cast<std::chrono::milliseconds>(step.m_end - step.m_start).count() << "ms";
+        if(step.m_state == Failed)
+        {
+            ss << "(failed)";
+        }
+    }
+
+    return ss.str();
+}
+
+RefreshPipeline::Step* RefreshPipeline::findStep(const std::string& name)
+{
+    for(Step& step : m_steps)
+    {
+        if(step.m_name == name)
+            return &step;
+    }
+
+    return nullptr;
+}
+
+void RefreshPipeline::launchReadySteps()
+{
+    //steps finishing at once (nullptr launcher result) can make other steps ready, so repeat until nothing moves
+    bool bProgress = true;
+    while(bProgress)
+    {
+        bProgress = false;
+        for(size_t i = 0; i < m_steps.size(); i++)
+        {
+            if(m_steps[i].m_state != Waiting)
+                continue;
+
+            bool bReady = true;
+            bool bBlocked = false;
+            for(const std::string& dependency : m_steps[i].m_dependencies)
+            {
+                Step* pDependency = findStep(dependency);
+                if(!pDependency)
+                    continue;
+
+                if(pDependency->m_state == Failed || pDependency->m_state == Skipped)
+                    bBlocked = true;
+                else
+                if(pDependency->m_state != Done)
+                    bReady = false;
+            }
+
+            if(bBlocked)
+            {
+                m_steps[i].m_state = Skipped;
+                bProgress = true;
+                continue;
+            }
+
+            if(!bReady)
+                continue;
+
+            m_steps[i].m_state = Running;
+            m_steps[i].m_start = std::chrono::steady_clock::now();
+            const SvnCommand* pCommand = m_steps[i].m_launcher();
+            m_steps[i].m_pCommand = pCommand;
+            if(!pCommand)
+            {
+                m_steps[i].m_state = Done;
+                m_steps[i].m_end = m_steps[i].m_start;
+            }
+            bProgress = true;
+        }
+    }
+
+    if(!isRunning() && !m_steps.empty())
+    {
+        std::chrono::steady_clock::time_point end = m_start;
+        for(const Step& step : m_steps)
+        {
+            if(step.m_state != Skipped && step.m_end > end)
+                end = step.m_end;
+        }
+        m_nLastDurationMs = std::chrono::duration_cast<std::chrono::milliseconds>(end - m_start).count();
+    }
+}
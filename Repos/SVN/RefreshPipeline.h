@@ -0,0 +1,62 @@
+#ifndef REFRESHPIPELINE_H
+#define REFRESHPIPELINE_H
+
+#include "Repos/SVN/SvnCommands.h"
+
+#include <string>
+#include <list>
+#include <vector>
+#include <chrono>
+#include <functional>
+
+//the steps of one refresh as a dependency graph: a step is launched as soon as all the steps it depends on are done,
+//and is skipped when one of them failed. Not thread safe, SvnViewer calls it under its own lock.
+class RefreshPipeline
+{
+public:
+    //launches the command of a step and returns it, or nullptr when there is nothing to do (the step is done at once)
+    typedef std::function<SvnCommand*()> Launcher;
+
+    RefreshPipeline();
+
+    void addStep(const std::string& name, const std::list<std::string>& dependencies, Launcher launcher);
+    void start();
+    bool isRunning() const;
+
+    //returns false when the command is not one of the steps
+    bool onCommandCompleted(const SvnCommand* pCommand, bool bSuccess);
+
+    long long getLastDurationMs() const { return m_nLastDurationMs; }
+    std::string getTimingReport() const;
+
+private:
+    enum State
+    {
+        Waiting,
+        Running,
+        Done,
+        Failed,
+        Skipped
+    };
+
+    struct Step
+    {
+        std::string m_name;
+        std::list<std::string> m_dependencies;
+        Launcher m_launcher;
+        State m_state;
+        const SvnCommand* m_pCommand;
+        std::chrono::steady_clock::time_point m_start;
+        std::chrono::steady_clock::time_point m_end;
+    };
+
+    Step* findStep(const std::string& name);
+    void launchReadySteps();
+
+private:
+    std::vector<Step> m_steps;
+    std::chrono::steady_clock::time_point m_start;
+    long long m_nLastDurationMs;
+};
+
+#endif // REFRESHPIPELINE_H
@@ -0,0 +1,200 @@
+#include "Repos/SVN/ReviewSession.h"
+#include "Repos/SVN/SvnCommands.h"
+
+#include <sys/stat.h>
+#include <ftw.h>
+#include <thread>
+#include <fstream>
+#include <sstream>
+
+static int removeEntry(const char* path, const struct stat* /*info*/, int /*flag*/, struct FTW* /*ftw*/)
+{
+    return remove(path);
+}
+
+static bool makeDirectories(const std::string& path)
+{
+    for(size_t nSlash = path.find('/', 1); nSlash != std::string::npos; nSlash = path.find('/', nSlash + 1))
+    {
+        mkdir(path.substr(0, nSlash).c_str(), 0755);
+    }
+
+    struct stat info;
+    return stat(path.c_str(), &info) == 0 || mkdir(path.c_str(), 0755) == 0;
+}
+
+static bool readFile(const std::string& path, std::string& content)
+{
+    std::ifstream file(path.c_str(), std::ios_base::in | std::ios_base::binary);
+    if(!file)
+        return false;
+
+    std::stringstream ss;
+    ss << file.rdbuf();
+    content = ss.str();
+    return true;
+}
+
+ReviewSession::ReviewSession(int nId, const std::set<int>& revisions, const std::vector<File>& files, const std::string& stagingPath,
+                             ReviewSessionObserver* pObserver)
+    : m_nId(nId)
+    , m_revisions(revisions)
+    , m_stagingPath(stagingPath)
+    , m_pObserver(pObserver)
+    , m_files(files)
+    , m_nRunningThreads(0)
+    , m_bStopped(false)
+{
+    for(size_t i = 0; i < m_files.size(); i++)
+    {
+        m_queue.push_back(static_cast<int>(i));
+    }
+}
+
+void ReviewSession::start(int nThreads)
+{
+    //a previous review of the revision may have left other files
+    nftw(m_stagingPath.c_str(), removeEntry, 16, FTW_DEPTH | FTW_PHYS);
+    makeDirectories(getBeforePath());
+    makeDirectories(getAfterPath());
+
+    std::unique_lock<std::mutex> locker(m_mutex);
+    if(m_queue.empty())
+    {
+        locker.unlock();
+        m_pObserver->onReviewCompleted(m_nId);
+        return;
+    }
+
+    for(int i = 0; i < nThreads && i < static_cast<int>(m_queue.size()); i++)
+    {
+        m_nRunningThreads++;
+        std::shared_ptr<ReviewSession> spSelf = shared_from_this();
+        std::thread([spSelf]() { spSelf->run(); }).detach();
+    }
+}
+
+void ReviewSession::stop()
+{
+    std::unique_lock<std::mutex> locker(m_mutex);
+    m_bStopped = true;
+    m_queue.clear();
+}
+
+void ReviewSession::prioritize(int nIndex)
+{
+    std::unique_lock<std::mutex> locker(m_mutex);
+
+    //the files after the selected one are the next to be looked at
+    std::list<int> front, back;
+    for(int nQueued : m_queue)
+    {
+        (nQueued >= nIndex ? front : back).push_back(nQueued);
+    }
+    front.sort();
+    m_queue.swap(front);
+    m_queue.splice(m_queue.end(), back);
+}
+
+int ReviewSession::getStagedFilesCount() const
+{
+    std::unique_lock<std::mutex> locker(m_mutex);
+    int nStaged = 0;
+    for(const File& file : m_files)
+    {
+        if(file.m_state == Staged || file.m_state == Failed)
+            nStaged++;
+    }
+    return nStaged;
+}
+
+ReviewSession::File ReviewSession::getFile(int nIndex) const
+{
+    std::unique_lock<std::mutex> locker(m_mutex);
+    return m_files[nIndex];
+}
+
+std::shared_ptr<const TextDiff> ReviewSession::loadDiff(int nIndex) const
+{
+    File file = getFile(nIndex);
+    if(file.m_state != Staged)
+    {
+        return std::shared_ptr<const TextDiff>();
+    }
+
+    std::string before, after;
+    if(file.m_bBefore)
+        readFile(getBeforePath() + file.m_relativePath, before);
+    if(file.m_bAfter)
+        readFile(getAfterPath() + file.m_relativePath, after);
+
+    std::shared_ptr<TextDiff> spDiff(new TextDiff());
+    spDiff->compute(std::move(before), std::move(after));
+    return spDiff;
+}
+
+void ReviewSession::run()
+{
+    while(true)
+    {
+        int nIndex = -1;
+        {
+            std::unique_lock<std::mutex> locker(m_mutex);
+            if(m_queue.empty())
+            {
+                bool bLast = --m_nRunningThreads == 0 && !m_bStopped;
+                locker.unlock();
+                if(bLast)
+                {
+                    m_pObserver->onReviewCompleted(m_nId);
+                }
+                return;
+            }
+
+            nIndex = m_queue.front();
+            m_queue.pop_front();
+            m_files[nIndex].m_state = Staging;
+        }
+
+        stage(nIndex);
+    }
+}
+
+void ReviewSession::stage(int nIndex)
+{
+    File file = getFile(nIndex);
+
+    std::stringstream ssBefore, ssAfter;
+    ssBefore << file.m_nBeforeRevision;
+    ssAfter << file.m_nAfterRevision;
+
+    //an added file has no before, a deleted one no after; a directory has neither
+    std::string before, after;
+    bool bBefore = file.m_nBeforeRevision > 0 && SvnCommand::catFile(file.m_url, ssBefore.str(), file.m_cacheKey, before)
+                   && writeFile(getBeforePath() + file.m_relativePath, before);
+    bool bAfter = file.m_nAfterRevision > 0 && SvnCommand::catFile(file.m_url, ssAfter.str(), file.m_cacheKey, after)
+                  && writeFile(getAfterPath() + file.m_relativePath, after);
+
+    std::unique_lock<std::mutex> locker(m_mutex);
+    m_files[nIndex].m_bBefore = bBefore;
+    m_files[nIndex].m_bAfter = bAfter;
+    m_files[nIndex].m_state = (bBefore || bAfter) ? Staged : Failed;
+    if(m_bStopped)
+    {
+        return;
+    }
+    locker.unlock();
+
+    m_pObserver->onReviewFileStaged(m_nId, nIndex);
+}
+
+bool ReviewSession::writeFile(const std::string& path, const std::string& content)
+{
+    size_t nSlash = path.rfind('/');
+    if(nSlash != std::string::npos && !makeDirectories(path.substr(0, nSlash)))
+        return false;
+
+    std::ofstream file(path.c_str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+    file.write(content.data(), content.size());
+    return static_cast<bool>(file);
+}
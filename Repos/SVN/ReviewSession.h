@@ -0,0 +1,102 @@
+#ifndef REVIEWSESSION_H
+#define REVIEWSESSION_H
+
+#include "Diff/TextDiff.h"
+
+#include <string>
+#include <vector>
+#include <list>
+#include <set>
+#include <memory>
+#include <mutex>
+
+class ReviewSessionObserver
+{
+public:
+    //called from a staging thread once both sides of file nIndex are on disk (or known not to exist)
+    virtual void onReviewFileStaged(int nReviewId, int nIndex) = 0;
+    virtual void onReviewCompleted(int nReviewId) = 0;
+};
+
+//stages the text before and after one or more revisions of every item they changed under <staging path>/before
+//and /after, fetching several items at once. Over several revisions an item goes from its text before the first
+//of them that changed it to its text after the last one. Items are fetched in list order; prioritize() moves the
+//one the user looks at, and those after it, to the front.
+class ReviewSession : public std::enable_shared_from_this<ReviewSession>
+{
+public:
+    enum FileState
+    {
+        Pending,
+        Staging,
+        Staged,
+        Failed
+    };
+
+    struct File
+    {
+        File()
+            : m_nBeforeRevision(-1)
+            , m_nAfterRevision(-1)
+            , m_state(Pending)
+            , m_bBefore(false)
+            , m_bAfter(false)
+        {
+        }
+
+        //status letter from svn diff --summarize (M, A, D, R), combined over several revisions
+        std::string m_status;
+        //the sides to stage, -1 for a side the item does not have (added or deleted)
+        int m_nBeforeRevision;
+        int m_nAfterRevision;
+        std::string m_url;
+        //path under the staging directories
+        std::string m_relativePath;
+        //file revision cache key without the revision, may be empty
+        std::string m_cacheKey;
+        FileState m_state;
+        bool m_bBefore;
+        bool m_bAfter;
+    };
+
+    ReviewSession(int nId, const std::set<int>& revisions, const std::vector<File>& files, const std::string& stagingPath,
+                  ReviewSessionObserver* pObserver);
+
+    //the staging threads keep the session alive until they are done
+    void start(int nThreads);
+    //running fetches finish, nothing new is started and the observer is not called any more
+    void stop();
+    void prioritize(int nIndex);
+
+    int getId() const { return m_nId; }
+    const std::set<int>& getRevisions() const { return m_revisions; }
+    int getFirstRevision() const { return *m_revisions.begin(); }
+    int getLastRevision() const { return *m_revisions.rbegin(); }
+    int getFilesCount() const { return static_cast<int>(m_files.size()); }
+    int getStagedFilesCount() const;
+    File getFile(int nIndex) const;
+    std::string getBeforePath() const { return m_stagingPath + "before/"; }
+    std::string getAfterPath() const { return m_stagingPath + "after/"; }
+
+    //diff of the staged sides of file nIndex; empty while it is not staged or when neither side exists
+    std::shared_ptr<const TextDiff> loadDiff(int nIndex) const;
+
+private:
+    void run();
+    void stage(int nIndex);
+    bool writeFile(const std::string& path, const std::string& content);
+
+private:
+    const int m_nId;
+    const std::set<int> m_revisions;
+    const std::string m_stagingPath;
+    ReviewSessionObserver* m_pObserver;
+
+    mutable std::mutex m_mutex;
+    std::vector<File> m_files;
+    std::list<int> m_queue;
+    int m_nRunningThreads;
+    bool m_bStopped;
+};
+
+#endif // REVIEWSESSION_H
@@ -0,0 +1,85 @@
+#include "Repos/SVN/RevisionStatsStore.h"
+#include "Settings/AppSettings.h"
+
+#include <sys/stat.h>
+#include <fstream>
+#include <sstream>
+#include <functional>
+
+RevisionStatsStore::RevisionStatsStore()
+{
+}
+
+void RevisionStatsStore::open(const std::string& key)
+{
+    std::unique_lock<std::mutex> locker(m_mutex);
+    m_key = key;
+    m_stats.clear();
+    m_path.clear();
+    if(key.empty())
+    {
+        return;
+    }
+
+    //the first line holds the key, a file whose name collides with another key is not used
+    std::string directory = AppSettings::instance()->getSettingsPath() + "Stats/";
+    mkdir(directory.c_str(), 0755);
+    std::stringstream ss;
+    ss << directory << std::hex << std::hash<std::string>()(key);
+    m_path = ss.str();
+
+    std::ifstream file(m_path.c_str(), std::ios_base::in);
+    std::string line;
+    if(!getline(file, line))
+    {
+        std::ofstream newFile(m_path.c_str(), std::ios_base::out | std::ios_base::trunc);
+        newFile << key << "\n";
+        return;
+    }
+
+    if(line != key)
+    {
+        m_path.clear();
+        return;
+    }
+
+    while(getline(file, line))
+    {
+        std::stringstream lineStream(line);
+        int nRevision = -1;
+        RevisionStats stats;
+        if(lineStream >> nRevision >> stats.m_nChangedFiles >> stats.m_nAddedLines >> stats.m_nRemovedLines)
+        {
+            m_stats[nRevision] = stats;
+        }
+    }
+}
+
+bool RevisionStatsStore::get(int nRevision, RevisionStats& stats) const
+{
+    std::unique_lock<std::mutex> locker(m_mutex);
+    std::map<int, RevisionStats>::const_iterator it = m_stats.find(nRevision);
+    if(it == m_stats.end())
+    {
+        return false;
+    }
+
+    stats = it->second;
+    return true;
+}
+
+void RevisionStatsStore::put(int nRevision, const RevisionStats& stats)
+{
+    std::unique_lock<std::mutex> locker(m_mutex);
+    if(m_stats.count(nRevision))
+    {
+        return;
+    }
+
+    m_stats[nRevision] = stats;
+    if(!m_path.empty())
+    {
+        std::ofstream file(m_path.c_str(), std::ios_base::out | std::ios_base::app);
+        file << nRevision << " " << stats.m_nChangedFiles << " " << stats.m_nAddedLines << " " << stats.m_nRemovedLines << "\n";
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef REVISIONSTATSSTORE_H
+#define REVISIONSTATSSTORE_H
+
+#include <string>
+#include <map>
+#include <mutex>
+
+struct RevisionStats
+{
+    RevisionStats()
+        : m_nChangedFiles(-1)
+        , m_nAddedLines(-1)
+        , m_nRemovedLines(-1)
+    {
+    }
+
+    bool isKnown() const { return m_nChangedFiles != -1; }
+
+    int m_nChangedFiles;
+    int m_nAddedLines;
+    int m_nRemovedLines;
+};
+
+//diff statistics of the revisions of one repository url, kept in <settings path>/Stats/. A revision never
+//changes, so the file is only appended to: one "<revision> <files> <added> <removed>" line per revision.
+class RevisionStatsStore
+{
+public:
+    RevisionStatsStore();
+
+    //key identifies the url, e.g. "<repository uuid>:<path in the repository>"
+    void open(const std::string& key);
+    const std::string& getKey() const { return m_key; }
+
+    bool get(int nRevision, RevisionStats& stats) const;
+    void put(int nRevision, const RevisionStats& stats);
+
+private:
+    mutable std::mutex m_mutex;
+    std::string m_key;
+    std::string m_path;
+    std::map<int, RevisionStats> m_stats;
+};
+
+#endif // REVISIONSTATSSTORE_H
@@ -0,0 +1,248 @@
+#include "Repos/SVN/SvnBackend.h"
+#include "Logger/Logger.h"
+
+#include <sys/wait.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <thread>
+
+SvnBackend* SvnBackend::instance()
+{
+    static SvnBackend* pInstance = nullptr;
+    static std::once_flag initialized;
+    std::call_once(initialized, []()
+    {
+        const char* pReplayPath = getenv("COSVN_REPLAY");
+        const char* pRecordPath = getenv("COSVN_RECORD");
+        if(pReplayPath && *pReplayPath)
+        {
+            const char* pSpeed = getenv("COSVN_REPLAY_SPEED");
+            pInstance = new ReplaySvnBackend(pReplayPath, pSpeed ? atof(pSpeed) : 0);
+        }
+        else
+        if(pRecordPath && *pRecordPath)
+        {
+            pInstance = new RecordingSvnBackend(pRecordPath);
+        }
+        else
+        {
+            pInstance = new ShellSvnBackend();
+        }
+    });
+
+    return pInstance;
+}
+
+int SvnBackend::executeStreaming(const std::string& cmd, const LineCallback& onLine, std::string& output)
+{
+    int nExitCode = execute(cmd, output);
+
+    LineReader reader(output);
+    StringRef line;
+    while(reader.next(line))
+    {
+        onLine(line);
+    }
+
+    return nExitCode;
+}
+
+int ShellSvnBackend::execute(const std::string& cmd, std::string& output)
+{
+    output.clear();
+
+    FILE* pipe = popen(cmd.c_str(), "r");
+    if (!pipe)
+    {
+        Logger::instance()->logCommandMessage(std::string("Failed to open pipe."));
+        return -1;
+    }
+
+    char buffer[4096];
+    size_t nRead = 0;
+    while((nRead = fread(buffer, 1, sizeof(buffer), pipe)) > 0)
+    {
+        output.append(buffer, nRead);
+    }
+
+    int nStatus = pclose(pipe);
+    return WIFEXITED(nStatus) ? WEXITSTATUS(nStatus) : -1;
+}
+
+int ShellSvnBackend::executeStreaming(const std::string& cmd, const LineCallback& onLine, std::string& output)
+{
+    output.clear();
+
+    FILE* pipe = popen(cmd.c_str(), "r");
+    if (!pipe)
+    {
+        Logger::instance()->logCommandMessage(std::string("Failed to open pipe."));
+        return -1;
+    }
+
+    //read() returns whatever the process wrote so far, fread() would wait for a full buffer
+    char buffer[4096];
+    size_t nLineStart = 0;
+    for(;;)
+    {
+        ssize_t nRead = read(fileno(pipe), buffer, sizeof(buffer));
+        if(nRead < 0 && errno == EINTR)
+            continue;
+
+        if(nRead <= 0)
+            break;
+
+        size_t nScanFrom = output.size();
+        output.append(buffer, nRead);
+
+        //offsets, not pointers: append may have moved the buffer
+        for(size_t nPos = output.find('\n', nScanFrom); nPos != std::string::npos; nPos = output.find('\n', nPos + 1))
+        {
+            onLine(StringRef(output.data() + nLineStart, nPos - nLineStart));
+            nLineStart = nPos + 1;
+        }
+    }
+
+    if(nLineStart < output.size())
+    {
+        onLine(StringRef(output.data() + nLineStart, output.size() - nLineStart));
+    }
+
+    int nStatus = pclose(pipe);
+    return WIFEXITED(nStatus) ? WEXITSTATUS(nStatus) : -1;
+}
+
+void ShellSvnBackend::launchDetached(const std::string& cmd)
+{
+    system((cmd + " &").c_str());
+}
+
+RecordingSvnBackend::RecordingSvnBackend(const std::string& recordPath)
+    : m_record(recordPath.c_str(), std::ios_base::out | std::ios_base::app | std::ios_base::binary)
+{
+    if(!m_record)
+    {
+        Logger::instance()->logCommandMessage("Cannot open the svn record file " + recordPath + ".");
+    }
+}
+
+int RecordingSvnBackend::execute(const std::string& cmd, std::string& output)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    int nExitCode = ShellSvnBackend::execute(cmd, output);
+    record(cmd, output, nExitCode, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+
+    return nExitCode;
+}
+
+int RecordingSvnBackend::executeStreaming(const std::string& cmd, const LineCallback& onLine, std::string& output)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    int nExitCode = ShellSvnBackend::executeStreaming(cmd, onLine, output);
+    record(cmd, output, nExitCode, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+
+    return nExitCode;
+}
+
+void RecordingSvnBackend::record(const std::string& cmd, const std::string& output, int nExitCode, long long nDurationUs)
+{
+    Invocation invocation;
+    invocation.m_command = cmd;
+    invocation.m_nExitCode = nExitCode;
+    invocation.m_nDurationUs = nDurationUs;
+    invocation.m_output = output;
+
+    std::unique_lock<std::mutex> locker(m_mutex);
+    ReplaySvnBackend::writeInvocation(m_record, invocation);
+    m_record.flush();
+}
+
+ReplaySvnBackend::ReplaySvnBackend(const std::string& recordPath, double dSpeed)
+    : m_dSpeed(dSpeed)
+{
+    std::ifstream record(recordPath.c_str(), std::ios_base::in | std::ios_base::binary);
+    if(!record)
+    {
+        Logger::instance()->logCommandMessage("Cannot open the svn replay file " + recordPath + ".");
+        return;
+    }
+
+    Invocation invocation;
+    while(readInvocation(record, invocation))
+    {
+        m_invocations[invocation.m_command].push_back(invocation);
+    }
+}
+
+int ReplaySvnBackend::execute(const std::string& cmd, std::string& output)
+{
+    Invocation invocation;
+    {
+        std::unique_lock<std::mutex> locker(m_mutex);
+        std::list<Invocation>& recorded = m_invocations[cmd];
+        if(!recorded.empty())
+        {
+            invocation = recorded.front();
+            recorded.pop_front();
+            m_lastInvocations[cmd] = invocation;
+        }
+        else
+        if(m_lastInvocations.count(cmd))
+        {
+            invocation = m_lastInvocations[cmd];
+        }
+        else
+        {
+            Logger::instance()->logCommandMessage("No recorded answer for command: " + cmd);
+            output.clear();
+            return 127;
+        }
+    }
+
+    if(m_dSpeed > 0)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(static_cast<long long>(invocation.m_nDurationUs / m_dSpeed)));
+    }
+
+    output = invocation.m_output;
+    return invocation.m_nExitCode;
+}
+
+void ReplaySvnBackend::launchDetached(const std::string& cmd)
+{
+    Logger::instance()->logCommandMessage("Replay session, not launching: " + cmd);
+}
+
+//record format, one block per invocation:
+//  INVOCATION <exit code> <duration us> <command length> <output length>\n<command>\n<output>\n
+bool ReplaySvnBackend::readInvocation(std::istream& stream, Invocation& invocation)
+{
+    std::string tag;
+    size_t nCommandLength = 0;
+    size_t nOutputLength = 0;
+    if(!(stream >> tag >> invocation.m_nExitCode >> invocation.m_nDurationUs >> nCommandLength >> nOutputLength) || tag != "INVOCATION")
+    {
+        return false;
+    }
+    stream.get();
+
+    invocation.m_command.resize(nCommandLength);
+    stream.read(&invocation.m_command[0], nCommandLength);
+    stream.get();
+
+    invocation.m_output.resize(nOutputLength);
+    stream.read(&invocation.m_output[0], nOutputLength);
+    stream.get();
+
+    return stream.good();
+}
+
+void ReplaySvnBackend::writeInvocation(std::ostream& stream, const Invocation& invocation)
+{
+    stream << "INVOCATION " << invocation.m_nExitCode << " " << invocation.m_nDurationUs << " "
+           << invocation.m_command.size() << " " << invocation.m_output.size() << "\n"
+           << invocation.m_command << "\n" << invocation.m_output << "\n";
+}
@@ -0,0 +1,95 @@
+#ifndef SVNBACKEND_H
+#define SVNBACKEND_H
+
+#include "Repos/SVN/SvnParsers.h"
+
+#include <string>
+#include <list>
+#include <map>
+#include <mutex>
+#include <fstream>
+#include <functional>
+
+//executes the command lines built by the svn commands; selected once per process from the environment:
+//  COSVN_RECORD=<file>          run svn and append every invocation to <file>
+//  COSVN_REPLAY=<file>          answer invocations from a recorded <file> without running svn
+//  COSVN_REPLAY_SPEED=<factor>  1 replays with the recorded durations, 2 twice as fast, 0 without delays (default)
+class SvnBackend
+{
+public:
+    struct Invocation
+    {
+        Invocation()
+            : m_nExitCode(0)
+            , m_nDurationUs(0)
+        {
+        }
+
+        std::string m_command;
+        std::string m_output;
+        int m_nExitCode;
+        long long m_nDurationUs;
+    };
+
+    typedef std::function<void(const StringRef& line)> LineCallback;
+
+    virtual ~SvnBackend() {}
+
+    static SvnBackend* instance();
+
+    //runs cmd to completion and returns its exit code; stdout is stored in output
+    virtual int execute(const std::string& cmd, std::string& output) = 0;
+
+    //like execute, but every line of stdout is also handed to onLine; by default once the command finished,
+    //backends running a real process do it as soon as the line was read
+    virtual int executeStreaming(const std::string& cmd, const LineCallback& onLine, std::string& output);
+
+    //starts an external tool (e.g. the diff viewer) without waiting for it
+    virtual void launchDetached(const std::string& cmd) = 0;
+};
+
+class ShellSvnBackend : public SvnBackend
+{
+public:
+    virtual int execute(const std::string& cmd, std::string& output);
+    virtual int executeStreaming(const std::string& cmd, const LineCallback& onLine, std::string& output);
+    virtual void launchDetached(const std::string& cmd);
+};
+
+class RecordingSvnBackend : public ShellSvnBackend
+{
+public:
+    explicit RecordingSvnBackend(const std::string& recordPath);
+
+    virtual int execute(const std::string& cmd, std::string& output);
+    virtual int executeStreaming(const std::string& cmd, const LineCallback& onLine, std::string& output);
+
+private:
+    void record(const std::string& cmd, const std::string& output, int nExitCode, long long nDurationUs);
+
+private:
+    std::mutex m_mutex;
+    std::ofstream m_record;
+};
+
+class ReplaySvnBackend : public SvnBackend
+{
+public:
+    ReplaySvnBackend(const std::string& recordPath, double dSpeed);
+
+    virtual int execute(const std::string& cmd, std::string& output);
+    virtual void launchDetached(const std::string& cmd);
+
+    static bool readInvocation(std::istream& stream, Invocation& invocation);
+    static void writeInvocation(std::ostream& stream, const Invocation& invocation);
+
+private:
+    std::mutex m_mutex;
+    double m_dSpeed;
+    //recorded invocations per command line, answered in recording order
+    std::map<std::string, std::list<Invocation> > m_invocations;
+    //last answer per command line, reused when a session issues a command more often than recorded
+    std::map<std::string, Invocation> m_lastInvocations;
+};
+
+#endif // SVNBACKEND_H
@@ -3,9 +3,24 @@
 
 #include "Logger/Logger.h"
 #include "Settings/AppSettings.h"
+#include "Repos/SVN/SvnParsers.h"
+#include "Repos/SVN/SvnBackend.h"
+#include "Repos/SVN/FileRevisionCache.h"
+#include "Repos/SVN/PristineStore.h"
+#include "Repos/SVN/RevisionStatsStore.h"
+#include "Diff/TextDiff.h"
 
 #include <unistd.h>
+#include <cstdio>
+#include <algorithm>
 #include <memory>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <list>
+#include <set>
+#include <vector>
+#include <chrono>
 
 static bool stringEndsWith(const std::string& str, char c)
 {
@@ -18,6 +33,16 @@ static bool stringEndsWith(const std::string& str, char c)
     return false;
 }
 
+//approximate heap footprint of a string owned by a list node
+static size_t stringMemoryUsage(const std::string& str)
+{
+    //short strings live in the object itself (SSO)
+    return sizeof(std::string) + (str.capacity() > 15 ? str.capacity() + 1 : 0);
+}
+
+//per node overhead of std::list: the two links
+static const size_t LIST_NODE_OVERHEAD = 2 * sizeof(void*);
+
 class RepoItemInfo
 {
 public:
@@ -77,6 +102,34 @@ public:
         return result;
     }
 
+    size_t getMemoryUsage() const
+    {
+        size_t nBytes = sizeof(RepoItemInfo) + stringMemoryUsage(m_name) - sizeof(std::string);
+        for(const RepoItemInfo::SmartPtr& child : m_subItems)
+        {
+            nBytes += child->getMemoryUsageAsChild();
+        }
+
+        return nBytes;
+    }
+
+    //with the shared_ptr control block and the list node holding the pointer in the parent
+    size_t getMemoryUsageAsChild() const
+    {
+        return getMemoryUsage() + LIST_NODE_OVERHEAD + sizeof(SmartPtr) + 2 * sizeof(long);
+    }
+
+    bool isInTree(const RepoItemInfo* pRoot) const
+    {
+        const RepoItemInfo* pItem = this;
+        while(pItem->m_parent)
+        {
+            pItem = pItem->m_parent;
+        }
+
+        return pItem == pRoot;
+    }
+
 public:
     ItemType m_type;
     std::string m_name;
@@ -88,17 +141,42 @@ class RevisionInfo
 {
 public:
     typedef std::list<RevisionInfo> Collection;
-    RevisionInfo() : m_bLoading(false)
+    RevisionInfo() : m_bLoading(false), m_bPrefetched(false), m_nLastAccess(0), m_bStatsLoading(false)
     {
     }
 
+    //memory of the revision header: number, author, date and description
+    size_t getMemoryUsage() const
+    {
+        return sizeof(RevisionInfo) + LIST_NODE_OVERHEAD - 3 * sizeof(std::string)
+                + stringMemoryUsage(m_Description) + stringMemoryUsage(m_Author) + stringMemoryUsage(m_Date);
+    }
+
+    //memory of the affected items, the part that can be evicted and fetched again
+    size_t getAffectedItemsMemoryUsage() const
+    {
+        size_t nBytes = 0;
+        for(const std::string& item : m_AffectedItems)
+        {
+            nBytes += stringMemoryUsage(item) + LIST_NODE_OVERHEAD;
+        }
+
+        return nBytes;
+    }
+
 public:
     bool m_bLoading;
+    //affected items fetched ahead of the selection and not viewed yet
+    bool m_bPrefetched;
+    unsigned long long m_nLastAccess;
     int m_No;
     std::string m_Description;
     std::string m_Author;
     std::string m_Date;
     std::list<std::string> m_AffectedItems;
+    //size of the revision, computed in the background
+    RevisionStats m_Stats;
+    bool m_bStatsLoading;
 };
 
 class ChangeInfo
@@ -106,10 +184,73 @@ class ChangeInfo
 public:
     typedef std::list<ChangeInfo> Collection;
 
+    size_t getMemoryUsage() const
+    {
+        return LIST_NODE_OVERHEAD + stringMemoryUsage(m_AffectedItem) + stringMemoryUsage(m_Status);
+    }
+
     std::string m_AffectedItem;
     std::string m_Status;
 };
 
+//one line of svn blame: the revision that last changed it (-1 when svn reports none) and its author
+class BlameLine
+{
+public:
+    typedef std::vector<BlameLine> Collection;
+
+    BlameLine() : m_nRevision(-1)
+    {
+    }
+
+    int m_nRevision;
+    std::string m_Author;
+    std::string m_Text;
+};
+
+//what a status run changed in the local change set
+class LocalChangesDelta
+{
+public:
+    LocalChangesDelta() : m_bFullStatus(false)
+    {
+    }
+
+    bool empty() const
+    {
+        return m_added.empty() && m_removed.empty() && m_changed.empty();
+    }
+
+    //true when the whole working copy was checked, false for a subtree-scoped status
+    bool m_bFullStatus;
+    ChangeInfo::Collection m_added;
+    ChangeInfo::Collection m_removed;
+    ChangeInfo::Collection m_changed;
+};
+
+//the state a command made stale; SvnViewer recomputes only these parts after the command succeeded
+class Invalidation
+{
+public:
+    Invalidation()
+        : m_bRevisions(false)
+        , m_bWorkingCopyInfo(false)
+        , m_bRepoContent(false)
+        , m_bFullStatus(false)
+    {
+    }
+
+    //items whose status (and the status of everything below them) has to be checked again
+    std::set<std::string> m_statusPaths;
+    //the server has new revisions
+    bool m_bRevisions;
+    //revision and url reported by svn info
+    bool m_bWorkingCopyInfo;
+    //the listing of the working copy
+    bool m_bRepoContent;
+    bool m_bFullStatus;
+};
+
 class SvnCommand
 {
 public:
@@ -120,29 +261,57 @@ public:
 
     virtual std::string getType() const = 0;
     virtual bool execute() = 0;
+    //read-only commands invalidate nothing
+    virtual Invalidation getInvalidation() const { return Invalidation(); }
 
     static std::string executeShellCommand(const std::string& cmd)
     {
-        FILE* pipe = popen(cmd.c_str(), "r");
-        if (!pipe)
+        int nExitCode = 0;
+        return executeShellCommand(cmd, nExitCode);
+    }
+
+    static std::string executeShellCommand(const std::string& cmd, int& nExitCode)
+    {
+        std::string result;
+        nExitCode = SvnBackend::instance()->execute(cmd, result);
+        Logger::instance()->logCommandMessage(std::string("========================================\nExecuting command:\n")
+                                              + cmd + "." + std::string("Obtained result:\n") + result + "\n");
+        return result;
+    }
+
+    //onLine sees every line of the output while the command still runs
+    static std::string executeStreamingShellCommand(const std::string& cmd, const SvnBackend::LineCallback& onLine, int& nExitCode)
+    {
+        std::string result;
+        nExitCode = SvnBackend::instance()->executeStreaming(cmd, onLine, result);
+        Logger::instance()->logCommandMessage(std::string("========================================\nExecuting command:\n")
+                                              + cmd + "." + std::string("Obtained result:\n") + result + "\n");
+        return result;
+    }
+
+    //svn cat of target at a numeric revision or BASE; cacheKey ("<uuid>:<path>", may be empty) lets numeric
+    //revisions come from the file revision cache, BASE changes with every update and is never cached
+    static bool catFile(const std::string& target, const std::string& revision, const std::string& cacheKey, std::string& content)
+    {
+        bool bCacheable = !cacheKey.empty() && !revision.empty() && revision.find_first_not_of("0123456789") == std::string::npos;
+        std::string key = cacheKey + "@" + revision;
+        if(bCacheable && FileRevisionCache::instance()->get(key, content))
         {
-            Logger::instance()->logCommandMessage(std::string("Failed to open pipe."));
-            return "";
+            return true;
         }
 
-        char buffer[128];
-        std::string result = "";
-        while(!feof(pipe))
+        int nExitCode = 0;
+        content = executeShellCommand(std::string("svn cat \"") + target + "@" + revision + "\" --non-interactive", nExitCode);
+        if(nExitCode != 0)
         {
-            if(fgets(buffer, 128, pipe) != NULL)
-            {
-                result += buffer;
-            }
+            return false;
         }
-        pclose(pipe);
-        Logger::instance()->logCommandMessage(std::string("========================================\nExecuting command:\n")
-                                              + cmd + "." + std::string("Obtained result:\n") + result + "\n");
-        return result;
+
+        if(bCacheable)
+        {
+            FileRevisionCache::instance()->put(key, content);
+        }
+        return true;
     }
 
 protected:
@@ -164,75 +333,86 @@ public:
         std::stringstream ss; ss << m_nDisplayRevisionsCount;
         std::string result = executeShellCommand(std::string("svn log ") + m_path + " -l " + ss.str());
 
+        return parse(result);
+    }
+
+    bool parse(const std::string& result)
+    {
         if(result.empty())
             return false;
 
-        std::istringstream stringStream(result);
+        m_revisions.clear();
 
         RevisionInfo revision;
         int nRevisionLine = 0;
-        std::string revisionPart;
         int nCommentLines = 1;
-        while(getline(stringStream, revisionPart, '\n'))
+        //the description is a contiguous range of the buffer, materialized once when the revision is complete
+        const char* pDescriptionBegin = nullptr;
+        const char* pDescriptionEnd = nullptr;
+
+        LineReader reader(result);
+        StringRef revisionPart;
+        while(reader.next(revisionPart))
         {
             switch(nRevisionLine)
             {
                 case 1:
                     {
-                        if(revisionPart[0] != 'r')
+                        if(revisionPart.empty() || revisionPart[0] != 'r')
                         {
                             return false;
                         }
 
-                        size_t nPos = revisionPart.find("|");
-                        if(nPos == std::string::npos)
+                        size_t nPos = revisionPart.find('|');
+                        if(nPos == StringRef::npos)
                         {
                             return false;
                         }
 
-                        revision.m_No = atoi(revisionPart.substr(1, nPos).c_str());
+                        revision.m_No = revisionPart.substr(1, nPos).toInt();
 
                         size_t nStart = nPos + 2;
-                        nPos = revisionPart.find("|", nStart);
-                        if(nPos == std::string::npos)
+                        nPos = revisionPart.find('|', nStart);
+                        if(nPos == StringRef::npos)
                         {
                             return false;
                         }
 
-                        revision.m_Author = revisionPart.substr(nStart, nPos - nStart - 1);
+                        revisionPart.substr(nStart, nPos - nStart - 1).assignTo(revision.m_Author);
 
                         nStart = nPos + 2;
-                        nPos = revisionPart.find("|", nStart);
-                        if(nPos == std::string::npos)
+                        nPos = revisionPart.find('|', nStart);
+                        if(nPos == StringRef::npos)
                         {
                             return false;
                         }
 
-                        revision.m_Date = revisionPart.substr(nStart, nPos - nStart - 1);
+                        revisionPart.substr(nStart, nPos - nStart - 1).assignTo(revision.m_Date);
 
-                        nPos = revisionPart.rfind(" line", revisionPart.length() - 1);
-                        if(nPos == std::string::npos)
+                        nPos = revisionPart.rfind(" line");
+                        if(nPos == StringRef::npos)
                         {
                             return false;
                         }
 
                         nStart = revisionPart.rfind("| ");
-                        if(nStart == std::string::npos)
+                        if(nStart == StringRef::npos)
                         {
                             return false;
                         }
 
-                        nCommentLines = atoi(revisionPart.substr(nStart + 2, nPos - nStart).c_str());
+                        nCommentLines = revisionPart.substr(nStart + 2, nPos - nStart).toInt();
                     }
                     break;
 
             case 3:
-                  revision.m_Description = revisionPart;
+                  pDescriptionBegin = revisionPart.begin();
+                  pDescriptionEnd = revisionPart.end();
                   break;
             default:
                     if(nRevisionLine > 3 && nCommentLines > 0)
                     {
-                        revision.m_Description += "\n" + revisionPart;
+                        pDescriptionEnd = revisionPart.end();
                     }
                     break;
             }
@@ -242,6 +422,7 @@ public:
             {
                 nCommentLines = 1;
                 nRevisionLine = 0;
+                revision.m_Description.assign(pDescriptionBegin, pDescriptionEnd - pDescriptionBegin);
                 m_revisions.push_back(revision);
             }
         }
@@ -266,28 +447,91 @@ public:
     {
     }
 
+    //status of the given targets only, not descending below nDepth ("empty", "files", "immediates", "infinity")
+    StatusSvnCommand(const std::string& path, const std::list<std::string>& targets, const std::string& depth)
+        : SvnCommand(path)
+        , m_targets(targets)
+        , m_depth(depth)
+    {
+    }
+
     virtual std::string getType() const { return "svn status"; }
     virtual bool execute()
     {
-        std::string result = executeShellCommand(std::string("svn status ") + m_path);
+        std::string command = std::string("svn status ") + m_path;
+        if(isScoped())
+        {
+            command = "svn status --depth " + m_depth;
+            for(const std::string& target : m_targets)
+            {
+                command += " \"" + target + "\"";
+            }
+        }
+
+        int nExitCode = 0;
+        std::string result = executeShellCommand(command, nExitCode);
+
+        //a clean working copy prints nothing; scoped targets that were deleted meanwhile only produce warnings
+        if(result.empty() && (nExitCode == 0 || isScoped()))
+        {
+            m_changes.clear();
+            return true;
+        }
+
+        return parse(result);
+    }
+
+    bool isScoped() const
+    {
+        return !m_targets.empty();
+    }
+
+    const std::list<std::string>& getTargets() const
+    {
+        return m_targets;
+    }
+
+    //true when the status of path was checked by this command, so a missing entry means the item is clean
+    bool covers(const std::string& path) const
+    {
+        if(!isScoped())
+            return true;
+
+        for(const std::string& target : m_targets)
+        {
+            if(path == target)
+                return true;
+
+            if(m_depth == "infinity" && path.length() > target.length() && path[target.length()] == '/'
+                    && path.compare(0, target.length(), target) == 0)
+                return true;
+        }
+
+        return false;
+    }
+
+    bool parse(const std::string& result)
+    {
         if(result.empty())
         {
             return false;
         }
 
-        std::istringstream stringStream(result);
-        std::string revisionPart;
-        while(getline(stringStream, revisionPart, '\n'))
+        m_changes.clear();
+
+        LineReader reader(result);
+        StringRef line;
+        while(reader.next(line))
         {
-            ChangeInfo info;
-            info.m_Status = revisionPart.substr(0, 1);
-            info.m_AffectedItem = revisionPart.substr(1);
-            while(info.m_AffectedItem.size() && info.m_AffectedItem[0] == ' ')
+            if(line.empty())
             {
-                info.m_AffectedItem = info.m_AffectedItem.substr(1);
+                continue;
             }
 
-            m_changes.push_back(info);
+            m_changes.push_back(ChangeInfo());
+            ChangeInfo& info = m_changes.back();
+            line.substr(0, 1).assignTo(info.m_Status);
+            line.substr(1).trimLeft().assignTo(info.m_AffectedItem);
         }
         return true;
     }
@@ -299,6 +543,8 @@ public:
 
 private:
     ChangeInfo::Collection m_changes;
+    const std::list<std::string> m_targets;
+    const std::string m_depth;
 };
 
 class DiffSvnCommand : public SvnCommand
@@ -315,14 +561,22 @@ public:
     {
         std::stringstream ss; ss << m_nRevision;
         std::string result = executeShellCommand(std::string("svn diff ") + m_path + " -c " + ss.str() + " --summarize");
+
+        return parse(result);
+    }
+
+    bool parse(const std::string& result)
+    {
         if(result.empty())
             return false;
 
-        std::istringstream stringStream(result);
-        std::string revisionPart;
-        while(getline(stringStream, revisionPart, '\n'))
+        m_affectedItems.clear();
+
+        LineReader reader(result);
+        StringRef line;
+        while(reader.next(line))
         {
-            m_affectedItems.push_back(revisionPart);
+            m_affectedItems.push_back(line.toString());
         }
         return true;
     }
@@ -341,6 +595,81 @@ private:
     std::list<std::string> m_affectedItems;
 };
 
+//files changed and lines added / removed by a revision, counted while its diff streams in
+class DiffStatSvnCommand : public SvnCommand
+{
+public:
+    DiffStatSvnCommand(const std::string& path, int nRevision)
+        : SvnCommand(path)
+        , m_nRevision(nRevision)
+        , m_bInHeader(false)
+        , m_bInProperties(false)
+    {
+        m_stats.m_nChangedFiles = m_stats.m_nAddedLines = m_stats.m_nRemovedLines = 0;
+    }
+
+    virtual std::string getType() const { return "svn diff stats"; }
+    virtual bool execute()
+    {
+        //no context lines, and the output is not logged: only the counts are wanted
+        std::stringstream ss;
+        ss << "svn diff " << m_path << " -c " << m_nRevision << " --internal-diff -x -U0 --non-interactive";
+        std::string result;
+        int nExitCode = SvnBackend::instance()->executeStreaming(ss.str(), [this](const StringRef& line) { parseLine(line); }, result);
+
+        std::stringstream ssLog;
+        ssLog << "========================================\nExecuting command:\n" << ss.str() << ". Counted " << m_stats.m_nChangedFiles
+              << " files, +" << m_stats.m_nAddedLines << " -" << m_stats.m_nRemovedLines << " lines, exit code " << nExitCode << "\n";
+        Logger::instance()->logCommandMessage(ssLog.str());
+        return nExitCode == 0;
+    }
+
+    //"Index: <path>", headers up to the first "@@" of the file, then "+" / "-" lines; property sections are skipped
+    void parseLine(const StringRef& line)
+    {
+        if(line.startsWith("Index: "))
+        {
+            m_stats.m_nChangedFiles++;
+            m_bInHeader = true;
+            m_bInProperties = false;
+        }
+        else
+        if(line.startsWith("Property changes on: "))
+        {
+            m_bInProperties = true;
+        }
+        else
+        if(m_bInProperties)
+        {
+        }
+        else
+        if(line.startsWith("@@"))
+        {
+            m_bInHeader = false;
+        }
+        else
+        if(!m_bInHeader && line.size() && line[0] == '+')
+        {
+            m_stats.m_nAddedLines++;
+        }
+        else
+        if(!m_bInHeader && line.size() && line[0] == '-')
+        {
+            m_stats.m_nRemovedLines++;
+        }
+    }
+
+    const std::string& getPath() const { return m_path; }
+    int getRevision() const { return m_nRevision; }
+    const RevisionStats& getStats() const { return m_stats; }
+
+private:
+    int m_nRevision;
+    RevisionStats m_stats;
+    bool m_bInHeader;
+    bool m_bInProperties;
+};
+
 class LaunchDiffViewerSvnCommand : public SvnCommand
 {
 public:
@@ -360,13 +689,316 @@ public:
         {
             ss << " -c " << m_nRevision;
         }
-        ss << " &";
-        system(ss.str().c_str());
+        SvnBackend::instance()->launchDetached(ss.str());
+        return true;
+    }
+
+private:
+    int m_nRevision;
+};
+
+//fetches both sides of one file and diffs them on the worker thread: a revision against the one before it,
+//or (nRevision == -1) the working copy file against its BASE
+class FileDiffSvnCommand : public SvnCommand
+{
+public:
+    FileDiffSvnCommand(const std::string& path, int nRevision, const std::string& cacheKey,
+                       std::shared_ptr<PristineStore> spPristineStore = std::shared_ptr<PristineStore>())
+        : SvnCommand(path)
+        , m_nRevision(nRevision)
+        , m_cacheKey(cacheKey)
+        , m_spPristineStore(spPristineStore)
+        , m_spDiff(new TextDiff())
+    {
+    }
+
+    virtual std::string getType() const { return "svn cat"; }
+    virtual bool execute()
+    {
+        std::string oldText, newText;
+        bool bOld = false, bNew = false;
+        if(m_nRevision == -1)
+        {
+            //the BASE text is on disk already, svn is only asked when the pristine store can't serve it
+            bOld = (m_spPristineStore && m_spPristineStore->readBase(m_path, oldText)) || cat("BASE", oldText);
+            bNew = readWorkingFile(newText);
+        }
+        else
+        {
+            std::stringstream ssOld; ssOld << m_nRevision - 1;
+            std::stringstream ssNew; ssNew << m_nRevision;
+            bOld = m_nRevision > 1 && cat(ssOld.str(), oldText);
+            bNew = cat(ssNew.str(), newText);
+        }
+
+        //a file added or deleted exists on one side only
+        if(!bOld && !bNew)
+            return false;
+
+        m_spDiff->compute(std::move(oldText), std::move(newText));
+        return true;
+    }
+
+    const std::string& getPath() const { return m_path; }
+    int getRevision() const { return m_nRevision; }
+    std::shared_ptr<const TextDiff> getDiff() const { return m_spDiff; }
+
+private:
+    bool cat(const std::string& revision, std::string& content)
+    {
+        return catFile(m_path, revision, m_cacheKey, content);
+    }
+
+    bool readWorkingFile(std::string& content)
+    {
+        std::ifstream file(m_path.c_str(), std::ios_base::in | std::ios_base::binary);
+        if(!file)
+            return false;
+
+        std::stringstream ss;
+        ss << file.rdbuf();
+        content = ss.str();
+        return true;
+    }
+
+private:
+    int m_nRevision;
+    std::string m_cacheKey;
+    std::shared_ptr<PristineStore> m_spPristineStore;
+    std::shared_ptr<TextDiff> m_spDiff;
+};
+
+class BlameSvnCommandObserver
+{
+public:
+    //called from the thread running the blame with the lines nFirstLine.. as they arrive
+    virtual void onBlameLines(const std::string& path, int nRevision, int nFirstLine, const BlameLine::Collection& lines) = 0;
+};
+
+//svn blame of a file at a revision (-1 = BASE), streamed to the observer. With a cache key the result is kept in
+//the file revision cache; a blame at N is then derived from a cached blame at N-1 and the diff between both
+//contents, which needs the author of N for the lines N changed
+class BlameSvnCommand : public SvnCommand
+{
+public:
+    BlameSvnCommand(const std::string& path, int nRevision, const std::string& cacheKey, const std::string& author,
+                    BlameSvnCommandObserver* pObserver)
+        : SvnCommand(path)
+        , m_nRevision(nRevision)
+        , m_cacheKey(cacheKey)
+        , m_author(author)
+        , m_nDeliveredLines(0)
+        , m_bDerived(false)
+        , m_pObserver(pObserver)
+    {
+    }
+
+    virtual std::string getType() const { return "svn blame"; }
+    virtual bool execute()
+    {
+        std::string cached;
+        bool bCacheable = !m_cacheKey.empty() && m_nRevision > 0;
+        if(bCacheable && FileRevisionCache::instance()->get(getBlameKey(m_nRevision), cached))
+        {
+            parse(cached, m_lines);
+            deliverLines();
+            return true;
+        }
+
+        if(bCacheable && m_nRevision > 1 && FileRevisionCache::instance()->get(getBlameKey(m_nRevision - 1), cached) && derive(cached))
+        {
+            m_bDerived = true;
+            FileRevisionCache::instance()->put(getBlameKey(m_nRevision), format(m_lines));
+            deliverLines();
+            return true;
+        }
+
+        std::stringstream ss;
+        if(m_nRevision == -1)
+            ss << "BASE";
+        else
+            ss << m_nRevision;
+
+        int nExitCode = 0;
+        m_lastDelivery = std::chrono::steady_clock::time_point();
+        executeStreamingShellCommand(std::string("svn blame \"") + m_path + "@" + ss.str() + "\" --non-interactive",
+                                     [this](const StringRef& line) { onLine(line); }, nExitCode);
+        deliverLines();
+        if(nExitCode != 0)
+            return false;
+
+        if(bCacheable)
+        {
+            FileRevisionCache::instance()->put(getBlameKey(m_nRevision), format(m_lines));
+        }
+        return true;
+    }
+
+    //"%6ld %10s <text>", the revision is "-" for lines svn knows nothing about
+    static bool parseLine(const StringRef& line, BlameLine& blameLine)
+    {
+        StringRef rest = line.trimLeft();
+        size_t nEnd = rest.find(' ');
+        if(nEnd == StringRef::npos || !nEnd)
+            return false;
+
+        blameLine.m_nRevision = rest[0] == '-' ? -1 : rest.substr(0, nEnd).toInt();
+        rest = rest.substr(nEnd).trimLeft();
+        nEnd = rest.find(' ');
+        if(nEnd == StringRef::npos)
+            nEnd = rest.size();
+
+        rest.substr(0, nEnd).assignTo(blameLine.m_Author);
+        rest.substr(nEnd + 1).assignTo(blameLine.m_Text);
+        return true;
+    }
+
+    static void parse(const std::string& result, BlameLine::Collection& lines)
+    {
+        LineReader reader(result);
+        StringRef line;
+        BlameLine blameLine;
+        while(reader.next(line))
+        {
+            if(parseLine(line, blameLine))
+                lines.push_back(blameLine);
+        }
+    }
+
+    static std::string format(const BlameLine::Collection& lines)
+    {
+        std::string result;
+        char prefix[32];
+        for(const BlameLine& line : lines)
+        {
+            if(line.m_nRevision == -1)
+                snprintf(prefix, sizeof(prefix), "%6s ", "-");
+            else
+                snprintf(prefix, sizeof(prefix), "%6d ", line.m_nRevision);
+
+            result += prefix;
+            if(line.m_Author.size() < 10)
+                result.append(10 - line.m_Author.size(), ' ');
+            result += (line.m_Author.empty() ? std::string("-") : line.m_Author) + " " + line.m_Text + "\n";
+        }
+        return result;
+    }
+
+    const std::string& getPath() const { return m_path; }
+    int getRevision() const { return m_nRevision; }
+    int getLinesCount() const { return static_cast<int>(m_lines.size()); }
+    //true when the blame came from the cached blame of the previous revision instead of svn
+    bool isDerived() const { return m_bDerived; }
+
+private:
+    std::string getBlameKey(int nRevision) const
+    {
+        std::stringstream ss;
+        ss << "blame " << m_cacheKey << "@" << nRevision;
+        return ss.str();
+    }
+
+    void onLine(const StringRef& line)
+    {
+        BlameLine blameLine;
+        if(!parseLine(line, blameLine))
+            return;
+
+        m_lines.push_back(blameLine);
+        //the first lines go out at once, the rest in batches
+        if(m_nDeliveredLines == 0 || std::chrono::steady_clock::now() - m_lastDelivery >= std::chrono::milliseconds(100))
+        {
+            deliverLines();
+        }
+    }
+
+    void deliverLines()
+    {
+        m_lastDelivery = std::chrono::steady_clock::now();
+        if(!m_pObserver || m_nDeliveredLines == static_cast<int>(m_lines.size()))
+            return;
+
+        BlameLine::Collection lines(m_lines.begin() + m_nDeliveredLines, m_lines.end());
+        m_pObserver->onBlameLines(m_path, m_nRevision, m_nDeliveredLines, lines);
+        m_nDeliveredLines = static_cast<int>(m_lines.size());
+    }
+
+    //unchanged lines keep their blame, the inserted ones belong to m_nRevision
+    bool derive(const std::string& previousBlame)
+    {
+        BlameLine::Collection oldLines;
+        parse(previousBlame, oldLines);
+
+        std::stringstream ss;
+        ss << m_nRevision;
+        std::string newText;
+        if(!catFile(m_path, ss.str(), m_cacheKey, newText))
+            return false;
+
+        //blame drops the carriage returns
+        newText.erase(std::remove(newText.begin(), newText.end(), '\r'), newText.end());
+        //nor does it tell whether the file ends with a newline: the old text rebuilt below always does, a
+        //difference there would mark the unchanged last line as changed
+        if(!newText.empty() && newText[newText.size() - 1] != '\n')
+        {
+            newText += '\n';
+        }
+
+        std::string oldText;
+        for(const BlameLine& line : oldLines)
+        {
+            oldText += line.m_Text + "\n";
+        }
+
+        TextDiff diff;
+        diff.compute(std::move(oldText), std::move(newText));
+        if(diff.isBinary())
+            return false;
+
+        //without the author the inserted lines cannot be blamed, svn blame runs instead
+        if(diff.getInsertedLinesCount() && m_author.empty())
+            return false;
+
+        BlameLine::Collection lines;
+        int nOldLine = 0, nNewLine = 0;
+        auto copyUnchanged = [&](int nNewEnd)
+        {
+            for(; nNewLine < nNewEnd; nNewLine++, nOldLine++)
+            {
+                BlameLine line = oldLines[nOldLine];
+                diff.getNewLine(nNewLine).assignTo(line.m_Text);
+                lines.push_back(line);
+            }
+        };
+
+        for(const TextDiff::Hunk& hunk : diff.getHunks())
+        {
+            copyUnchanged(hunk.m_nNewStart);
+            for(int i = 0; i < hunk.m_nNewCount; i++, nNewLine++)
+            {
+                BlameLine line;
+                line.m_nRevision = m_nRevision;
+                line.m_Author = m_author;
+                diff.getNewLine(nNewLine).assignTo(line.m_Text);
+                lines.push_back(line);
+            }
+            nOldLine += hunk.m_nOldCount;
+        }
+        copyUnchanged(diff.getNewLinesCount());
+
+        m_lines.swap(lines);
         return true;
     }
 
 private:
     int m_nRevision;
+    std::string m_cacheKey;
+    std::string m_author;
+    BlameLine::Collection m_lines;
+    int m_nDeliveredLines;
+    std::chrono::steady_clock::time_point m_lastDelivery;
+    bool m_bDerived;
+    BlameSvnCommandObserver* m_pObserver;
 };
 
 class ListSvnCommand : public SvnCommand
@@ -374,6 +1006,8 @@ class ListSvnCommand : public SvnCommand
 public:
     ListSvnCommand(const std::string& path, RepoItemInfo::SmartPtr repoInfo)
         : SvnCommand(path)
+        , m_nReleasedBytes(0)
+        , m_nListedBytes(0)
     {
         m_repoInfo = repoInfo;
     }
@@ -382,27 +1016,35 @@ public:
     virtual bool execute()
     {
         std::string result = executeShellCommand(std::string("svn list ") + m_repoInfo->getFullPath());
+
+        return parse(result);
+    }
+
+    bool parse(const std::string& result)
+    {
         if(result.empty())
         {
             return false;
         }
 
-        std::istringstream stringStream(result);
-        std::string repoItem;
+        LineReader reader(result);
+        StringRef repoItem;
+        m_nReleasedBytes = m_repoInfo->getMemoryUsage();
         m_repoInfo->m_subItems.clear();
-        while(getline(stringStream, repoItem, '\n'))
+        while(reader.next(repoItem))
         {
-            if(repoItem.length())
+            if(repoItem.size())
             {
                 RepoItemInfo::ItemType itemType = RepoItemInfo::File;
-                if(repoItem[repoItem.length() - 1] == '/')
+                if(repoItem.endsWith('/'))
                 {
                     itemType = RepoItemInfo::Directory;
                 }
 
-                m_repoInfo->m_subItems.push_back(RepoItemInfo::SmartPtr(new RepoItemInfo(m_repoInfo.get(), repoItem, itemType)));
+                m_repoInfo->m_subItems.push_back(RepoItemInfo::SmartPtr(new RepoItemInfo(m_repoInfo.get(), repoItem.toString(), itemType)));
             }
         }
+        m_nListedBytes = m_repoInfo->getMemoryUsage();
         return true;
     }
 
@@ -410,8 +1052,15 @@ public:
     {
         return  m_repoInfo;
     }
+
+    //memory of the listed node before and after the listing replaced its children
+    size_t getReleasedBytes() const { return m_nReleasedBytes; }
+    size_t getListedBytes() const { return m_nListedBytes; }
+
 private:
     RepoItemInfo::SmartPtr m_repoInfo;
+    size_t m_nReleasedBytes;
+    size_t m_nListedBytes;
 };
 
 class InfoSvnCommand : public SvnCommand
@@ -427,39 +1076,46 @@ public:
     virtual bool execute()
     {
         std::string result = executeShellCommand(std::string("svn info ") + m_path);
-        if(result.empty())
-            return false;
 
-        size_t nPos = result.find("Last Changed Rev: ");
-        if(nPos == std::string::npos)
-        {
-            return false;
-        }
+        return parse(result);
+    }
 
-        size_t nEndPos = result.find("\n", nPos);
-        if(nEndPos == std::string::npos)
-        {
+    bool parse(const std::string& result)
+    {
+        if(result.empty())
             return false;
-        }
-
-        m_nCurrentRevision = atoi(result.substr(nPos + 17, nEndPos - nPos - 17).c_str());
-
 
-        nPos = result.find("URL: ");
-        if(nPos == std::string::npos)
-        {
-            return false;
-        }
+        bool bRevisionFound = false;
+        bool bUrlFound = false;
 
-        nEndPos = result.find("\n", nPos);
-        if(nEndPos == std::string::npos)
+        LineReader reader(result);
+        StringRef line;
+        while(reader.next(line))
         {
-            return false;
+            if(line.startsWith("Last Changed Rev: "))
+            {
+                m_nCurrentRevision = line.substr(18).toInt();
+                bRevisionFound = true;
+            }
+            else
+            if(line.startsWith("URL: "))
+            {
+                line.substr(5).assignTo(m_repoURL);
+                bUrlFound = true;
+            }
+            else
+            if(line.startsWith("Repository Root: "))
+            {
+                line.substr(17).assignTo(m_repoRoot);
+            }
+            else
+            if(line.startsWith("Repository UUID: "))
+            {
+                line.substr(17).assignTo(m_repoUuid);
+            }
         }
 
-        m_repoURL = result.substr(nPos + 5, nEndPos - nPos - 5);
-
-        return true;
+        return bRevisionFound && bUrlFound;
     }
 
     int getCurrentRevision() const
@@ -472,17 +1128,59 @@ public:
         return m_repoURL;
     }
 
-private:
+    std::string getRepoRoot() const
+    {
+        return m_repoRoot;
+    }
+
+    std::string getRepoUuid() const
+    {
+        return m_repoUuid;
+    }
+
+protected:
     int m_nCurrentRevision;
     std::string m_repoURL;
+    std::string m_repoRoot;
+    std::string m_repoUuid;
+};
+
+//asks the server for the last revision that changed the url; much cheaper than a log
+class HeadInfoSvnCommand : public InfoSvnCommand
+{
+public:
+    HeadInfoSvnCommand(const std::string& repoUrl)
+        : InfoSvnCommand(repoUrl)
+    {
+    }
+
+    virtual std::string getType() const { return "svn info -r HEAD"; }
+    virtual bool execute()
+    {
+        std::string result = executeShellCommand(std::string("svn info -r HEAD ") + m_path + " --non-interactive");
+
+        return parse(result);
+    }
+};
+
+class UpdateSvnCommandObserver
+{
+public:
+    //called from the thread running the update, once per output line naming an item;
+    //m_Status holds the action: U, A, D, C (conflict), G (merged), E (existed) or ! (missing item restored)
+    virtual void onItemUpdated(const ChangeInfo& item) = 0;
 };
 
 class UpdateSvnCommand : public SvnCommand
 {
 public:
-    UpdateSvnCommand(const std::string& path, int nRevision = -1 /*convention -1 = HEAD*/)
+    UpdateSvnCommand(const std::string& path, int nRevision = -1 /*convention -1 = HEAD*/, UpdateSvnCommandObserver* pObserver = nullptr)
         : SvnCommand(path)
         , m_nRevision(nRevision)
+        , m_nUpdatedRevision(-1)
+        , m_nUpdatedItems(0)
+        , m_pObserver(pObserver)
+        , m_bSucceeded(false)
     {
     }
 
@@ -494,15 +1192,95 @@ public:
         {
             ss << " -r " << m_nRevision;
         }
-        std::string result = executeShellCommand(std::string("svn update ") + m_path + ss.str() + " --non-interactive");
-        if(result.empty())
+
+        int nExitCode = 0;
+        executeStreamingShellCommand(std::string("svn update ") + m_path + ss.str() + " --non-interactive",
+                                     [this](const StringRef& line) { parseLine(line); }, nExitCode);
+        m_bSucceeded = nExitCode == 0;
+        return m_bSucceeded;
+    }
+
+    //an observer received every item while a complete update ran, so only the state nobody was told about is stale;
+    //after an interrupted update, or one that did not report its revision, everything is read again
+    virtual Invalidation getInvalidation() const
+    {
+        Invalidation invalidation;
+        if(!m_pObserver || !m_bSucceeded || m_nUpdatedRevision == -1)
+        {
+            invalidation.m_bWorkingCopyInfo = true;
+            invalidation.m_bRepoContent = true;
+            invalidation.m_bFullStatus = true;
+        }
+        return invalidation;
+    }
+
+    //"U    path", " U   path" (properties), "   C path" (tree conflict), "Restored 'path'", "Updated to revision N.",
+    //"At revision N."
+    bool parseLine(const StringRef& line)
+    {
+        if(line.startsWith("Updated to revision "))
+        {
+            m_nUpdatedRevision = line.substr(20).toInt();
+            return true;
+        }
+
+        if(line.startsWith("At revision "))
+        {
+            m_nUpdatedRevision = line.substr(12).toInt();
+            return true;
+        }
+
+        if(line.startsWith("Restored '") && line.size() > 11 && line[line.size() - 1] == '\'')
+        {
+            ChangeInfo item;
+            item.m_Status = "!";
+            line.substr(10, line.size() - 11).assignTo(item.m_AffectedItem);
+            m_nUpdatedItems++;
+
+            if(m_pObserver)
+            {
+                m_pObserver->onItemUpdated(item);
+            }
+            return true;
+        }
+
+        if(line.size() <= 5 || line[4] != ' ' || !strchr(" UADCGER", line[0]) || !strchr(" UCG", line[1])
+                || !strchr(" B", line[2]) || !strchr(" C", line[3]) || line.substr(0, 4).trimLeft().empty())
+        {
             return false;
+        }
+
+        ChangeInfo item;
+        //a lock change alone ("  B  path") counts as an update of the item
+        char action = line[3] == 'C' ? 'C' : line[0] != ' ' ? line[0] : line[1] != ' ' ? line[1] : 'U';
+        item.m_Status = std::string(1, action);
+        line.substr(5).assignTo(item.m_AffectedItem);
+        m_nUpdatedItems++;
 
+        if(m_pObserver)
+        {
+            m_pObserver->onItemUpdated(item);
+        }
         return true;
     }
 
+    //the revision the working copy is at after the update, -1 when svn did not report it
+    int getUpdatedRevision() const
+    {
+        return m_nUpdatedRevision;
+    }
+
+    int getUpdatedItemsCount() const
+    {
+        return m_nUpdatedItems;
+    }
+
 private:
     int m_nRevision;
+    int m_nUpdatedRevision;
+    int m_nUpdatedItems;
+    UpdateSvnCommandObserver* m_pObserver;
+    bool m_bSucceeded;
 };
 
 class AddSvnCommand : public SvnCommand
@@ -524,6 +1302,13 @@ public:
         return true;
     }
 
+    virtual Invalidation getInvalidation() const
+    {
+        Invalidation invalidation;
+        invalidation.m_statusPaths.insert(m_addItem);
+        return invalidation;
+    }
+
 private:
     std::string m_addItem;
 };
@@ -547,6 +1332,13 @@ public:
         return true;
     }
 
+    virtual Invalidation getInvalidation() const
+    {
+        Invalidation invalidation;
+        invalidation.m_statusPaths.insert(m_revertItem);
+        return invalidation;
+    }
+
 private:
     std::string m_revertItem;
 };
@@ -558,6 +1350,7 @@ public:
         : SvnCommand(path)
         , m_commitItems(commitItems)
         , m_message(message)
+        , m_nCommittedRevision(-1)
     {
     }
 
@@ -593,12 +1386,86 @@ public:
             return false;
         }
 
+        parse(result);
+        if(m_nCommittedRevision != -1)
+        {
+            readCommitInfo();
+        }
+
         return true;
     }
 
+    //"Committed revision N." is the last line of a successful commit
+    bool parse(const std::string& result)
+    {
+        LineReader reader(result);
+        StringRef line;
+        while(reader.next(line))
+        {
+            if(line.startsWith("Committed revision "))
+            {
+                m_nCommittedRevision = line.substr(19).toInt();
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    //with the revision number known SvnViewer applies the commit itself; otherwise the committed items
+    //are checked again and the server is asked for the new revision
+    virtual Invalidation getInvalidation() const
+    {
+        Invalidation invalidation;
+        if(m_nCommittedRevision == -1)
+        {
+            invalidation.m_statusPaths.insert(m_commitItems.begin(), m_commitItems.end());
+            invalidation.m_bRevisions = true;
+        }
+        return invalidation;
+    }
+
+    int getCommittedRevision() const { return m_nCommittedRevision; }
+    const std::list<std::string>& getCommitItems() const { return m_commitItems; }
+    const std::string& getMessage() const { return m_message; }
+    const std::string& getAuthor() const { return m_author; }
+    const std::string& getDate() const { return m_date; }
+
+private:
+    //the working copy records author and date of the items it just committed, so no server round trip is needed
+    void readCommitInfo()
+    {
+        for(const std::string& item : m_commitItems)
+        {
+            std::string result = executeShellCommand(std::string("svn info \"") + item + "\"");
+
+            LineReader reader(result);
+            StringRef line;
+            while(reader.next(line))
+            {
+                if(line.startsWith("Last Changed Author: "))
+                    line.substr(21).assignTo(m_author);
+                else
+                if(line.startsWith("Last Changed Date: "))
+                    line.substr(19).assignTo(m_date);
+            }
+
+            //deleted items have no info left, try the next one
+            if(!m_author.empty())
+                return;
+        }
+
+        std::stringstream ss;
+        ss << "svn propget --revprop -r " << m_nCommittedRevision << " svn:author \"" << m_path << "\"";
+        StringRef(executeShellCommand(ss.str())).trimRight('\n').assignTo(m_author);
+    }
+
 private:
     const std::list<std::string> m_commitItems;
     const std::string m_message;
+    int m_nCommittedRevision;
+    std::string m_author;
+    std::string m_date;
 };
 
 #endif // SVNCOMMANDS_H
@@ -0,0 +1,191 @@
+#ifndef SVNPARSERS_H
+#define SVNPARSERS_H
+
+#include <string>
+#include <cstring>
+
+//non-owning view into the output buffer of an svn command; valid only while the buffer lives
+class StringRef
+{
+public:
+    static const size_t npos = static_cast<size_t>(-1);
+
+    StringRef()
+        : m_pData(nullptr)
+        , m_nSize(0)
+    {
+    }
+
+    StringRef(const char* pData, size_t nSize)
+        : m_pData(pData)
+        , m_nSize(nSize)
+    {
+    }
+
+    StringRef(const std::string& str)
+        : m_pData(str.data())
+        , m_nSize(str.size())
+    {
+    }
+
+    const char* data() const { return m_pData; }
+    size_t size() const { return m_nSize; }
+    bool empty() const { return m_nSize == 0; }
+    char operator[](size_t nPos) const { return m_pData[nPos]; }
+    const char* begin() const { return m_pData; }
+    const char* end() const { return m_pData + m_nSize; }
+
+    StringRef substr(size_t nPos, size_t nCount = npos) const
+    {
+        if(nPos > m_nSize)
+            nPos = m_nSize;
+
+        if(nCount > m_nSize - nPos)
+            nCount = m_nSize - nPos;
+
+        return StringRef(m_pData + nPos, nCount);
+    }
+
+    size_t find(char c, size_t nPos = 0) const
+    {
+        if(nPos >= m_nSize)
+            return npos;
+
+        const void* pFound = memchr(m_pData + nPos, c, m_nSize - nPos);
+        return pFound ? static_cast<const char*>(pFound) - m_pData : npos;
+    }
+
+    size_t find(const char* pNeedle, size_t nPos = 0) const
+    {
+        size_t nNeedle = strlen(pNeedle);
+        if(!nNeedle)
+            return nPos <= m_nSize ? nPos : npos;
+
+        while(nPos + nNeedle <= m_nSize)
+        {
+            nPos = find(pNeedle[0], nPos);
+            if(nPos == npos || nPos + nNeedle > m_nSize)
+                return npos;
+
+            if(memcmp(m_pData + nPos, pNeedle, nNeedle) == 0)
+                return nPos;
+
+            nPos++;
+        }
+
+        return npos;
+    }
+
+    size_t rfind(const char* pNeedle) const
+    {
+        size_t nNeedle = strlen(pNeedle);
+        if(nNeedle > m_nSize)
+            return npos;
+
+        for(size_t nPos = m_nSize - nNeedle + 1; nPos-- > 0;)
+        {
+            if(memcmp(m_pData + nPos, pNeedle, nNeedle) == 0)
+                return nPos;
+        }
+
+        return npos;
+    }
+
+    bool startsWith(const char* pPrefix) const
+    {
+        size_t nPrefix = strlen(pPrefix);
+        return nPrefix <= m_nSize && memcmp(m_pData, pPrefix, nPrefix) == 0;
+    }
+
+    bool endsWith(char c) const
+    {
+        return m_nSize && m_pData[m_nSize - 1] == c;
+    }
+
+    StringRef trimLeft(char c = ' ') const
+    {
+        size_t nPos = 0;
+        while(nPos < m_nSize && m_pData[nPos] == c)
+            nPos++;
+
+        return StringRef(m_pData + nPos, m_nSize - nPos);
+    }
+
+    StringRef trimRight(char c = ' ') const
+    {
+        size_t nSize = m_nSize;
+        while(nSize && m_pData[nSize - 1] == c)
+            nSize--;
+
+        return StringRef(m_pData, nSize);
+    }
+
+    //same semantics as atoi: leading spaces, optional sign, digits up to the first non digit
+    int toInt() const
+    {
+        size_t nPos = 0;
+        while(nPos < m_nSize && (m_pData[nPos] == ' ' || m_pData[nPos] == '\t'))
+            nPos++;
+
+        bool bNegative = false;
+        if(nPos < m_nSize && (m_pData[nPos] == '-' || m_pData[nPos] == '+'))
+        {
+            bNegative = m_pData[nPos] == '-';
+            nPos++;
+        }
+
+        int nValue = 0;
+        while(nPos < m_nSize && m_pData[nPos] >= '0' && m_pData[nPos] <= '9')
+        {
+            nValue = nValue * 10 + (m_pData[nPos] - '0');
+            nPos++;
+        }
+
+        return bNegative ? -nValue : nValue;
+    }
+
+    std::string toString() const
+    {
+        return std::string(m_pData, m_nSize);
+    }
+
+    void assignTo(std::string& target) const
+    {
+        target.assign(m_pData, m_nSize);
+    }
+
+private:
+    const char* m_pData;
+    size_t m_nSize;
+};
+
+//splits a buffer into lines in place; lines do not include the '\n' terminator
+class LineReader
+{
+public:
+    explicit LineReader(const StringRef& buffer)
+        : m_pCurrent(buffer.data())
+        , m_pEnd(buffer.data() + buffer.size())
+    {
+    }
+
+    bool next(StringRef& line)
+    {
+        if(m_pCurrent >= m_pEnd)
+            return false;
+
+        const char* pLineEnd = static_cast<const char*>(memchr(m_pCurrent, '\n', m_pEnd - m_pCurrent));
+        if(!pLineEnd)
+            pLineEnd = m_pEnd;
+
+        line = StringRef(m_pCurrent, pLineEnd - m_pCurrent);
+        m_pCurrent = pLineEnd + 1;
+        return true;
+    }
+
+private:
+    const char* m_pCurrent;
+    const char* m_pEnd;
+};
+
+#endif // SVNPARSERS_H
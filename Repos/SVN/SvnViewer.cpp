@@ -1,5 +1,21 @@
 #include "SvnViewer.h"
 #include <unistd.h>
+#include <sys/stat.h>
+#include <vector>
+#include <algorithm>
+#include <map>
+
+//targets passed to one scoped svn status invocation
+static const size_t MAX_STATUS_TARGETS = 100;
+//updated items are handed to the views at most this often
+static const int UPDATE_APPLY_INTERVAL_MS = 100;
+//svn cat processes running at once for a review
+static const int REVIEW_STAGING_THREADS = 4;
+static const int HISTORY_SEARCH_THREADS = 4;
+//background "svn diff -c" runs computing revision statistics
+static const int MAX_STATS_JOBS = 2;
+//prefetches of affected items, they leave room for the fetches the user waits for
+static const int MAX_PREFETCH_JOBS = 2;
 
 SvnViewer* SvnViewer::instance()
 {
@@ -13,18 +29,28 @@ SvnViewer::SvnViewer()
     m_nRevisionsCount = 2500;
     m_currentRevision = -1;
     m_closing = false;
+    m_nMemoryBudget = static_cast<size_t>(AppSettings::instance()->getIntValue("memoryBudgetMB", 64)) * 1024 * 1024;
+    m_nAccessCounter = 0;
+    m_bLocalStatusKnown = false;
+    m_bStatusRunning = false;
+    m_bFullStatusPending = false;
+    m_nHeadRevision = -1;
+    m_bRefreshPending = false;
+    m_nUpdateProgress = 0;
+    m_nStatsJobs = 0;
+    m_nReviewsCount = 0;
+    m_nHistorySearchesCount = 0;
+    m_bBackgroundPaused = false;
+    m_spWatcher.reset(new WorkingCopyWatcher(this));
 }
 
 SvnViewer::~SvnViewer()
 {
+    m_spWatcher->stop();
     m_closing = true;
     {
         std::unique_lock<std::recursive_mutex> locker(m_mutex);
-        for(threadParams* thread : m_asyncProcessThreads)
-        {
-            pthread_join(thread->thread, NULL);
-            delete thread;
-        }
+        m_asyncThreadsFinished.wait(locker, [this]() { return m_asyncProcessThreads.empty(); });
     }
 }
 
@@ -34,57 +60,1010 @@ bool SvnViewer::isInitialized()
     return !m_repoPath.empty();
 }
 
-void SvnViewer::init(const std::string& repoPath, int nRevisionsCount)
+bool SvnViewer::isWatchingWorkingCopy() const
+{
+    return m_spWatcher->isActive();
+}
+
+void SvnViewer::init(const std::string& repoPath, int nRevisionsCount)
+{
+    //the watcher thread reports changes under m_mutex, joining it while holding the lock would never return
+    m_spWatcher->stop();
+
+    std::unique_lock<std::recursive_mutex> locker(m_mutex);
+    m_repoPath = repoPath;
+    m_nRevisionsCount = nRevisionsCount;
+
+    m_repoContent.reset(new RepoItemInfo(nullptr, m_repoPath, RepoItemInfo::Directory));
+    m_memoryStats.m_nRepoContentBytes = m_repoContent->getMemoryUsage();
+    m_logUrl.clear();
+    m_repoRoot.clear();
+    m_repoUuid.clear();
+    m_bLocalStatusKnown = false;
+    m_prefetchQueue.clear();
+
+    m_spPristineStore.reset(new PristineStore());
+    if(!m_spPristineStore->open(m_repoPath))
+    {
+        Logger::instance()->logCommandMessage("No pristine store found for " + m_repoPath + ", local diffs run svn cat.");
+        m_spPristineStore.reset();
+    }
+    locker.unlock();
+
+    if(!m_spWatcher->start(repoPath))
+    {
+        Logger::instance()->logCommandMessage("Working copy watcher unavailable for " + repoPath + ", falling back to polling.");
+    }
+
+    refresh();
+}
+
+void SvnViewer::refresh()
+{
+    std::unique_lock<std::recursive_mutex> locker(m_mutex);
+    if(m_refreshPipeline.isRunning())
+    {
+        m_bRefreshPending = true;
+        return;
+    }
+
+    m_bRefreshPending = false;
+    const std::list<std::string> noDependencies;
+    const std::list<std::string> afterInfo(1, "info");
+
+    //only the log needs the url from svn info; status and the listing of the working copy start right away
+    m_refreshPipeline.addStep("info", noDependencies, [this]()
+    {
+        return launchAsync(new InfoSvnCommand(m_repoPath));
+    });
+
+    //once the tree is loaded it is listed again only when svn info reports a new working copy revision
+    const bool bContentLoaded = !m_repoContent->m_subItems.empty();
+    const int nPreviousRevision = m_currentRevision;
+    m_refreshPipeline.addStep("list", bContentLoaded ? afterInfo : noDependencies, [this, bContentLoaded, nPreviousRevision]() -> SvnCommand*
+    {
+        if(bContentLoaded && nPreviousRevision == m_currentRevision)
+            return nullptr;
+
+        return launchAsync(new ListSvnCommand(m_repoPath, m_repoContent));
+    });
+
+    m_refreshPipeline.addStep("status", noDependencies, [this]() -> SvnCommand*
+    {
+        if(m_bLocalStatusKnown && m_spWatcher->isActive())
+            return nullptr;
+
+        m_bFullStatusPending = true;
+        m_pendingStatusPaths.clear();
+        m_pendingRecursiveStatusPaths.clear();
+        return launchNextStatus();
+    });
+
+    addRevisionsSteps(afterInfo);
+    runRefreshPipeline();
+}
+
+void SvnViewer::refreshRevisions()
+{
+    std::unique_lock<std::recursive_mutex> locker(m_mutex);
+    if(m_refreshPipeline.isRunning())
+    {
+        return;
+    }
+
+    if(m_repoUrl.empty())
+    {
+        refresh();
+        return;
+    }
+
+    addRevisionsSteps(std::list<std::string>());
+    runRefreshPipeline();
+}
+
+void SvnViewer::invalidate(const Invalidation& invalidation)
+{
+    if(invalidation.m_bFullStatus)
+    {
+        checkForModifications();
+    }
+    else
+    if(!invalidation.m_statusPaths.empty() && !m_bFullStatusPending)
+    {
+        m_pendingRecursiveStatusPaths.insert(invalidation.m_statusPaths.begin(), invalidation.m_statusPaths.end());
+        launchNextStatus();
+    }
+
+    if(!invalidation.m_bWorkingCopyInfo && !invalidation.m_bRepoContent && !invalidation.m_bRevisions)
+    {
+        return;
+    }
+
+    //a running graph may have read the state before the command changed it
+    if(m_refreshPipeline.isRunning())
+    {
+        m_bRefreshPending = true;
+        return;
+    }
+
+    std::list<std::string> revisionsDependencies;
+    if(invalidation.m_bWorkingCopyInfo)
+    {
+        m_refreshPipeline.addStep("info", std::list<std::string>(), [this]()
+        {
+            return launchAsync(new InfoSvnCommand(m_repoPath));
+        });
+        revisionsDependencies.push_back("info");
+    }
+
+    if(invalidation.m_bRepoContent)
+    {
+        m_refreshPipeline.addStep("list", std::list<std::string>(), [this]()
+        {
+            return launchAsync(new ListSvnCommand(m_repoPath, m_repoContent));
+        });
+    }
+
+    if(invalidation.m_bRevisions)
+    {
+        addRevisionsSteps(revisionsDependencies);
+    }
+
+    runRefreshPipeline();
+}
+
+void SvnViewer::addRevisionsSteps(const std::list<std::string>& dependencies)
+{
+    m_nHeadRevision = -1;
+    m_refreshPipeline.addStep("probe", dependencies, [this]() -> SvnCommand*
+    {
+        if(needsFullLog())
+            return nullptr;
+
+        return launchAsync(new HeadInfoSvnCommand(m_repoUrl));
+    });
+
+    m_refreshPipeline.addStep("log", std::list<std::string>(1, "probe"), [this]() -> SvnCommand*
+    {
+        if(!needsFullLog() && m_nHeadRevision <= getNewestRevision())
+        {
+            m_observer->onRepositoryUnchanged();
+            return nullptr;
+        }
+
+        m_logUrl = m_repoUrl;
+        return launchAsync(new LogSvnCommand(m_repoUrl, m_nRevisionsCount));
+    });
+}
+
+void SvnViewer::runRefreshPipeline()
+{
+    m_refreshPipeline.start();
+    onRefreshPipelineProgress();
+}
+
+void SvnViewer::onRefreshPipelineProgress()
+{
+    if(m_refreshPipeline.isRunning())
+    {
+        return;
+    }
+
+    Logger::instance()->logCommandMessage(m_refreshPipeline.getTimingReport());
+    if(m_bRefreshPending)
+    {
+        refresh();
+    }
+}
+
+bool SvnViewer::needsFullLog() const
+{
+    return m_revisionsList.empty() || m_logUrl != m_repoUrl;
+}
+
+bool SvnViewer::isRefreshing() const
+{
+    std::unique_lock<std::recursive_mutex> locker(m_mutex);
+    return m_refreshPipeline.isRunning();
+}
+
+long long SvnViewer::getLastRefreshDurationMs() const
+{
+    std::unique_lock<std::recursive_mutex> locker(m_mutex);
+    return m_refreshPipeline.getLastDurationMs();
+}
+
+void SvnViewer::refreshRepoContent()
+{
+    std::unique_lock<std::recursive_mutex> locker(m_mutex);
+    listContent(m_repoPath);
+}
+
+void SvnViewer::viewLog(const std::string &repoUrl)
+{
+    std::unique_lock<std::recursive_mutex> locker(m_mutex);
+    m_logUrl = repoUrl;
+    launchAsync(new LogSvnCommand(repoUrl, m_nRevisionsCount));
+}
+
+void SvnViewer::updateToHead()
+{
+    updateToRevision(-1);
+}
+
+void SvnViewer::updateToRevision(int nRevision)
+{
+    std::unique_lock<std::recursive_mutex> locker(m_mutex);
+    m_updatedItems.clear();
+    m_nUpdateProgress = 0;
+    m_lastUpdateApplied = std::chrono::steady_clock::now();
+    launchAsync(new UpdateSvnCommand(m_repoPath, nRevision, this));
+}
+
+void SvnViewer::onItemUpdated(const ChangeInfo& item)
+{
+    std::unique_lock<std::recursive_mutex> locker(m_mutex);
+    m_updatedItems.push_back(item);
+    m_nUpdateProgress++;
+
+    if(std::chrono::steady_clock::now() - m_lastUpdateApplied >= std::chrono::milliseconds(UPDATE_APPLY_INTERVAL_MS))
+    {
+        applyUpdatedItems();
+    }
+}
+
+void SvnViewer::applyUpdatedItems()
+{
+    m_lastUpdateApplied = std::chrono::steady_clock::now();
+    if(m_updatedItems.empty())
+    {
+        return;
+    }
+
+    LocalChangesDelta delta;
+    bool bTreeChanged = false;
+    for(const ChangeInfo& item : m_updatedItems)
+    {
+        const std::string& path = item.m_AffectedItem;
+        if(item.m_Status == "A" || item.m_Status == "E")
+        {
+            bTreeChanged |= addRepoNode(path);
+        }
+        else
+        if(item.m_Status == "D")
+        {
+            bTreeChanged |= removeRepoNode(path);
+
+            //local changes of a deleted item (and below it) are gone with it
+            for(ChangeInfo::Collection::iterator it = m_localChanges.begin(); it != m_localChanges.end();)
+            {
+                const std::string& changed = it->m_AffectedItem;
+                if(changed == path || (changed.length() > path.length() && changed[path.length()] == '/' && changed.compare(0, path.length(), path) == 0))
+                {
+                    delta.m_removed.push_back(*it);
+                    countLocalChangeMemory(*it, false);
+                    it = m_localChanges.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+        }
+        else
+        if(item.m_Status == "C")
+        {
+            ChangeInfo::Collection::iterator it = m_localChanges.begin();
+            while(it != m_localChanges.end() && it->m_AffectedItem != path)
+            {
+                ++it;
+            }
+
+            if(it == m_localChanges.end())
+            {
+                m_localChanges.push_back(item);
+                countLocalChangeMemory(item, true);
+                delta.m_added.push_back(item);
+            }
+            else
+            if(it->m_Status != "C")
+            {
+                it->m_Status = "C";
+                delta.m_changed.push_back(*it);
+            }
+        }
+        else
+        if(item.m_Status == "!")
+        {
+            //a restored item is back as it is in the repository
+            for(ChangeInfo::Collection::iterator it = m_localChanges.begin(); it != m_localChanges.end(); ++it)
+            {
+                if(it->m_AffectedItem == path && it->m_Status == "!")
+                {
+                    delta.m_removed.push_back(*it);
+                    countLocalChangeMemory(*it, false);
+                    m_localChanges.erase(it);
+                    break;
+                }
+            }
+        }
+        //U and G leave the local state as it was: clean stays clean, merged stays modified
+    }
+
+    std::string currentItem = m_updatedItems.back().m_AffectedItem;
+    m_updatedItems.clear();
+
+    if(!delta.empty())
+    {
+        m_observer->onLocalModificationsChanged(delta);
+    }
+
+    if(bTreeChanged)
+    {
+        m_observer->onRepoContentUpdated();
+    }
+
+    m_observer->onUpdateProgress(m_nUpdateProgress, currentItem);
+}
+
+Invalidation SvnViewer::applyCommit(const CommitSvnCommand* pCommand)
+{
+    RevisionInfo revision;
+    revision.m_No = pCommand->getCommittedRevision();
+    revision.m_Author = pCommand->getAuthor();
+    revision.m_Date = pCommand->getDate();
+    revision.m_Description = pCommand->getMessage();
+    revision.m_nLastAccess = ++m_nAccessCounter;
+
+    std::string rootPath = m_repoPath;
+    while(rootPath.length() > 1 && rootPath[rootPath.length() - 1] == '/')
+    {
+        rootPath.erase(rootPath.length() - 1);
+    }
+
+    //the committed entries leave the local change set and become the changed paths of the revision,
+    //in the "svn diff --summarize" form: status padded to 8 columns, then the url
+    LocalChangesDelta delta;
+    for(ChangeInfo::Collection::iterator it = m_localChanges.begin(); it != m_localChanges.end();)
+    {
+        const std::string& path = it->m_AffectedItem;
+        bool bCommitted = false;
+        for(const std::string& item : pCommand->getCommitItems())
+        {
+            if(path == item || (path.length() > item.length() && path[item.length()] == '/' && path.compare(0, item.length(), item) == 0))
+            {
+                bCommitted = true;
+                break;
+            }
+        }
+
+        //unversioned and ignored entries are never committed
+        if(!bCommitted || it->m_Status == "?" || it->m_Status == "I")
+        {
+            ++it;
+            continue;
+        }
+
+        if(path.compare(0, rootPath.length(), rootPath) == 0)
+        {
+            std::string status = it->m_Status;
+            status.resize(8, ' ');
+            revision.m_AffectedItems.push_back(status + m_repoUrl + path.substr(rootPath.length()));
+        }
+
+        delta.m_removed.push_back(*it);
+        countLocalChangeMemory(*it, false);
+        it = m_localChanges.erase(it);
+    }
+
+    if(!delta.empty())
+    {
+        m_observer->onLocalModificationsChanged(delta);
+    }
+
+    //only the log of the working copy root certainly contains the new revision. It is added alone only right
+    //after the newest one held: the HEAD probe would never fetch revisions committed by others in between
+    Invalidation invalidation;
+    if(m_logUrl == m_repoUrl && revision.m_No == getNewestRevision() + 1)
+    {
+        m_revisionsList.push_front(revision);
+        countRevisionMemory(revision, true);
+        while(m_revisionsList.size() > static_cast<size_t>(m_nRevisionsCount))
+        {
+            countRevisionMemory(m_revisionsList.back(), false);
+            m_revisionsList.pop_back();
+        }
+
+        enforceMemoryBudget();
+        m_observer->onRevisionsPrepended(1);
+        scheduleRevisionStats();
+    }
+    else
+    if(m_logUrl == m_repoUrl && revision.m_No > getNewestRevision())
+    {
+        invalidation.m_bRevisions = true;
+    }
+
+    return invalidation;
+}
+
+int SvnViewer::countPrependedRevisions(const RevisionInfo::Collection& oldRevisions) const
+{
+    if(oldRevisions.empty() || m_revisionsList.empty())
+    {
+        return -1;
+    }
+
+    //the old newest revision must be in the new list, followed by the old ones in the same order
+    int nPrepended = 0;
+    RevisionInfo::Collection::const_iterator newIt = m_revisionsList.begin();
+    while(newIt != m_revisionsList.end() && newIt->m_No != oldRevisions.front().m_No)
+    {
+        ++newIt;
+        nPrepended++;
+    }
+
+    for(RevisionInfo::Collection::const_iterator oldIt = oldRevisions.begin(); newIt != m_revisionsList.end(); ++newIt, ++oldIt)
+    {
+        if(oldIt == oldRevisions.end() || oldIt->m_No != newIt->m_No)
+        {
+            return -1;
+        }
+    }
+
+    return nPrepended < static_cast<int>(m_revisionsList.size()) ? nPrepended : -1;
+}
+
+bool SvnViewer::addRepoNode(const std::string& path)
+{
+    size_t nPos = path.rfind('/');
+    if(nPos == std::string::npos)
+    {
+        return false;
+    }
+
+    //only directories whose listing is loaded get the new item; the others are listed when expanded
+    std::string parentPath = path.substr(0, nPos);
+    std::string rootPath = m_repoContent->m_name;
+    while(rootPath.length() > 1 && rootPath[rootPath.length() - 1] == '/')
+    {
+        rootPath.erase(rootPath.length() - 1);
+    }
+
+    RepoItemInfo::SmartPtr parent = parentPath == rootPath ? m_repoContent : findRepoNode(parentPath + "/");
+    if(!parent || (parent != m_repoContent && parent->m_subItems.empty()))
+    {
+        return false;
+    }
+
+    struct stat info;
+    bool bDirectory = stat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+    std::string name = path.substr(nPos + 1) + (bDirectory ? "/" : "");
+    for(const RepoItemInfo::SmartPtr& child : parent->m_subItems)
+    {
+        if(child->m_name == name)
+        {
+            return false;
+        }
+    }
+
+    parent->m_subItems.push_back(RepoItemInfo::SmartPtr(new RepoItemInfo(parent.get(), name, bDirectory ? RepoItemInfo::Directory : RepoItemInfo::File)));
+    m_memoryStats.m_nRepoContentBytes += parent->m_subItems.back()->getMemoryUsageAsChild();
+    return true;
+}
+
+bool SvnViewer::removeRepoNode(const std::string& path)
+{
+    RepoItemInfo::SmartPtr node = findRepoNode(path);
+    if(!node)
+    {
+        node = findRepoNode(path + "/");
+    }
+
+    if(!node || !node->m_parent)
+    {
+        return false;
+    }
+
+    m_memoryStats.m_nRepoContentBytes -= node->getMemoryUsageAsChild();
+    node->m_parent->m_subItems.remove(node);
+    return true;
+}
+
+void SvnViewer::checkForModifications()
+{
+    std::unique_lock<std::recursive_mutex> locker(m_mutex);
+    m_bFullStatusPending = true;
+    m_pendingStatusPaths.clear();
+    m_pendingRecursiveStatusPaths.clear();
+    launchNextStatus();
+}
+
+void SvnViewer::checkForModifications(const std::set<std::string>& paths)
+{
+    std::unique_lock<std::recursive_mutex> locker(m_mutex);
+    if(m_bFullStatusPending)
+    {
+        return;
+    }
+
+    m_pendingStatusPaths.insert(paths.begin(), paths.end());
+    launchNextStatus();
+}
+
+SvnCommand* SvnViewer::launchNextStatus()
+{
+    //a second status started while one runs could finish first and be overwritten with older results
+    if(m_bStatusRunning)
+    {
+        return nullptr;
+    }
+
+    if(m_bFullStatusPending)
+    {
+        m_bFullStatusPending = false;
+        m_bStatusRunning = true;
+        return launchAsync(new StatusSvnCommand(m_repoPath));
+    }
+
+    //paths invalidated by a command need their whole subtree checked, the watcher reports every changed entry itself
+    const bool bRecursive = !m_pendingRecursiveStatusPaths.empty();
+    std::set<std::string>& pendingPaths = bRecursive ? m_pendingRecursiveStatusPaths : m_pendingStatusPaths;
+    if(pendingPaths.empty())
+    {
+        return nullptr;
+    }
+
+    std::list<std::string> targets;
+    while(!pendingPaths.empty() && targets.size() < MAX_STATUS_TARGETS)
+    {
+        targets.push_back(*pendingPaths.begin());
+        pendingPaths.erase(pendingPaths.begin());
+    }
+
+    m_bStatusRunning = true;
+    return launchAsync(new StatusSvnCommand(m_repoPath, targets, bRecursive ? "infinity" : "empty"));
+}
+
+void SvnViewer::applyStatus(const StatusSvnCommand* pCommand)
+{
+    LocalChangesDelta delta;
+    delta.m_bFullStatus = !pCommand->isScoped();
+
+    //entries in the scope of the command before and after it ran
+    std::map<std::string, ChangeInfo> before;
+    std::map<std::string, ChangeInfo> after;
+    for(const ChangeInfo& change : pCommand->getChanges())
+    {
+        after[change.m_AffectedItem] = change;
+    }
+
+    if(delta.m_bFullStatus)
+    {
+        for(const ChangeInfo& change : m_localChanges)
+        {
+            before[change.m_AffectedItem] = change;
+        }
+        m_localChanges = pCommand->getChanges();
+
+        m_memoryStats.m_nLocalChangesBytes = 0;
+        for(const ChangeInfo& change : m_localChanges)
+        {
+            countLocalChangeMemory(change, true);
+        }
+    }
+    else
+    {
+        for(ChangeInfo::Collection::iterator it = m_localChanges.begin(); it != m_localChanges.end();)
+        {
+            if(pCommand->covers(it->m_AffectedItem))
+            {
+                before[it->m_AffectedItem] = *it;
+                countLocalChangeMemory(*it, false);
+                it = m_localChanges.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        m_localChanges.insert(m_localChanges.end(), pCommand->getChanges().begin(), pCommand->getChanges().end());
+        for(const ChangeInfo& change : pCommand->getChanges())
+        {
+            countLocalChangeMemory(change, true);
+        }
+    }
+
+    for(auto& entry : after)
+    {
+        std::map<std::string, ChangeInfo>::iterator previous = before.find(entry.first);
+        if(previous == before.end())
+        {
+            delta.m_added.push_back(entry.second);
+        }
+        else
+        if(previous->second.m_Status != entry.second.m_Status)
+        {
+            delta.m_changed.push_back(entry.second);
+        }
+    }
+
+    for(auto& entry : before)
+    {
+        if(!after.count(entry.first))
+        {
+            delta.m_removed.push_back(entry.second);
+        }
+    }
+
+    m_bLocalStatusKnown = true;
+    if(!delta.empty())
+    {
+        m_observer->onLocalModificationsChanged(delta);
+    }
+}
+
+void SvnViewer::onWorkingCopyChanged(const std::set<std::string>& changedPaths)
+{
+    std::unique_lock<std::recursive_mutex> locker(m_mutex);
+
+    std::string rootPath = m_repoPath;
+    while(rootPath.length() > 1 && rootPath[rootPath.length() - 1] == '/')
+    {
+        rootPath.erase(rootPath.length() - 1);
+    }
+
+    //the watcher reports the root itself when it lost events
+    if(changedPaths.count(rootPath))
+    {
+        checkForModifications();
+    }
+    else
+    {
+        checkForModifications(changedPaths);
+    }
+}
+
+void SvnViewer::commit(const std::list<std::string>& items, const std::string& message)
+{
+    std::unique_lock<std::recursive_mutex> locker(m_mutex);
+    launchAsync(new CommitSvnCommand(m_repoPath, items, message));
+}
+
+void SvnViewer::launchDiffViewer(const std::string& strItem, int nRevision)
+{
+    std::unique_lock<std::recursive_mutex> locker(m_mutex);
+    launchAsync(new LaunchDiffViewerSvnCommand(strItem, nRevision));
+}
+
+void SvnViewer::loadFileDiff(const std::string& strItem, int nRevision)
+{
+    std::unique_lock<std::recursive_mutex> locker(m_mutex);
+    launchAsync(new FileDiffSvnCommand(strItem, nRevision, getRevisionCacheKey(strItem), m_spPristineStore));
+}
+
+void SvnViewer::loadBlame(const std::string& strItem, int nRevision)
+{
+    std::unique_lock<std::recursive_mutex> locker(m_mutex);
+
+    //the author of nRevision lets a cached blame of the previous revision be reused
+    std::string author;
+    for(const RevisionInfo& revision : m_revisionsList)
+    {
+        if(revision.m_No == nRevision)
+        {
+            author = revision.m_Author;
+            break;
+        }
+    }
+
+    launchAsync(new BlameSvnCommand(strItem, nRevision, getRevisionCacheKey(strItem), author, this));
+}
+
+void SvnViewer::onBlameLines(const std::string& path, int nRevision, int nFirstLine, const BlameLine::Collection& lines)
+{
+    std::unique_lock<std::recursive_mutex> locker(m_mutex);
+    m_observer->onBlameLinesLoaded(path, nRevision, nFirstLine, lines);
+}
+
+std::shared_ptr<ReviewSession> SvnViewer::startReview(const std::set<int>& revisions)
+{
+    std::unique_lock<std::recursive_mutex> locker(m_mutex);
+    if(revisions.empty())
+    {
+        return std::shared_ptr<ReviewSession>();
+    }
+
+    //oldest revision first: an item goes from before the first revision that changed it to after the last one
+    std::vector<ReviewSession::File> files;
+    std::map<std::string, size_t> fileIndexes;
+    bool bLoaded = true;
+    for(int nRevision : revisions)
+    {
+        RevisionInfo::Collection::iterator revision = m_revisionsList.begin();
+        while(revision != m_revisionsList.end() && revision->m_No != nRevision)
+        {
+            ++revision;
+        }
+
+        if(revision == m_revisionsList.end())
+        {
+            return std::shared_ptr<ReviewSession>();
+        }
+
+        //the changed paths of every revision are asked for at once
+        if(revision->m_AffectedItems.empty())
+        {
+            if(!revision->m_bLoading)
+            {
+                revision->m_bLoading = true;
+                launchAsync(new DiffSvnCommand(m_repoUrl, nRevision));
+            }
+            bLoaded = false;
+            continue;
+        }
+        revision->m_nLastAccess = ++m_nAccessCounter;
+
+        //"M       <url>" lines of svn diff --summarize, in the order the view lists them
+        for(const std::string& item : revision->m_AffectedItems)
+        {
+            size_t nUrl = item.find_first_not_of(' ', 1);
+            if(item.empty() || nUrl == std::string::npos)
+            {
+                continue;
+            }
+
+            std::string status = item[0] == ' ' ? "M" : item.substr(0, 1);
+            std::string url = item.substr(nUrl);
+            std::map<std::string, size_t>::iterator fileIndex = fileIndexes.find(url);
+            if(fileIndex == fileIndexes.end())
+            {
+                ReviewSession::File file;
+                file.m_status = status;
+                file.m_url = url;
+                file.m_cacheKey = getRevisionCacheKey(file.m_url);
+                file.m_nBeforeRevision = status == "A" ? -1 : nRevision - 1;
+
+                const std::string& base = file.m_url.compare(0, m_repoUrl.length(), m_repoUrl) == 0 ? m_repoUrl : m_repoRoot;
+                file.m_relativePath = file.m_url.compare(0, base.length(), base) == 0 && !base.empty()
+                        ? file.m_url.substr(base.length()) : file.m_url.substr(file.m_url.rfind('/') + 1);
+                while(!file.m_relativePath.empty() && file.m_relativePath[0] == '/')
+                {
+                    file.m_relativePath.erase(0, 1);
+                }
+
+                fileIndex = fileIndexes.insert(std::make_pair(url, files.size())).first;
+                files.push_back(file);
+            }
+            else
+            {
+                ReviewSession::File& file = files[fileIndex->second];
+                file.m_status = file.m_nBeforeRevision == -1 ? "A" : status == "D" ? "D" : "M";
+            }
+
+            files[fileIndex->second].m_nAfterRevision = status == "D" ? -1 : nRevision;
+        }
+    }
+
+    if(!bLoaded)
+    {
+        return std::shared_ptr<ReviewSession>();
+    }
+
+    if(revisions.size() > 1)
+    {
+        //added and deleted again within the revisions: nothing to review
+        files.erase(std::remove_if(files.begin(), files.end(), [](const ReviewSession::File& file)
+        {
+            return file.m_nBeforeRevision == -1 && file.m_nAfterRevision == -1;
+        }), files.end());
+
+        std::stable_sort(files.begin(), files.end(), [](const ReviewSession::File& first, const ReviewSession::File& second)
+        {
+            return first.m_relativePath < second.m_relativePath;
+        });
+    }
+
+    std::stringstream ss;
+    ss << AppSettings::instance()->getTempPath() << "review/r" << *revisions.begin();
+    if(revisions.size() > 1)
+    {
+        ss << "-" << *revisions.rbegin();
+    }
+    ss << "/";
+
+    std::shared_ptr<ReviewSession> spSession(new ReviewSession(++m_nReviewsCount, revisions, files, ss.str(), this));
+    spSession->start(REVIEW_STAGING_THREADS);
+    return spSession;
+}
+
+void SvnViewer::launchDirectoryDiffViewer(const std::string& beforePath, const std::string& afterPath)
+{
+    SvnBackend::instance()->launchDetached(std::string("meld \"") + beforePath + "\" \"" + afterPath + "\"");
+}
+
+std::shared_ptr<HistorySearch> SvnViewer::startHistorySearch(const std::string& pattern, bool bRegex, bool bStopAtIntroduction,
+                                                             int nFirstRevision, int nLastRevision)
+{
+    std::unique_lock<std::recursive_mutex> locker(m_mutex);
+
+    //oldest first; changed paths not loaded yet are listed by the search itself
+    std::vector<HistorySearch::Revision> revisions;
+    for(RevisionInfo::Collection::const_reverse_iterator revIt = m_revisionsList.rbegin(); revIt != m_revisionsList.rend(); ++revIt)
+    {
+        if(revIt->m_No >= nFirstRevision && revIt->m_No <= nLastRevision)
+        {
+            HistorySearch::Revision revision;
+            revision.m_nRevision = revIt->m_No;
+            revision.m_AffectedItems = revIt->m_AffectedItems;
+            revisions.push_back(revision);
+        }
+    }
+
+    std::function<std::string(const std::string&)> cacheKeyOf = [this](const std::string& url)
+    {
+        std::unique_lock<std::recursive_mutex> locker(m_mutex);
+        return getRevisionCacheKey(url);
+    };
+
+    std::shared_ptr<HistorySearch> spSearch(new HistorySearch(++m_nHistorySearchesCount, pattern, bRegex, bStopAtIntroduction, m_logUrl,
+                                                              revisions, cacheKeyOf, this));
+    if(spSearch->getError().empty())
+    {
+        spSearch->start(HISTORY_SEARCH_THREADS);
+    }
+    return spSearch;
+}
+
+void SvnViewer::onHistorySearchMatch(int nSearchId, int nRevision, const std::string& url, bool bAdded, int nLine, const std::string& line)
+{
+    std::unique_lock<std::recursive_mutex> locker(m_mutex);
+    m_observer->onHistorySearchMatch(nSearchId, nRevision, url, bAdded, nLine, line);
+}
+
+void SvnViewer::onHistorySearchProgress(int nSearchId, int nScannedRevisions)
+{
+    std::unique_lock<std::recursive_mutex> locker(m_mutex);
+    m_observer->onHistorySearchProgress(nSearchId, nScannedRevisions);
+}
+
+void SvnViewer::onHistorySearchCompleted(int nSearchId)
+{
+    std::unique_lock<std::recursive_mutex> locker(m_mutex);
+    m_observer->onHistorySearchCompleted(nSearchId);
+}
+
+void SvnViewer::onReviewFileStaged(int nReviewId, int nIndex)
 {
     std::unique_lock<std::recursive_mutex> locker(m_mutex);
-    m_repoPath = repoPath;
-    m_nRevisionsCount = nRevisionsCount;
-
-    m_repoContent.reset(new RepoItemInfo(nullptr, m_repoPath, RepoItemInfo::Directory));
-
-    refresh();
+    m_observer->onReviewFileStaged(nReviewId, nIndex);
 }
 
-void SvnViewer::refresh()
+void SvnViewer::onReviewCompleted(int nReviewId)
 {
     std::unique_lock<std::recursive_mutex> locker(m_mutex);
-    launchAsync(new InfoSvnCommand(m_repoPath.c_str()));
+    m_observer->onReviewCompleted(nReviewId);
 }
 
-void SvnViewer::viewLog(const std::string &repoUrl)
+std::string SvnViewer::getRevisionCacheKey(const std::string& strItem) const
 {
-    std::unique_lock<std::recursive_mutex> locker(m_mutex);
-    launchAsync(new LogSvnCommand(repoUrl, m_nRevisionsCount));
+    //"<uuid>:<path in the repository>", the same for a working copy path and for its url
+    if(m_repoUuid.empty() || m_repoRoot.empty())
+    {
+        return std::string();
+    }
+
+    std::string url = strItem;
+    std::string rootPath = m_repoPath;
+    while(rootPath.length() > 1 && rootPath[rootPath.length() - 1] == '/')
+    {
+        rootPath.erase(rootPath.length() - 1);
+    }
+
+    if(url.compare(0, rootPath.length(), rootPath) == 0 && (url.length() == rootPath.length() || url[rootPath.length()] == '/'))
+    {
+        url = m_repoUrl + url.substr(rootPath.length());
+    }
+
+    if(url.compare(0, m_repoRoot.length(), m_repoRoot) != 0)
+    {
+        return std::string();
+    }
+
+    return m_repoUuid + ":" + url.substr(m_repoRoot.length());
 }
 
-void SvnViewer::updateToHead()
+void SvnViewer::applyStoredRevisionStats()
 {
-    std::unique_lock<std::recursive_mutex> locker(m_mutex);
-    launchAsync(new UpdateSvnCommand(m_repoPath));
+    const std::string key = getRevisionCacheKey(m_logUrl);
+    if(key.empty())
+    {
+        return;
+    }
+
+    if(key != m_statsStore.getKey())
+    {
+        m_statsStore.open(key);
+    }
+
+    for(RevisionInfo& revision : m_revisionsList)
+    {
+        if(!revision.m_Stats.isKnown())
+        {
+            m_statsStore.get(revision.m_No, revision.m_Stats);
+        }
+    }
 }
 
-void SvnViewer::updateToRevision(int nRevision)
+void SvnViewer::scheduleRevisionStats()
 {
-    std::unique_lock<std::recursive_mutex> locker(m_mutex);
-    launchAsync(new UpdateSvnCommand(m_repoPath, nRevision));
+    //statistics are only stored once the url has a key
+    if(m_bBackgroundPaused || m_closing || m_statsStore.getKey().empty() || m_statsStore.getKey() != getRevisionCacheKey(m_logUrl))
+    {
+        return;
+    }
+
+    for(RevisionInfo::Collection::iterator revIt = m_revisionsList.begin(); revIt != m_revisionsList.end() && m_nStatsJobs < MAX_STATS_JOBS; ++revIt)
+    {
+        if(revIt->m_Stats.isKnown() || revIt->m_bStatsLoading)
+        {
+            continue;
+        }
+
+        revIt->m_bStatsLoading = true;
+        m_nStatsJobs++;
+        launchAsync(new DiffStatSvnCommand(m_logUrl, revIt->m_No));
+    }
 }
 
-void SvnViewer::checkForModifications()
+void SvnViewer::applyRevisionStats(const DiffStatSvnCommand* pCommand, bool bSuccess)
 {
-    std::unique_lock<std::recursive_mutex> locker(m_mutex);
-    launchAsync(new StatusSvnCommand(m_repoPath));
+    m_nStatsJobs--;
+
+    //a failed revision keeps m_bStatsLoading and is not asked for again while the application runs
+    if(bSuccess && pCommand->getPath() == m_logUrl)
+    {
+        for(RevisionInfo& revision : m_revisionsList)
+        {
+            if(revision.m_No == pCommand->getRevision())
+            {
+                revision.m_bStatsLoading = false;
+                revision.m_Stats = pCommand->getStats();
+                m_statsStore.put(revision.m_No, revision.m_Stats);
+                m_observer->onRevisionStatsLoaded(revision.m_No);
+                break;
+            }
+        }
+    }
+
+    scheduleRevisionStats();
 }
 
-void SvnViewer::commit(const std::list<std::string>& items, const std::string& message)
+bool SvnViewer::getRevisionStats(int nRevision, RevisionStats& stats) const
 {
     std::unique_lock<std::recursive_mutex> locker(m_mutex);
-    launchAsync(new CommitSvnCommand(m_repoPath, items, message));
+    for(const RevisionInfo& revision : m_revisionsList)
+    {
+        if(revision.m_No == nRevision)
+        {
+            stats = revision.m_Stats;
+            return stats.isKnown();
+        }
+    }
+
+    return false;
 }
 
-void SvnViewer::launchDiffViewer(const std::string& strItem, int nRevision)
+void SvnViewer::setBackgroundWorkPaused(bool bPaused)
 {
     std::unique_lock<std::recursive_mutex> locker(m_mutex);
-    launchAsync(new LaunchDiffViewerSvnCommand(strItem, nRevision));
+    if(m_bBackgroundPaused == bPaused)
+    {
+        return;
+    }
+
+    m_bBackgroundPaused = bPaused;
+    scheduleRevisionStats();
 }
 
 void SvnViewer::addToSourceControl(const std::string& strItem)
@@ -130,22 +1109,127 @@ bool SvnViewer::getChangeSet(int nRevision, RevisionInfo& changeset)
        return false;
    }
 
+   currentRevision->m_nLastAccess = ++m_nAccessCounter;
    changeset = *currentRevision;
+   if(currentRevision->m_bPrefetched)
+   {
+       currentRevision->m_bPrefetched = false;
+       m_prefetchStats.m_nHits++;
+   }
+
+   std::map<int, bool>::iterator prefetchJob = m_prefetchJobs.find(nRevision);
+   if(prefetchJob != m_prefetchJobs.end() && !prefetchJob->second)
+   {
+       prefetchJob->second = true;
+       m_prefetchStats.m_nLateHits++;
+   }
+
    if(currentRevision->m_AffectedItems.empty() && !currentRevision->m_bLoading)
    {
        currentRevision->m_bLoading = true;
+       m_prefetchStats.m_nMisses++;
        launchAsync(new DiffSvnCommand(m_repoUrl, nRevision));
    }
 
    return true;
 }
 
+void SvnViewer::prefetchChangeSets(const std::vector<int>& revisions)
+{
+    std::unique_lock<std::recursive_mutex> locker(m_mutex);
+
+    std::set<int> window(revisions.begin(), revisions.end());
+    for(int nQueued : m_prefetchQueue)
+    {
+        if(!window.count(nQueued))
+        {
+            m_prefetchStats.m_nCancelled++;
+        }
+    }
+
+    m_prefetchQueue.assign(revisions.begin(), revisions.end());
+    launchPrefetches();
+}
+
+void SvnViewer::launchPrefetches()
+{
+    while(static_cast<int>(m_prefetchJobs.size()) < MAX_PREFETCH_JOBS && !m_prefetchQueue.empty())
+    {
+        int nRevision = m_prefetchQueue.front();
+        m_prefetchQueue.pop_front();
+
+        for(RevisionInfo& revision : m_revisionsList)
+        {
+            if(revision.m_No == nRevision)
+            {
+                if(revision.m_AffectedItems.empty() && !revision.m_bLoading)
+                {
+                    revision.m_bLoading = true;
+                    m_prefetchJobs[nRevision] = false;
+                    launchAsync(new DiffSvnCommand(m_repoUrl, nRevision));
+                }
+                break;
+            }
+        }
+    }
+}
+
+void SvnViewer::onChangeSetFetched(int nRevision, bool bSuccess)
+{
+    std::map<int, bool>::iterator prefetchJob = m_prefetchJobs.find(nRevision);
+    if(prefetchJob == m_prefetchJobs.end())
+    {
+        return;
+    }
+
+    bool bViewed = prefetchJob->second;
+    m_prefetchJobs.erase(prefetchJob);
+    if(bSuccess)
+    {
+        m_prefetchStats.m_nFetched++;
+        for(RevisionInfo& revision : m_revisionsList)
+        {
+            if(revision.m_No == nRevision)
+            {
+                revision.m_bPrefetched = !bViewed;
+                break;
+            }
+        }
+    }
+
+    launchPrefetches();
+}
+
+SvnViewerPrefetchStats SvnViewer::getPrefetchStats() const
+{
+    std::unique_lock<std::recursive_mutex> locker(m_mutex);
+    return m_prefetchStats;
+}
+
 RevisionInfo::Collection SvnViewer::getRevisionsList() const
 {
     std::unique_lock<std::recursive_mutex> locker(m_mutex);
     return m_revisionsList;
 }
 
+RevisionInfo::Collection SvnViewer::getRevisionsNewerThan(int nRevision) const
+{
+    std::unique_lock<std::recursive_mutex> locker(m_mutex);
+    RevisionInfo::Collection revisions;
+    for(RevisionInfo::Collection::const_iterator it = m_revisionsList.begin(); it != m_revisionsList.end() && it->m_No > nRevision; ++it)
+    {
+        revisions.push_back(*it);
+    }
+
+    return revisions;
+}
+
+int SvnViewer::getOldestRevision() const
+{
+    std::unique_lock<std::recursive_mutex> locker(m_mutex);
+    return m_revisionsList.empty() ? -1 : m_revisionsList.back().m_No;
+}
+
 ChangeInfo::Collection SvnViewer::getLocalChanges() const
 {
     std::unique_lock<std::recursive_mutex> locker(m_mutex);
@@ -170,6 +1254,124 @@ RepoItemInfo::SmartPtr SvnViewer::getRepoContent() const
     return m_repoContent;
 }
 
+SvnViewerMemoryStats SvnViewer::getMemoryStats() const
+{
+    std::unique_lock<std::recursive_mutex> locker(m_mutex);
+
+    SvnViewerMemoryStats stats = m_memoryStats;
+    stats.m_nBudgetBytes = m_nMemoryBudget;
+    return stats;
+}
+
+void SvnViewer::setViewsMemoryUsage(size_t nBytes)
+{
+    std::unique_lock<std::recursive_mutex> locker(m_mutex);
+    m_memoryStats.m_nViewsBytes = nBytes;
+    enforceMemoryBudget();
+}
+
+void SvnViewer::countRevisionMemory(const RevisionInfo& revision, bool bAdded)
+{
+    if(bAdded)
+        m_memoryStats.m_nRevisionsBytes += revision.getMemoryUsage();
+    else
+        m_memoryStats.m_nRevisionsBytes -= revision.getMemoryUsage();
+
+    countAffectedItemsMemory(revision, bAdded);
+}
+
+void SvnViewer::countAffectedItemsMemory(const RevisionInfo& revision, bool bAdded)
+{
+    if(revision.m_AffectedItems.empty())
+    {
+        return;
+    }
+
+    if(bAdded)
+    {
+        m_memoryStats.m_nAffectedItemsBytes += revision.getAffectedItemsMemoryUsage();
+        m_memoryStats.m_nLoadedChangeSets++;
+    }
+    else
+    {
+        m_memoryStats.m_nAffectedItemsBytes -= revision.getAffectedItemsMemoryUsage();
+        m_memoryStats.m_nLoadedChangeSets--;
+    }
+}
+
+void SvnViewer::countLocalChangeMemory(const ChangeInfo& change, bool bAdded)
+{
+    if(bAdded)
+        m_memoryStats.m_nLocalChangesBytes += change.getMemoryUsage();
+    else
+        m_memoryStats.m_nLocalChangesBytes -= change.getMemoryUsage();
+}
+
+void SvnViewer::recountRevisionsMemory()
+{
+    m_memoryStats.m_nRevisionsBytes = 0;
+    m_memoryStats.m_nAffectedItemsBytes = 0;
+    m_memoryStats.m_nLoadedChangeSets = 0;
+    for(const RevisionInfo& revision : m_revisionsList)
+    {
+        countRevisionMemory(revision, true);
+    }
+}
+
+void SvnViewer::setMemoryBudget(size_t nBudgetBytes)
+{
+    std::unique_lock<std::recursive_mutex> locker(m_mutex);
+    m_nMemoryBudget = nBudgetBytes;
+    enforceMemoryBudget();
+}
+
+void SvnViewer::enforceMemoryBudget()
+{
+    if(m_memoryStats.getTotalBytes() <= m_nMemoryBudget)
+    {
+        return;
+    }
+
+    //only the affected items can be fetched again on demand; evict the least recently viewed first
+    std::vector<RevisionInfo*> loaded;
+    for(RevisionInfo& revision : m_revisionsList)
+    {
+        if(!revision.m_AffectedItems.empty())
+        {
+            loaded.push_back(&revision);
+        }
+    }
+
+    std::sort(loaded.begin(), loaded.end(), [](const RevisionInfo* pLeft, const RevisionInfo* pRight)
+    {
+        return pLeft->m_nLastAccess < pRight->m_nLastAccess;
+    });
+
+    //keep the most recently viewed revision, it is the one on screen
+    for(size_t i = 0; i + 1 < loaded.size() && m_memoryStats.getTotalBytes() > m_nMemoryBudget; i++)
+    {
+        countAffectedItemsMemory(*loaded[i], false);
+        std::list<std::string>().swap(loaded[i]->m_AffectedItems);
+        m_memoryStats.m_nEvictedChangeSets++;
+        if(loaded[i]->m_bPrefetched)
+        {
+            loaded[i]->m_bPrefetched = false;
+            m_prefetchStats.m_nWasted++;
+        }
+    }
+}
+
+int SvnViewer::getNewestRevision() const
+{
+    int nNewest = -1;
+    for(const RevisionInfo& revision : m_revisionsList)
+    {
+        nNewest = std::max(nNewest, revision.m_No);
+    }
+
+    return nNewest;
+}
+
 RepoItemInfo::SmartPtr SvnViewer::findRepoNode(const std::string& repoPath)
 {
     if(m_repoContent->m_name == repoPath)
@@ -178,15 +1380,21 @@ RepoItemInfo::SmartPtr SvnViewer::findRepoNode(const std::string& repoPath)
     return m_repoContent->findChildNode(repoPath);
 }
 
-void SvnViewer::launchAsync(SvnCommand* pCommand)
+SvnCommand* SvnViewer::launchAsync(SvnCommand* pCommand)
 {
     std::unique_lock<std::recursive_mutex> locker(m_mutex);
 
     threadParams *pParams = new threadParams;
     pParams->pInstance = this;
     pParams->spCommand.reset(pCommand);
-    pthread_create(&pParams->thread, NULL, &asyncProcessThread, pParams);
+    //nobody joins the threads: they release their resources when done and free pParams themselves
+    pthread_attr_t attributes;
+    pthread_attr_init(&attributes);
+    pthread_attr_setdetachstate(&attributes, PTHREAD_CREATE_DETACHED);
+    pthread_create(&pParams->thread, &attributes, &asyncProcessThread, pParams);
+    pthread_attr_destroy(&attributes);
     m_asyncProcessThreads.push_back(pParams);
+    return pCommand;
 }
 
 void SvnViewer::onAsyncCommandCompleted(threadParams *pParams, bool bSuccess)
@@ -204,12 +1412,22 @@ void SvnViewer::onAsyncCommandCompleted(threadParams *pParams, bool bSuccess)
                     if(revIt->m_No == pCommand->getRevision())
                     {
                         revIt->m_bLoading = false;
+                        countAffectedItemsMemory(*revIt, false);
                         revIt->m_AffectedItems = pCommand->getAffectedItems();
+                        countAffectedItemsMemory(*revIt, true);
+                        revIt->m_nLastAccess = ++m_nAccessCounter;
                         break;
                     }
                 }
 
-                m_observer->onAffectedItemsUpdated();
+                onChangeSetFetched(pCommand->getRevision(), true);
+                enforceMemoryBudget();
+
+                m_observer->onAffectedItemsLoaded(pCommand->getRevision());
+            }
+            else
+            {
+                onChangeSetFetched(pCommand->getRevision(), false);
             }
         }
         else
@@ -233,63 +1451,184 @@ void SvnViewer::onAsyncCommandCompleted(threadParams *pParams, bool bSuccess)
                 }
             }
 
-            m_observer->onRevisionsListUpdated();
+            recountRevisionsMemory();
+            enforceMemoryBudget();
+            applyStoredRevisionStats();
+
+            int nPrepended = countPrependedRevisions(oldRevisions);
+            if(nPrepended != -1)
+            {
+                m_observer->onRevisionsPrepended(nPrepended);
+            }
+            else
+            {
+                m_observer->onRevisionsListUpdated();
+            }
+
+            scheduleRevisionStats();
         }
         else
         if(pParams->spCommand->getType() == "svn status")
         {
             StatusSvnCommand* pCommand = static_cast<StatusSvnCommand*>(pParams->spCommand.get());
-            m_localChanges = pCommand->getChanges();
-
-            m_observer->onLocalModificationsUpdated();
+            applyStatus(pCommand);
         }
         else
         if(pParams->spCommand->getType() == "svn info")
         {
             InfoSvnCommand* pCommand = static_cast<InfoSvnCommand*>(pParams->spCommand.get());
+            int nPreviousRevision = m_currentRevision;
             m_repoUrl = pCommand->getRepoUrl();
+            m_repoRoot = pCommand->getRepoRoot();
+            m_repoUuid = pCommand->getRepoUuid();
             m_currentRevision = pCommand->getCurrentRevision();
 
-            listContent(m_repoPath);
-            viewLog(m_repoUrl);
-            checkForModifications();
+            //the revisions list marks the working copy revision
+            if(nPreviousRevision != m_currentRevision && !m_revisionsList.empty())
+            {
+                m_observer->onRevisionsListUpdated();
+            }
+        }
+        else
+        if(pParams->spCommand->getType() == "svn info -r HEAD")
+        {
+            HeadInfoSvnCommand* pCommand = static_cast<HeadInfoSvnCommand*>(pParams->spCommand.get());
+            m_nHeadRevision = pCommand->getCurrentRevision();
         }
         else
         if(pParams->spCommand->getType() == "svn update")
         {
-            refresh();
+            UpdateSvnCommand* pCommand = static_cast<UpdateSvnCommand*>(pParams->spCommand.get());
+            applyUpdatedItems();
+
+            //the log holds only the revisions touching the working copy root; mark the newest one not after the update
+            int nRevision = -1;
+            for(const RevisionInfo& revision : m_revisionsList)
+            {
+                if(revision.m_No <= pCommand->getUpdatedRevision() && revision.m_No > nRevision)
+                {
+                    nRevision = revision.m_No;
+                }
+            }
+
+            if(nRevision != -1 && nRevision != m_currentRevision)
+            {
+                m_currentRevision = nRevision;
+                m_observer->onRevisionsListUpdated();
+            }
+
+            m_observer->onUpdateCompleted(pCommand->getUpdatedRevision(), pCommand->getUpdatedItemsCount(), true);
+        }
+        else
+        if(pParams->spCommand->getType() == "svn commit")
+        {
+            CommitSvnCommand* pCommand = static_cast<CommitSvnCommand*>(pParams->spCommand.get());
+            if(pCommand->getCommittedRevision() != -1)
+            {
+                invalidate(applyCommit(pCommand));
+            }
         }
         else
-        if(pParams->spCommand->getType() == "svn add")
+        if(pParams->spCommand->getType() == "svn diff --diff-cmd")
         {
-            refresh();
+            //nothing to do
         }
         else
-        if(pParams->spCommand->getType() == "svn revert")
+        if(pParams->spCommand->getType() == "svn cat")
         {
-            refresh();
+            FileDiffSvnCommand* pCommand = static_cast<FileDiffSvnCommand*>(pParams->spCommand.get());
+            m_observer->onFileDiffLoaded(pCommand->getPath(), pCommand->getRevision(), pCommand->getDiff());
         }
         else
-        if(pParams->spCommand->getType() == "svn commit")
+        if(pParams->spCommand->getType() == "svn blame")
         {
-            refresh();
+            BlameSvnCommand* pCommand = static_cast<BlameSvnCommand*>(pParams->spCommand.get());
+            m_observer->onBlameCompleted(pCommand->getPath(), pCommand->getRevision(), true);
         }
         else
-        if(pParams->spCommand->getType() == "svn diff --diff-cmd")
+        if(pParams->spCommand->getType() == "svn diff stats")
         {
-            //nothing to do
+            applyRevisionStats(static_cast<DiffStatSvnCommand*>(pParams->spCommand.get()), true);
         }
         else
         if(pParams->spCommand->getType() == "svn list")
         {
-            m_observer->onRepoContentUpdated();
+            ListSvnCommand* pCommand = static_cast<ListSvnCommand*>(pParams->spCommand.get());
+            //a listing of a tree replaced meanwhile by init() does not count
+            if(pCommand->getRepoInfo()->isInTree(m_repoContent.get()))
+            {
+                m_memoryStats.m_nRepoContentBytes += pCommand->getListedBytes();
+                m_memoryStats.m_nRepoContentBytes -= pCommand->getReleasedBytes();
+            }
+            m_observer->onRepoNodeListed(pCommand->getRepoInfo()->getFullPath());
         }
     }
     else
     {
+        if(pParams->spCommand->getType() == "svn diff")
+        {
+            //asked for again when viewed
+            DiffSvnCommand* pCommand = static_cast<DiffSvnCommand*>(pParams->spCommand.get());
+            for(RevisionInfo& revision : m_revisionsList)
+            {
+                if(revision.m_No == pCommand->getRevision())
+                {
+                    revision.m_bLoading = false;
+                    break;
+                }
+            }
+
+            onChangeSetFetched(pCommand->getRevision(), false);
+        }
+        else
+        if(pParams->spCommand->getType() == "svn update")
+        {
+            //whatever was updated before the failure is already on disk, what was not reported is read again
+            UpdateSvnCommand* pCommand = static_cast<UpdateSvnCommand*>(pParams->spCommand.get());
+            applyUpdatedItems();
+            invalidate(pCommand->getInvalidation());
+            m_observer->onUpdateCompleted(pCommand->getUpdatedRevision(), pCommand->getUpdatedItemsCount(), false);
+        }
+        else
+        if(pParams->spCommand->getType() == "svn cat")
+        {
+            FileDiffSvnCommand* pCommand = static_cast<FileDiffSvnCommand*>(pParams->spCommand.get());
+            m_observer->onFileDiffLoaded(pCommand->getPath(), pCommand->getRevision(), std::shared_ptr<const TextDiff>());
+        }
+        else
+        if(pParams->spCommand->getType() == "svn blame")
+        {
+            BlameSvnCommand* pCommand = static_cast<BlameSvnCommand*>(pParams->spCommand.get());
+            m_observer->onBlameCompleted(pCommand->getPath(), pCommand->getRevision(), false);
+        }
+        else
+        if(pParams->spCommand->getType() == "svn diff stats")
+        {
+            applyRevisionStats(static_cast<DiffStatSvnCommand*>(pParams->spCommand.get()), false);
+        }
+
         m_observer->onErrosGenerated();
     }
 
+    //update, add, revert and commit declare what they changed; only that is fetched again
+    if(bSuccess)
+    {
+        invalidate(pParams->spCommand->getInvalidation());
+    }
+
+    m_observer->onCommandCompleted(pParams->spCommand->getType(), bSuccess);
+
+    if(pParams->spCommand->getType() == "svn status")
+    {
+        m_bStatusRunning = false;
+        launchNextStatus();
+    }
+
+    if(m_refreshPipeline.onCommandCompleted(pParams->spCommand.get(), bSuccess))
+    {
+        onRefreshPipelineProgress();
+    }
+
     for(std::list<threadParams*>::iterator threadIt = m_asyncProcessThreads.begin(); threadIt != m_asyncProcessThreads.end(); ++threadIt)
     {
         if(*threadIt == pParams)
@@ -298,6 +1637,7 @@ void SvnViewer::onAsyncCommandCompleted(threadParams *pParams, bool bSuccess)
             break;
         }
     }
+    m_asyncThreadsFinished.notify_all();
 }
 
 void* SvnViewer::asyncProcessThread(void* arg)
@@ -307,5 +1647,7 @@ void* SvnViewer::asyncProcessThread(void* arg)
     bool bSuccess = pParams->spCommand->execute();
     pParams->pInstance->onAsyncCommandCompleted(pParams, bSuccess);
 
+    //no longer in the list of running threads, the command goes with it
+    delete pParams;
     return NULL;
 }
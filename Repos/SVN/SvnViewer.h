@@ -4,25 +4,122 @@
 #include <sstream>
 #include <string>
 #include <list>
+#include <set>
 #include <memory>
 #include <mutex>
 #include <chrono>
 #include <thread>
 #include <pthread.h>
+#include <condition_variable>
 #include <iostream>
 #include "Repos/SVN/SvnCommands.h"
+#include "Repos/SVN/WorkingCopyWatcher.h"
+#include "Repos/SVN/RefreshPipeline.h"
+#include "Repos/SVN/ReviewSession.h"
+#include "Repos/SVN/HistorySearch.h"
 
 class SvnViewerObserver
 {
 public:
     virtual void onRevisionsListUpdated() = 0;
     virtual void onLocalModificationsUpdated() = 0;
+    //the entries a status run added, removed or changed; views may update only those
+    virtual void onLocalModificationsChanged(const LocalChangesDelta& /*delta*/) { onLocalModificationsUpdated(); }
     virtual void onAffectedItemsUpdated() = 0;
     virtual void onRepoContentUpdated() = 0;
     virtual void onErrosGenerated() = 0;
+    //nCount new revisions were added in front of the list, the rest of it is unchanged except for
+    //as many of the oldest revisions dropped to keep the list size
+    virtual void onRevisionsPrepended(int /*nCount*/) { onRevisionsListUpdated(); }
+    //the changed paths of one revision were loaded
+    virtual void onAffectedItemsLoaded(int /*nRevision*/) { onAffectedItemsUpdated(); }
+    //the children of one directory of the repository tree were listed
+    virtual void onRepoNodeListed(const std::string& /*nodePath*/) { onRepoContentUpdated(); }
+    //the diff asked for with loadFileDiff; spDiff is empty when neither side could be fetched
+    virtual void onFileDiffLoaded(const std::string& /*path*/, int /*nRevision*/, std::shared_ptr<const TextDiff> /*spDiff*/) {}
+    //lines nFirstLine.. of the blame asked for with loadBlame, delivered while it is still running
+    virtual void onBlameLinesLoaded(const std::string& /*path*/, int /*nRevision*/, int /*nFirstLine*/, const BlameLine::Collection& /*lines*/) {}
+    virtual void onBlameCompleted(const std::string& /*path*/, int /*nRevision*/, bool /*bSuccess*/) {}
+    //progress of a review started with startReview, nReviewId is ReviewSession::getId()
+    virtual void onReviewFileStaged(int /*nReviewId*/, int /*nIndex*/) {}
+    virtual void onReviewCompleted(int /*nReviewId*/) {}
+    //progress of a search started with startHistorySearch, nSearchId is HistorySearch::getId()
+    virtual void onHistorySearchMatch(int /*nSearchId*/, int /*nRevision*/, const std::string& /*url*/, bool /*bAdded*/,
+                                      int /*nLine*/, const std::string& /*line*/) {}
+    virtual void onHistorySearchProgress(int /*nSearchId*/, int /*nScannedRevisions*/) {}
+    virtual void onHistorySearchCompleted(int /*nSearchId*/) {}
+    //the diff statistics of one revision were computed in the background
+    virtual void onRevisionStatsLoaded(int /*nRevision*/) {}
+    //a refresh found no new revisions on the server, nothing was fetched
+    virtual void onRepositoryUnchanged() {}
+    //an update in progress: items applied so far and the last one
+    virtual void onUpdateProgress(int /*nUpdatedItems*/, const std::string& /*currentItem*/) {}
+    virtual void onUpdateCompleted(int /*nRevision*/, int /*nUpdatedItems*/, bool /*bSuccess*/) {}
+    //every finished command, with the type reported by SvnCommand::getType()
+    virtual void onCommandCompleted(const std::string& /*commandType*/, bool /*bSuccess*/) {}
 };
 
-class SvnViewer
+struct SvnViewerMemoryStats
+{
+    SvnViewerMemoryStats()
+        : m_nRevisionsBytes(0)
+        , m_nAffectedItemsBytes(0)
+        , m_nRepoContentBytes(0)
+        , m_nLocalChangesBytes(0)
+        , m_nLoadedChangeSets(0)
+        , m_nEvictedChangeSets(0)
+        , m_nViewsBytes(0)
+        , m_nBudgetBytes(0)
+    {
+    }
+
+    size_t getTotalBytes() const
+    {
+        return m_nRevisionsBytes + m_nAffectedItemsBytes + m_nRepoContentBytes + m_nLocalChangesBytes + m_nViewsBytes;
+    }
+
+    size_t m_nRevisionsBytes;
+    size_t m_nAffectedItemsBytes;
+    size_t m_nRepoContentBytes;
+    size_t m_nLocalChangesBytes;
+    size_t m_nLoadedChangeSets;
+    size_t m_nEvictedChangeSets;
+    //models and items of the views showing the data, as estimated by them
+    size_t m_nViewsBytes;
+    size_t m_nBudgetBytes;
+};
+
+struct SvnViewerPrefetchStats
+{
+    SvnViewerPrefetchStats()
+        : m_nHits(0)
+        , m_nLateHits(0)
+        , m_nMisses(0)
+        , m_nFetched(0)
+        , m_nWasted(0)
+        , m_nCancelled(0)
+    {
+    }
+
+    double getHitRate() const
+    {
+        return m_nHits + m_nLateHits + m_nMisses ? static_cast<double>(m_nHits + m_nLateHits) / (m_nHits + m_nLateHits + m_nMisses) : 0;
+    }
+
+    //viewed revisions whose affected items were prefetched, already there or still on the way
+    int m_nHits;
+    int m_nLateHits;
+    //viewed revisions fetched only when they were viewed
+    int m_nMisses;
+    int m_nFetched;
+    //prefetched and evicted again without being viewed
+    int m_nWasted;
+    //dropped from the queue by a newer window before they started
+    int m_nCancelled;
+};
+
+class SvnViewer : public WorkingCopyWatcherObserver, public UpdateSvnCommandObserver, public BlameSvnCommandObserver,
+                  public ReviewSessionObserver, public HistorySearchObserver
 {
 private:
     SvnViewer();
@@ -37,29 +134,112 @@ public:
     }
 
     bool isInitialized();
+    bool isWatchingWorkingCopy() const;
 
     void init(const std::string& repoPath, int nRevisionsCount = 2500);
     void refresh();
+    void refreshRevisions();
+    void refreshRepoContent();
     void viewLog(const std::string& repoUrl);
     void updateToHead();
     void updateToRevision(int nRevision);
     void checkForModifications();
+    void checkForModifications(const std::set<std::string>& paths);
     void commit(const std::list<std::string>& items, const std::string& message);
     void launchDiffViewer(const std::string& strItem, int nRevision);
+    //diffs strItem in the revision nRevision (-1: the local modifications), see onFileDiffLoaded
+    void loadFileDiff(const std::string& strItem, int nRevision);
+    //blames strItem at nRevision (-1: BASE), see onBlameLinesLoaded
+    void loadBlame(const std::string& strItem, int nRevision);
+    //stages every file changed in the revisions for review, as one change from before the first of them to after
+    //the last; empty while their changed paths are not loaded yet
+    std::shared_ptr<ReviewSession> startReview(const std::set<int>& revisions);
+    void launchDirectoryDiffViewer(const std::string& beforePath, const std::string& afterPath);
+    //finds the revisions from nFirstRevision to nLastRevision of the log that added or removed lines containing
+    //pattern; check getError() of the result
+    std::shared_ptr<HistorySearch> startHistorySearch(const std::string& pattern, bool bRegex, bool bStopAtIntroduction,
+                                                      int nFirstRevision, int nLastRevision);
     void addToSourceControl(const std::string& strItem);
     void revert(const std::string& strItem);
     void listContent(const std::string& repoPath);
 
     bool getChangeSet(int nRevision, RevisionInfo& changeset);
+    //fetches the affected items of these revisions ahead of time, the first ones first, a few at once; revisions
+    //of the previous window not fetched yet are dropped
+    void prefetchChangeSets(const std::vector<int>& revisions);
+    SvnViewerPrefetchStats getPrefetchStats() const;
     RevisionInfo::Collection getRevisionsList() const;
+    //the head of the list, for views that already show the older revisions
+    RevisionInfo::Collection getRevisionsNewerThan(int nRevision) const;
+    int getOldestRevision() const;
+    bool getRevisionStats(int nRevision, RevisionStats& stats) const;
     ChangeInfo::Collection getLocalChanges() const;
     int getCurrentRevision() const;
     std::string getRepoPath() const;
     RepoItemInfo::SmartPtr getRepoContent() const;
+
+    //wall time of the last completed refresh, -1 before the first one
+    long long getLastRefreshDurationMs() const;
+    bool isRefreshing() const;
+
+    SvnViewerMemoryStats getMemoryStats() const;
+    void setMemoryBudget(size_t nBudgetBytes);
+    //the views count against the budget too
+    void setViewsMemoryUsage(size_t nBytes);
+    //while paused no new background job starts (revision statistics); running ones finish
+    void setBackgroundWorkPaused(bool bPaused);
 private:
 
     RepoItemInfo::SmartPtr findRepoNode(const std::string& repoPath);
-    void launchAsync(SvnCommand* pCommand);
+    SvnCommand* launchAsync(SvnCommand* pCommand);
+    void enforceMemoryBudget();
+    //keep the running memory totals in step with the collections
+    void countRevisionMemory(const RevisionInfo& revision, bool bAdded);
+    void countAffectedItemsMemory(const RevisionInfo& revision, bool bAdded);
+    void countLocalChangeMemory(const ChangeInfo& change, bool bAdded);
+    void recountRevisionsMemory();
+    void launchPrefetches();
+    void onChangeSetFetched(int nRevision, bool bSuccess);
+    SvnCommand* launchNextStatus();
+    void addRevisionsSteps(const std::list<std::string>& dependencies);
+    void invalidate(const Invalidation& invalidation);
+    void runRefreshPipeline();
+    void onRefreshPipelineProgress();
+    bool needsFullLog() const;
+    void applyStatus(const StatusSvnCommand* pCommand);
+    int getNewestRevision() const;
+    //key of strItem in the file revision cache, empty while the repository uuid is unknown
+    std::string getRevisionCacheKey(const std::string& strItem) const;
+    //fills the revisions list from the statistics store, then computes the missing ones, newest first
+    void applyStoredRevisionStats();
+    void scheduleRevisionStats();
+    void applyRevisionStats(const DiffStatSvnCommand* pCommand, bool bSuccess);
+
+    //WorkingCopyWatcherObserver
+    virtual void onWorkingCopyChanged(const std::set<std::string>& changedPaths);
+
+    //UpdateSvnCommandObserver
+    virtual void onItemUpdated(const ChangeInfo& item);
+    void applyUpdatedItems();
+
+    //BlameSvnCommandObserver
+    virtual void onBlameLines(const std::string& path, int nRevision, int nFirstLine, const BlameLine::Collection& lines);
+
+    //ReviewSessionObserver
+    virtual void onReviewFileStaged(int nReviewId, int nIndex);
+    virtual void onReviewCompleted(int nReviewId);
+
+    //HistorySearchObserver
+    virtual void onHistorySearchMatch(int nSearchId, int nRevision, const std::string& url, bool bAdded, int nLine, const std::string& line);
+    virtual void onHistorySearchProgress(int nSearchId, int nScannedRevisions);
+    virtual void onHistorySearchCompleted(int nSearchId);
+
+    //what the commit could not update by itself: the log when revisions of others came in between
+    Invalidation applyCommit(const CommitSvnCommand* pCommand);
+    //number of revisions added in front of oldRevisions by the current list, -1 when it is not a plain prepend
+    int countPrependedRevisions(const RevisionInfo::Collection& oldRevisions) const;
+    bool addRepoNode(const std::string& path);
+    bool removeRepoNode(const std::string& path);
 
     struct threadParams
     {
@@ -77,12 +257,25 @@ private:
     mutable std::recursive_mutex m_mutex;
 
     bool m_closing;
+    //the threads are detached, each one leaves the list once its command is handled
     std::list<threadParams*> m_asyncProcessThreads;
+    std::condition_variable_any m_asyncThreadsFinished;
 
     int m_nRevisionsCount;
     int m_currentRevision;
     std::string m_repoPath;
     std::string m_repoUrl;
+    //from svn info, they key the file revision cache
+    std::string m_repoRoot;
+    std::string m_repoUuid;
+    //BASE texts of local diffs; replaced when another working copy is opened, running diffs keep theirs
+    std::shared_ptr<PristineStore> m_spPristineStore;
+    //url of the log held in m_revisionsList; the HEAD probe is only valid for the repository root log
+    std::string m_logUrl;
+    //last changed revision of m_repoUrl on the server, from the HEAD probe
+    int m_nHeadRevision;
+    RefreshPipeline m_refreshPipeline;
+    bool m_bRefreshPending;
     SvnViewerObserver* m_observer;
 
     RevisionInfo::Collection m_revisionsList;
@@ -90,6 +283,37 @@ private:
     std::list<std::string> m_errors;
 
     RepoItemInfo::SmartPtr m_repoContent;
+
+    //while the watcher is active, local status is refreshed on file system events instead of on every refresh
+    std::unique_ptr<WorkingCopyWatcher> m_spWatcher;
+    bool m_bLocalStatusKnown;
+    bool m_bStatusRunning;
+    bool m_bFullStatusPending;
+    std::set<std::string> m_pendingStatusPaths;
+    std::set<std::string> m_pendingRecursiveStatusPaths;
+
+    //items reported by a running update, applied in batches so the views are not flooded
+    ChangeInfo::Collection m_updatedItems;
+    int m_nUpdateProgress;
+    std::chrono::steady_clock::time_point m_lastUpdateApplied;
+
+    //affected items of the least recently viewed revisions are dropped above this budget
+    size_t m_nMemoryBudget;
+    unsigned long long m_nAccessCounter;
+    //adjusted wherever entries are added or dropped, never by walking everything
+    SvnViewerMemoryStats m_memoryStats;
+    int m_nReviewsCount;
+
+    //revisions waiting to be prefetched, and the running prefetches with whether they were viewed meanwhile
+    std::list<int> m_prefetchQueue;
+    std::map<int, bool> m_prefetchJobs;
+    SvnViewerPrefetchStats m_prefetchStats;
+    int m_nHistorySearchesCount;
+
+    //diff statistics of the revisions of m_logUrl
+    RevisionStatsStore m_statsStore;
+    int m_nStatsJobs;
+    bool m_bBackgroundPaused;
 };
 
 #endif // SVNVIEWER_H
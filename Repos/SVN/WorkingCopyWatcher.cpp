@@ -0,0 +1,292 @@
+#include "Repos/SVN/WorkingCopyWatcher.h"
+#include "Logger/Logger.h"
+
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <poll.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#include <cstring>
+#include <chrono>
+#include <algorithm>
+
+static const uint32_t WATCH_MASK = IN_CLOSE_WRITE | IN_MODIFY | IN_ATTRIB | IN_CREATE | IN_DELETE
+                                   | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_ONLYDIR;
+
+WorkingCopyWatcher::WorkingCopyWatcher(WorkingCopyWatcherObserver* pObserver, int nDebounceMs, int nMaxDelayMs)
+    : m_pObserver(pObserver)
+    , m_nDebounceMs(nDebounceMs)
+    , m_nMaxDelayMs(nMaxDelayMs)
+    , m_bActive(false)
+    , m_bRunning(false)
+    , m_nInotifyFd(-1)
+{
+    m_stopPipe[0] = m_stopPipe[1] = -1;
+}
+
+WorkingCopyWatcher::~WorkingCopyWatcher()
+{
+    stop();
+}
+
+bool WorkingCopyWatcher::start(const std::string& rootPath)
+{
+    stop();
+
+    m_nInotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(m_nInotifyFd < 0)
+    {
+        Logger::instance()->logCommandMessage(std::string("inotify is not available: ") + strerror(errno));
+        return false;
+    }
+
+    if(pipe2(m_stopPipe, O_NONBLOCK | O_CLOEXEC) != 0)
+    {
+        close(m_nInotifyFd);
+        m_nInotifyFd = -1;
+        return false;
+    }
+
+    m_rootPath = rootPath;
+    while(m_rootPath.length() > 1 && m_rootPath[m_rootPath.length() - 1] == '/')
+    {
+        m_rootPath.erase(m_rootPath.length() - 1);
+    }
+
+    {
+        std::unique_lock<std::mutex> locker(m_mutex);
+        m_bActive = addWatchRecursive(m_rootPath);
+    }
+
+    m_bRunning = true;
+    pthread_create(&m_thread, NULL, &watchThread, this);
+    return isActive();
+}
+
+void WorkingCopyWatcher::stop()
+{
+    if(m_bRunning)
+    {
+        char c = 0;
+        if(write(m_stopPipe[1], &c, 1) < 0)
+        {
+            Logger::instance()->logCommandMessage("Cannot stop the working copy watcher.");
+        }
+        pthread_join(m_thread, NULL);
+        m_bRunning = false;
+    }
+
+    if(m_nInotifyFd >= 0)
+    {
+        close(m_nInotifyFd);
+        m_nInotifyFd = -1;
+    }
+
+    for(int i = 0; i < 2; i++)
+    {
+        if(m_stopPipe[i] >= 0)
+        {
+            close(m_stopPipe[i]);
+            m_stopPipe[i] = -1;
+        }
+    }
+
+    std::unique_lock<std::mutex> locker(m_mutex);
+    m_bActive = false;
+    m_watchedDirectories.clear();
+    m_pendingPaths.clear();
+}
+
+bool WorkingCopyWatcher::isActive() const
+{
+    std::unique_lock<std::mutex> locker(m_mutex);
+    return m_bActive;
+}
+
+bool WorkingCopyWatcher::addWatchRecursive(const std::string& path)
+{
+    int nWatch = inotify_add_watch(m_nInotifyFd, path.c_str(), WATCH_MASK);
+    if(nWatch < 0)
+    {
+        //logging runs a command, which overwrites errno
+        int nError = errno;
+        //ENOSPC: fs.inotify.max_user_watches is too low for this working copy
+        Logger::instance()->logCommandMessage("Cannot watch " + path + ": " + strerror(nError));
+        return nError != ENOSPC;
+    }
+    m_watchedDirectories[nWatch] = path;
+
+    DIR* pDir = opendir(path.c_str());
+    if(!pDir)
+    {
+        return true;
+    }
+
+    bool bComplete = true;
+    while(struct dirent* pEntry = readdir(pDir))
+    {
+        if(!strcmp(pEntry->d_name, ".") || !strcmp(pEntry->d_name, "..") || !strcmp(pEntry->d_name, ".svn"))
+        {
+            continue;
+        }
+
+        std::string childPath = path + "/" + pEntry->d_name;
+        bool bDirectory = pEntry->d_type == DT_DIR;
+        if(pEntry->d_type == DT_UNKNOWN)
+        {
+            struct stat info;
+            bDirectory = lstat(childPath.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+        }
+
+        if(bDirectory && !addWatchRecursive(childPath))
+        {
+            bComplete = false;
+            break;
+        }
+    }
+    closedir(pDir);
+
+    return bComplete;
+}
+
+bool WorkingCopyWatcher::isAdministrativePath(const std::string& path)
+{
+    return path.find("/.svn/") != std::string::npos || (path.length() >= 5 && path.compare(path.length() - 5, 5, "/.svn") == 0);
+}
+
+void WorkingCopyWatcher::processEvents(const char* pBuffer, size_t nLength)
+{
+    std::unique_lock<std::mutex> locker(m_mutex);
+
+    for(size_t nOffset = 0; nOffset < nLength;)
+    {
+        const struct inotify_event* pEvent = reinterpret_cast<const struct inotify_event*>(pBuffer + nOffset);
+        nOffset += sizeof(struct inotify_event) + pEvent->len;
+
+        if(pEvent->mask & IN_Q_OVERFLOW)
+        {
+            //events were lost, the whole working copy has to be checked
+            m_pendingPaths.insert(m_rootPath);
+            continue;
+        }
+
+        std::map<int, std::string>::iterator watch = m_watchedDirectories.find(pEvent->wd);
+        if(watch == m_watchedDirectories.end())
+        {
+            continue;
+        }
+
+        if(pEvent->mask & (IN_IGNORED | IN_DELETE_SELF))
+        {
+            m_watchedDirectories.erase(watch);
+            continue;
+        }
+
+        std::string path = watch->second;
+        if(pEvent->len && pEvent->name[0])
+        {
+            path += std::string("/") + pEvent->name;
+        }
+
+        if(isAdministrativePath(path))
+        {
+            continue;
+        }
+
+        if((pEvent->mask & IN_ISDIR) && (pEvent->mask & (IN_CREATE | IN_MOVED_TO)))
+        {
+            if(!addWatchRecursive(path))
+            {
+                m_bActive = false;
+            }
+        }
+
+        m_pendingPaths.insert(path);
+    }
+}
+
+void WorkingCopyWatcher::run()
+{
+    typedef std::chrono::steady_clock Clock;
+
+    char buffer[64 * 1024] __attribute__((aligned(__alignof__(struct inotify_event))));
+    Clock::time_point firstEvent;
+    Clock::time_point lastEvent;
+    bool bPending = false;
+
+    while(true)
+    {
+        //sleep without timeout while nothing is pending, so an idle working copy costs nothing
+        int nTimeoutMs = -1;
+        if(bPending)
+        {
+            Clock::time_point now = Clock::now();
+            long long nQuietMs = std::chrono::duration_cast<std::chrono::milliseconds>(now - lastEvent).count();
+            long long nWaitedMs = std::chrono::duration_cast<std::chrono::milliseconds>(now - firstEvent).count();
+            nTimeoutMs = static_cast<int>(std::max(0LL, std::min(m_nDebounceMs - nQuietMs, m_nMaxDelayMs - nWaitedMs)));
+        }
+
+        if(bPending && nTimeoutMs == 0)
+        {
+            std::set<std::string> changedPaths;
+            {
+                std::unique_lock<std::mutex> locker(m_mutex);
+                changedPaths.swap(m_pendingPaths);
+            }
+            bPending = false;
+
+            if(!changedPaths.empty() && m_pObserver)
+            {
+                m_pObserver->onWorkingCopyChanged(changedPaths);
+            }
+            continue;
+        }
+
+        struct pollfd fds[2];
+        fds[0].fd = m_nInotifyFd;
+        fds[0].events = POLLIN;
+        fds[0].revents = 0;
+        fds[1].fd = m_stopPipe[0];
+        fds[1].events = POLLIN;
+        fds[1].revents = 0;
+
+        int nReady = poll(fds, 2, nTimeoutMs);
+        if(nReady < 0 && errno != EINTR)
+        {
+            break;
+        }
+
+        if(fds[1].revents & POLLIN)
+        {
+            break;
+        }
+
+        if(nReady > 0 && (fds[0].revents & POLLIN))
+        {
+            ssize_t nLength = 0;
+            while((nLength = read(m_nInotifyFd, buffer, sizeof(buffer))) > 0)
+            {
+                processEvents(buffer, nLength);
+            }
+
+            std::unique_lock<std::mutex> locker(m_mutex);
+            if(!m_pendingPaths.empty())
+            {
+                lastEvent = Clock::now();
+                if(!bPending)
+                {
+                    firstEvent = lastEvent;
+                    bPending = true;
+                }
+            }
+        }
+    }
+}
+
+void* WorkingCopyWatcher::watchThread(void* arg)
+{
+    reinterpret_cast<WorkingCopyWatcher*>(arg)->run();
+    return NULL;
+}
@@ -0,0 +1,55 @@
+#ifndef WORKINGCOPYWATCHER_H
+#define WORKINGCOPYWATCHER_H
+
+#include <string>
+#include <set>
+#include <map>
+#include <mutex>
+#include <pthread.h>
+
+class WorkingCopyWatcherObserver
+{
+public:
+    //called from the watcher thread with the paths changed since the previous call
+    virtual void onWorkingCopyChanged(const std::set<std::string>& changedPaths) = 0;
+};
+
+//recursive inotify watch of a working copy; .svn administrative areas are ignored and
+//bursts of events are reported once, after nDebounceMs of quiet (at most nMaxDelayMs after the first event)
+class WorkingCopyWatcher
+{
+public:
+    WorkingCopyWatcher(WorkingCopyWatcherObserver* pObserver, int nDebounceMs = 200, int nMaxDelayMs = 800);
+    ~WorkingCopyWatcher();
+
+    bool start(const std::string& rootPath);
+    void stop();
+
+    //false when inotify is unavailable or ran out of watches; callers should poll instead
+    bool isActive() const;
+
+private:
+    bool addWatchRecursive(const std::string& path);
+    void processEvents(const char* pBuffer, size_t nLength);
+    void run();
+    static void* watchThread(void* arg);
+    static bool isAdministrativePath(const std::string& path);
+
+private:
+    WorkingCopyWatcherObserver* m_pObserver;
+    const int m_nDebounceMs;
+    const int m_nMaxDelayMs;
+
+    mutable std::mutex m_mutex;
+    bool m_bActive;
+    bool m_bRunning;
+    int m_nInotifyFd;
+    int m_stopPipe[2];
+    pthread_t m_thread;
+
+    std::string m_rootPath;
+    std::map<int, std::string> m_watchedDirectories;
+    std::set<std::string> m_pendingPaths;
+};
+
+#endif // WORKINGCOPYWATCHER_H
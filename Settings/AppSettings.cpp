@@ -29,6 +29,20 @@ AppSettings::AppSettings()
 
         m_recents.push_back(lastRepo);
     }
+
+    std::string settingsPath = m_path + "settings";
+    std::ifstream fSettings(settingsPath.c_str(), std::ios_base::in);
+    std::string line;
+    while(getline(fSettings, line, '\n'))
+    {
+        size_t nPos = line.find('=');
+        if(nPos == std::string::npos || line[0] == '#')
+        {
+            continue;
+        }
+
+        m_values[line.substr(0, nPos)] = line.substr(nPos + 1);
+    }
 }
 
 
@@ -95,3 +109,27 @@ std::string AppSettings::getLogsPath()
     std::unique_lock<std::recursive_mutex> locker(m_mutex);
     return m_path + "Logs/";
 }
+
+int AppSettings::getIntValue(const std::string& key, int nDefault)
+{
+    std::unique_lock<std::recursive_mutex> locker(m_mutex);
+    std::map<std::string, std::string>::const_iterator it = m_values.find(key);
+    if(it == m_values.end() || it->second.empty())
+    {
+        return nDefault;
+    }
+
+    return atoi(it->second.c_str());
+}
+
+std::string AppSettings::getStringValue(const std::string& key, const std::string& defaultValue)
+{
+    std::unique_lock<std::recursive_mutex> locker(m_mutex);
+    std::map<std::string, std::string>::const_iterator it = m_values.find(key);
+    if(it == m_values.end())
+    {
+        return defaultValue;
+    }
+
+    return it->second;
+}
@@ -4,6 +4,7 @@
 #include <string>
 #include <list>
 #include <mutex>
+#include <map>
 
 class AppSettings
 {
@@ -21,11 +22,16 @@ public:
     std::string getTempPath();
     std::string getLogsPath();
 
+    //options from <settings path>/settings, one "key=value" per line
+    int getIntValue(const std::string& key, int nDefault);
+    std::string getStringValue(const std::string& key, const std::string& defaultValue);
+
 private:
     std::recursive_mutex m_mutex;
     std::string m_lastRepoPath;
     std::string m_path;
     std::list<std::string> m_recents;
+    std::map<std::string, std::string> m_values;
 };
 
 #endif // APPSETTINGS_H